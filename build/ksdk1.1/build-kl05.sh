@@ -11,9 +11,22 @@
 	cp ../../src/boot/ksdk1.1.0/SEGGER*				work/demos/Warp/src/
 	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-boot.c		work/demos/Warp/src/
 	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-powermodes.c	work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-cyclecounter.c	work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-i2c.c		work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-fixedpoint.c	work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-reactiontimer.c	work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-time.c		work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-scheduler.c	work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-buttons.c		work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-sampler.c		work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-dataready.c	work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-telemetry.c	work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-csv.c		work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-samplering.c	work/demos/Warp/src/
 	cp ../../src/boot/ksdk1.1.0/warp.h				work/demos/Warp/src/
 	cp ../../src/boot/ksdk1.1.0/devBMX055.*				work/demos/Warp/src/
 	cp ../../src/boot/ksdk1.1.0/devADXL362.*			work/demos/Warp/src/
+	cp ../../src/boot/ksdk1.1.0/devIS25WP128.*			work/demos/Warp/src/
 	cp ../../src/boot/ksdk1.1.0/devMMA8451Q.*			work/demos/Warp/src/
 	cp ../../src/boot/ksdk1.1.0/devLPS25H.*				work/demos/Warp/src/
 	cp ../../src/boot/ksdk1.1.0/devHDC1000.*			work/demos/Warp/src/
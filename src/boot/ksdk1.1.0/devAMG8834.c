@@ -171,6 +171,38 @@ readSensorRegisterAMG8834(uint8_t deviceRegister, int numberOfBytes)
 	return kWarpStatusOK;
 }
 
+/*
+ *	Read all 64 pixels (T01L..T64H, 0x80..0xFF) in one auto-incrementing
+ *	transaction into frameBuffer, which must hold kWarpSizesAMG8834FrameBytes.
+ *	One start/address/stop sequence instead of 64.
+ */
+WarpStatus
+readSensorFrameAMG8834(uint8_t *  frameBuffer)
+{
+	return warpI2cReadBurst(deviceAMG8834State.i2cAddress,
+				kWarpSensorOutputRegisterAMG8834T01L,
+				frameBuffer,
+				kWarpSizesAMG8834FrameBytes);
+}
+
+/*
+ *	Convert a frame from readSensorFrameAMG8834() to temperatures in Q8.8
+ *	degrees Celsius. Pixel values are 12-bit two's complement with an LSB of
+ *	0.25 C (specification, page 14/26), so sign-extend and scale by 64. The
+ *	sensor's -20 C to 100 C range fits in Q8.8. May be done in place, with
+ *	temperatures aliasing frameBuffer.
+ */
+void
+convertSensorFrameAMG8834(const uint8_t *  frameBuffer, int16_t *  temperatures)
+{
+	for (int i = 0; i < kWarpSizesAMG8834Pixels; i++)
+	{
+		uint16_t	raw = ((frameBuffer[2*i + 1] & 0x0F) << 8) | frameBuffer[2*i];
+
+		temperatures[i] = warpFixedPointConvert(warpFixedPointSignExtend(raw, 12), kWarpFixedPointScaleAMG8834PixelQ8);
+	}
+}
+
 void
 printSensorDataAMG8834(bool hexModeFlag)
 {
@@ -178,38 +210,34 @@ printSensorDataAMG8834(bool hexModeFlag)
 	uint16_t	readSensorRegisterValueMSB;
 	int16_t		readSensorRegisterValueCombined;
 	WarpStatus	i2cReadStatus;
+	int16_t		frame[kWarpSizesAMG8834Pixels];
 
-	for (uint16_t bufAddress = kWarpSensorOutputRegisterAMG8834T01L; bufAddress <= kWarpSensorOutputRegisterAMG8834T64H; bufAddress = bufAddress + 2)
+	i2cReadStatus = readSensorFrameAMG8834((uint8_t *)frame);
+	if (i2cReadStatus != kWarpStatusOK)
 	{
-		i2cReadStatus			= readSensorRegisterAMG8834(bufAddress, 2 /* numberOfBytes */);
-		readSensorRegisterValueLSB	= deviceAMG8834State.i2cBuffer[0];
-		readSensorRegisterValueMSB	= deviceAMG8834State.i2cBuffer[1];
-
-		/*
-		 *	Format is 12 bits with the highest-order bit being a sign (0 +ve, 1 -ve)
-		 */
-		readSensorRegisterValueCombined	= ((readSensorRegisterValueMSB & 0x07) << 8) | (readSensorRegisterValueLSB & 0xFF);
-		readSensorRegisterValueCombined *= ((readSensorRegisterValueMSB & (1 << 3)) == 0 ? 1 : -1);
-
-		/*
-		 *	Specification, page 14/26, says LSB counts for 0.25 C (1/4 C)
-		 */
-		readSensorRegisterValueCombined >>= 2;
+		for (int i = 0; i < kWarpSizesAMG8834Pixels; i++)
+		{
+			warpCsvMissing();
+		}
+	}
+	else if (hexModeFlag)
+	{
+		uint8_t *	frameBytes = (uint8_t *)frame;
 
-		if (i2cReadStatus != kWarpStatusOK)
+		for (int i = 0; i < kWarpSizesAMG8834Pixels; i++)
 		{
-			SEGGER_RTT_WriteString(0, " ----,");
+			warpCsvHex((frameBytes[2*i + 1] << 8) | frameBytes[2*i], 2);
 		}
-		else
+	}
+	else
+	{
+		/*
+		 *	Whole degrees C, as before.
+		 */
+		convertSensorFrameAMG8834((uint8_t *)frame, frame);
+		for (int i = 0; i < kWarpSizesAMG8834Pixels; i++)
 		{
-			if (hexModeFlag)
-			{
-				SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-			}
-			else
-			{
-				SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-			}
+			warpCsvInt(frame[i] >> 8);
 		}
 	}
 
@@ -224,23 +252,24 @@ printSensorDataAMG8834(bool hexModeFlag)
 	readSensorRegisterValueCombined *= ((readSensorRegisterValueMSB & (1 << 3)) == 0 ? 1 : -1);
 
 	/*
-	 *	Specification, page 13/26, says LSB of the 12-bit thermistor value counts for 0.0625 C (1 / 16 C)
+	 *	Specification, page 13/26, says LSB of the 12-bit thermistor value counts for 0.0625 C (1 / 16 C).
+	 *	Print whole degrees, as for the pixels.
 	 */
-	readSensorRegisterValueCombined >>= 4;
+	readSensorRegisterValueCombined = warpFixedPointConvert(readSensorRegisterValueCombined, kWarpFixedPointScaleAMG8834ThermistorQ8) >> 8;
 
 	if (i2cReadStatus != kWarpStatusOK)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			warpCsvInt(readSensorRegisterValueCombined);
 		}
 	}
 }
\ No newline at end of file
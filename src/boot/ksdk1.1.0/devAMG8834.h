@@ -42,6 +42,8 @@
 void		initAMG8834(const uint8_t i2cAddress, WarpI2CDeviceState volatile *  deviceStatePointer);
 WarpStatus	readSensorRegisterAMG8834(uint8_t deviceRegister, int numberOfBytes);
 WarpStatus	writeSensorRegisterAMG8834(uint8_t deviceRegister, uint8_t payload, uint16_t menuI2cPullupValue);
+WarpStatus	readSensorFrameAMG8834(uint8_t *  frameBuffer);
+void		convertSensorFrameAMG8834(const uint8_t *  frameBuffer, int16_t *  temperatures);
 WarpStatus	configureSensorAMG8834(uint8_t payloadConfigReg, uint8_t payloadFrameRateReg, uint16_t menuI2cPullupValue);
 WarpStatus	readSensorSignalAMG8834(WarpTypeMask signal,
 					WarpSignalPrecision precision,
@@ -217,17 +217,17 @@ printSensorDataBME680(bool hexModeFlag, uint16_t menuI2cPullupValue)
 
 	if ((triggerStatus != kWarpStatusOK) || (i2cReadStatus != kWarpStatusOK))
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB, readSensorRegisterValueXLSB);
+			warpCsvHex((readSensorRegisterValueMSB << 16) | (readSensorRegisterValueLSB << 8) | readSensorRegisterValueXLSB, 3);
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %u,", unsignedRawAdcValue);
+			warpCsvUnsigned(unsignedRawAdcValue);
 		}
 	}
 
@@ -242,17 +242,17 @@ printSensorDataBME680(bool hexModeFlag, uint16_t menuI2cPullupValue)
 			((readSensorRegisterValueXLSB & 0xF0) >> 4);
 	if ((triggerStatus != kWarpStatusOK) || (i2cReadStatus != kWarpStatusOK))
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB, readSensorRegisterValueXLSB);
+			warpCsvHex((readSensorRegisterValueMSB << 16) | (readSensorRegisterValueLSB << 8) | readSensorRegisterValueXLSB, 3);
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %u,", unsignedRawAdcValue);
+			warpCsvUnsigned(unsignedRawAdcValue);
 		}
 	}
 
@@ -263,17 +263,17 @@ printSensorDataBME680(bool hexModeFlag, uint16_t menuI2cPullupValue)
 	unsignedRawAdcValue = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
 	if ((triggerStatus != kWarpStatusOK) || (i2cReadStatus != kWarpStatusOK))
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %u,", unsignedRawAdcValue);
+			warpCsvUnsigned(unsignedRawAdcValue);
 		}
 	}
 }
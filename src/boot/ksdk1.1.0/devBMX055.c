@@ -49,6 +49,7 @@
 #include "gpio_pins.h"
 #include "SEGGER_RTT.h"
 #include "warp.h"
+#include "devBMX055.h"
 
 
 extern volatile WarpI2CDeviceState	deviceBMX055accelState;
@@ -58,6 +59,15 @@ extern volatile uint32_t		gWarpI2cBaudRateKbps;
 extern volatile uint32_t		gWarpI2cTimeoutMilliseconds;
 extern volatile uint32_t		gWarpSupplySettlingDelayMilliseconds;
 
+static uint8_t				accelSampleRegisterValues[7];
+static WarpI2cTransaction		accelSampleTransaction;
+static uint8_t				gyroSampleRegisterValues[6];
+static WarpI2cTransaction		gyroSampleTransaction;
+static uint8_t				magSampleRegisterValues[8];
+static WarpI2cTransaction		magSampleTransaction;
+static uint8_t				magTriggerPayload;
+static WarpI2cTransaction		magTriggerTransaction;
+
 
 
 /*
@@ -126,6 +136,30 @@ configureSensorBMX055accel(uint8_t payloadPMU_RANGE, uint8_t payloadACCD_HBW, ui
 	return (status1 | status2);
 }
 
+/*
+ *	Map the new-data interrupt to INT1, as an open-drain, active-low output
+ *	so that it can share kWarpPinSensorDataReady with the other sensors.
+ */
+WarpStatus
+configureDataReadyBMX055accel(uint16_t menuI2cPullupValue)
+{
+	WarpStatus	status1, status2, status3;
+
+	status1 = writeSensorRegisterBMX055accel(kWarpSensorConfigurationRegisterBMX055accelINT_OUT_CTRL /* register address INT_OUT_CTRL */,
+							0b00000010 /* payload: int1_od open drain, int1_lvl active low */,
+							menuI2cPullupValue);
+
+	status2 = writeSensorRegisterBMX055accel(kWarpSensorConfigurationRegisterBMX055accelINT_MAP_1 /* register address INT_MAP_1 */,
+							0b00000001 /* payload: int1_data */,
+							menuI2cPullupValue);
+
+	status3 = writeSensorRegisterBMX055accel(kWarpSensorConfigurationRegisterBMX055accelINT_EN_1 /* register address INT_EN_1 */,
+							0b00010000 /* payload: data_en */,
+							menuI2cPullupValue);
+
+	return (status1 | status2 | status3);
+}
+
 WarpStatus
 readSensorRegisterBMX055accel(uint8_t deviceRegister, int numberOfBytes)
 {
@@ -293,7 +327,7 @@ writeSensorRegisterBMX055gyro(uint8_t deviceRegister, uint8_t payload, uint16_t
 
 	i2c_device_t slave =
 	{
-		.address = deviceBMX055magState.i2cAddress,
+		.address = deviceBMX055gyroState.i2cAddress,
 		.baudRate_kbps = gWarpI2cBaudRateKbps
 	};
 
@@ -334,12 +368,37 @@ configureSensorBMX055gyro(uint8_t payloadRANGE, uint8_t payloadBW, uint8_t paylo
 							menuI2cPullupValue);
 
 	status4 = writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroRATE_HBW/* register address RATE_HBW */,
-							payloadLPM1 /* payload */,
+							payloadRATE_HBW /* payload */,
 							menuI2cPullupValue);
 
 	return (status1 | status2 | status3 | status4);
 }
 
+/*
+ *	Map the new-data interrupt to INT3 (the gyro's INT1 output), as an
+ *	open-drain, active-low output so that it can share
+ *	kWarpPinSensorDataReady with the other sensors.
+ */
+WarpStatus
+configureDataReadyBMX055gyro(uint16_t menuI2cPullupValue)
+{
+	WarpStatus	status1, status2, status3;
+
+	status1 = writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroINT_EN_1 /* register address INT_EN_1 */,
+							0b00000010 /* payload: int1_od open drain, int1_lvl active low */,
+							menuI2cPullupValue);
+
+	status2 = writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroINT_MAP_1 /* register address INT_MAP_1 */,
+							0b00000001 /* payload: int1_data */,
+							menuI2cPullupValue);
+
+	status3 = writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroINT_EN_0 /* register address INT_EN_0 */,
+							0b10000000 /* payload: data_en */,
+							menuI2cPullupValue);
+
+	return (status1 | status2 | status3);
+}
+
 WarpStatus
 readSensorRegisterBMX055gyro(uint8_t deviceRegister, int numberOfBytes)
 {
@@ -380,8 +439,30 @@ readSensorRegisterBMX055gyro(uint8_t deviceRegister, int numberOfBytes)
 	return kWarpStatusOK;
 }
 
+/*
+ *	Queue a read of one X/Y/Z sample (and ACCD_TEMP) on the asynchronous I2C
+ *	queue, for printSensorSampleBMX055accel() to wait for and print.
+ */
+WarpStatus
+queueSensorSampleBMX055accel(void)
+{
+	/*
+	 *	ACCD_X_LSB through ACCD_Z_MSB and ACCD_TEMP are contiguous, so we
+	 *	read all seven in one transaction. With shadowing enabled (the
+	 *	default), reading each LSB locks its MSB until it has been read.
+	 */
+	accelSampleTransaction.i2cAddress	= deviceBMX055accelState.i2cAddress;
+	accelSampleTransaction.deviceRegister	= kWarpSensorOutputRegisterBMX055accelACCD_X_LSB;
+	accelSampleTransaction.direction	= kWarpI2cDirectionRead;
+	accelSampleTransaction.buffer		= accelSampleRegisterValues;
+	accelSampleTransaction.numberOfBytes	= sizeof(accelSampleRegisterValues);
+	accelSampleTransaction.callback		= NULL;
+
+	return warpI2cSubmit(&accelSampleTransaction);
+}
+
 void
-printSensorDataBMX055accel(bool hexModeFlag)
+printSensorSampleBMX055accel(bool hexModeFlag)
 {
 	uint16_t	readSensorRegisterValueLSB;
 	uint16_t	readSensorRegisterValueMSB;
@@ -389,312 +470,485 @@ printSensorDataBMX055accel(bool hexModeFlag)
 	WarpStatus	i2cReadStatus;
 
 
-	i2cReadStatus = readSensorRegisterBMX055accel(kWarpSensorOutputRegisterBMX055accelACCD_X_LSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceBMX055accelState.i2cBuffer[0];
-	readSensorRegisterValueMSB = deviceBMX055accelState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 4) | (readSensorRegisterValueLSB >> 4);
+	i2cReadStatus = warpI2cWait(&accelSampleTransaction);
 
-	/*
-	 *	Sign extend the 12-bit value based on knowledge that upper 4 bit are 0:
-	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 11)) - (1 << 11);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		readSensorRegisterValueLSB = accelSampleRegisterValues[2*axis];
+		readSensorRegisterValueMSB = accelSampleRegisterValues[2*axis + 1];
+		readSensorRegisterValueCombined = warpFixedPointSignExtend(((readSensorRegisterValueMSB & 0xFF) << 4) | (readSensorRegisterValueLSB >> 4), 12);
 
 
-	if (i2cReadStatus != kWarpStatusOK)
-	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
+		if (i2cReadStatus != kWarpStatusOK)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvMissing();
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			if (hexModeFlag)
+			{
+				warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
+			}
+			else
+			{
+				warpCsvInt(warpFixedPointConvert(readSensorRegisterValueCombined, kWarpFixedPointScaleBMX055accelMilliG));
+			}
 		}
 	}
 
-	i2cReadStatus = readSensorRegisterBMX055accel(kWarpSensorOutputRegisterBMX055accelACCD_Y_LSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceBMX055accelState.i2cBuffer[0];
-	readSensorRegisterValueMSB = deviceBMX055accelState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 4) | (readSensorRegisterValueLSB >> 4);
+	readSensorRegisterValueCombined = accelSampleRegisterValues[kWarpSensorOutputRegisterBMX055accelACCD_TEMP - kWarpSensorOutputRegisterBMX055accelACCD_X_LSB];
 
 	/*
-	 *	Sign extend the 12-bit value based on knowledge that upper 4 bit are 0:
+	 *	Sign extend the 8-bit value based on knowledge that upper 8 bit are 0:
 	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 11)) - (1 << 11);
+	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 7)) - (1 << 7);
 
 
 	if (i2cReadStatus != kWarpStatusOK)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvHex(readSensorRegisterValueCombined, 1);
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			warpCsvInt(readSensorRegisterValueCombined);
 		}
 	}
+}
 
-	i2cReadStatus = readSensorRegisterBMX055accel(kWarpSensorOutputRegisterBMX055accelACCD_Z_LSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceBMX055accelState.i2cBuffer[0];
-	readSensorRegisterValueMSB = deviceBMX055accelState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 4) | (readSensorRegisterValueLSB >> 4);
+void
+printSensorDataBMX055accel(bool hexModeFlag)
+{
+	queueSensorSampleBMX055accel();
+	printSensorSampleBMX055accel(hexModeFlag);
+}
 
+/*
+ *	Queue a read of one X/Y/Z sample on the asynchronous I2C
+ *	queue, for printSensorSampleBMX055gyro() to wait for and print.
+ */
+WarpStatus
+queueSensorSampleBMX055gyro(void)
+{
 	/*
-	 *	Sign extend the 12-bit value based on knowledge that upper 4 bit are 0:
+	 *	RATE_X_LSB through RATE_Z_MSB in one 6-byte transaction.
 	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 11)) - (1 << 11);
+	gyroSampleTransaction.i2cAddress	= deviceBMX055gyroState.i2cAddress;
+	gyroSampleTransaction.deviceRegister	= kWarpSensorOutputRegisterBMX055gyroRATE_X_LSB;
+	gyroSampleTransaction.direction		= kWarpI2cDirectionRead;
+	gyroSampleTransaction.buffer		= gyroSampleRegisterValues;
+	gyroSampleTransaction.numberOfBytes	= sizeof(gyroSampleRegisterValues);
+	gyroSampleTransaction.callback		= NULL;
+
+	return warpI2cSubmit(&gyroSampleTransaction);
+}
 
+void
+printSensorSampleBMX055gyro(bool hexModeFlag)
+{
+	uint16_t	readSensorRegisterValueLSB;
+	uint16_t	readSensorRegisterValueMSB;
+	int16_t		readSensorRegisterValueCombined;
+	WarpStatus	i2cReadStatus;
 
-	if (i2cReadStatus != kWarpStatusOK)
-	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
-	}
 
-	i2cReadStatus = readSensorRegisterBMX055accel(kWarpSensorOutputRegisterBMX055accelACCD_TEMP, 1 /* numberOfBytes */);
-	readSensorRegisterValueCombined = deviceBMX055accelState.i2cBuffer[0];
+	i2cReadStatus = warpI2cWait(&gyroSampleTransaction);
 
-	/*
-	 *	Sign extend the 8-bit value based on knowledge that upper 8 bit are 0:
-	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 7)) - (1 << 7);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		readSensorRegisterValueLSB = gyroSampleRegisterValues[2*axis];
+		readSensorRegisterValueMSB = gyroSampleRegisterValues[2*axis + 1];
+		readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
 
+		/*
+		 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
+		 */
 
-	if (i2cReadStatus != kWarpStatusOK)
-	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
+		if (i2cReadStatus != kWarpStatusOK)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x,", readSensorRegisterValueCombined);
+			warpCsvMissing();
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			if (hexModeFlag)
+			{
+				warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
+			}
+			else
+			{
+				warpCsvInt(readSensorRegisterValueCombined);
+			}
 		}
 	}
 }
 
 void
 printSensorDataBMX055gyro(bool hexModeFlag)
+{
+	queueSensorSampleBMX055gyro();
+	printSensorSampleBMX055gyro(hexModeFlag);
+}
+
+/*
+ *	Queue a read of one X/Y/Z/RHALL sample on the asynchronous I2C
+ *	queue, for printSensorSampleBMX055mag() to wait for and print.
+ */
+WarpStatus
+queueSensorSampleBMX055mag(void)
+{
+	/*
+	 *	X_LSB through RHALL_MSB in one 8-byte transaction, as the BMX055
+	 *	datasheet recommends, so that all four come from the same measurement.
+	 */
+	magSampleTransaction.i2cAddress		= deviceBMX055magState.i2cAddress;
+	magSampleTransaction.deviceRegister	= kWarpSensorOutputRegisterBMX055magX_LSB;
+	magSampleTransaction.direction		= kWarpI2cDirectionRead;
+	magSampleTransaction.buffer		= magSampleRegisterValues;
+	magSampleTransaction.numberOfBytes	= sizeof(magSampleRegisterValues);
+	magSampleTransaction.callback		= NULL;
+
+	return warpI2cSubmit(&magSampleTransaction);
+}
+
+void
+printSensorSampleBMX055mag(bool hexModeFlag)
 {
 	uint16_t	readSensorRegisterValueLSB;
 	uint16_t	readSensorRegisterValueMSB;
 	int16_t		readSensorRegisterValueCombined;
 	WarpStatus	i2cReadStatus;
 
-
-	i2cReadStatus = readSensorRegisterBMX055gyro(kWarpSensorOutputRegisterBMX055gyroRATE_X_LSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceBMX055gyroState.i2cBuffer[0];
-	readSensorRegisterValueMSB = deviceBMX055gyroState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
-
 	/*
-	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
+	 *	X and Y are 13 bits, Z is 15 bits and RHALL is 14 bits, each
+	 *	left-aligned in its register pair.
 	 */
+	static const uint8_t	fieldBits[4] = {13, 13, 15, 14};
 
-	if (i2cReadStatus != kWarpStatusOK)
-	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
+
+	i2cReadStatus = warpI2cWait(&magSampleTransaction);
+
+	for (int field = 0; field < 4; field++)
 	{
-		if (hexModeFlag)
+		readSensorRegisterValueLSB = magSampleRegisterValues[2*field];
+		readSensorRegisterValueMSB = magSampleRegisterValues[2*field + 1];
+		readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << (fieldBits[field] - 8)) | (readSensorRegisterValueLSB >> (16 - fieldBits[field]));
+
+		/*
+		 *	Sign extend based on knowledge that the upper (16 - fieldBits) bits are 0:
+		 */
+		readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << (fieldBits[field] - 1))) - (1 << (fieldBits[field] - 1));
+
+
+		if (i2cReadStatus != kWarpStatusOK)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvMissing();
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			if (hexModeFlag)
+			{
+				warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
+			}
+			else
+			{
+				warpCsvInt(readSensorRegisterValueCombined);
+			}
 		}
 	}
+}
 
-	i2cReadStatus = readSensorRegisterBMX055gyro(kWarpSensorOutputRegisterBMX055gyroRATE_Y_LSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceBMX055gyroState.i2cBuffer[0];
-	readSensorRegisterValueMSB = deviceBMX055gyroState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
-
-	/*
-	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
-	 */
+void
+printSensorDataBMX055mag(bool hexModeFlag)
+{
+	queueSensorSampleBMX055mag();
+	printSensorSampleBMX055mag(hexModeFlag);
+}
 
-	if (i2cReadStatus != kWarpStatusOK)
+/*
+ *	Each axis' LSB carries its own new_data flag in bit 0, cleared when
+ *	the axis is read.
+ */
+static bool
+decodeDataReadySampleBMX055accel(const uint8_t *  registerValues, int16_t *  axes)
+{
+	if (!((registerValues[0] | registerValues[2] | registerValues[4]) & 0x01 /* new_data */))
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		return false;
 	}
-	else
+
+	for (int axis = 0; axis < 3; axis++)
 	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
+		uint16_t	readSensorRegisterValueLSB = registerValues[2*axis];
+		uint16_t	readSensorRegisterValueMSB = registerValues[2*axis + 1];
+
+		axes[axis] = warpFixedPointSignExtend(((readSensorRegisterValueMSB & 0xFF) << 4) | (readSensorRegisterValueLSB >> 4), 12);
 	}
 
-	i2cReadStatus = readSensorRegisterBMX055gyro(kWarpSensorOutputRegisterBMX055gyroRATE_Z_LSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceBMX055gyroState.i2cBuffer[0];
-	readSensorRegisterValueMSB = deviceBMX055gyroState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
+	return true;
+}
 
-	/*
-	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
-	 */
+const WarpDataReadySource	dataReadySourceBMX055accel =
+{
+	.deviceState	= &deviceBMX055accelState,
+	.deviceRegister	= kWarpSensorOutputRegisterBMX055accelACCD_X_LSB,
+	.numberOfBytes	= 6,
+	.decode		= decodeDataReadySampleBMX055accel,
+};
 
-	if (i2cReadStatus != kWarpStatusOK)
+/*
+ *	The gyro has no per-axis flags: read on from RATE_X_LSB to INT_STATUS_1
+ *	and check its data_int bit.
+ */
+static bool
+decodeDataReadySampleBMX055gyro(const uint8_t *  registerValues, int16_t *  axes)
+{
+	if (!(registerValues[kWarpSensorOutputRegisterBMX055gyroINT_STATUS_1 - kWarpSensorOutputRegisterBMX055gyroRATE_X_LSB] & 0x80 /* data_int */))
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		return false;
 	}
-	else
+
+	for (int axis = 0; axis < 3; axis++)
 	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
+		axes[axis] = (int16_t)(((registerValues[2*axis + 1] & 0xFF) << 8) | (registerValues[2*axis] & 0xFF));
 	}
+
+	return true;
 }
 
-void
-printSensorDataBMX055mag(bool hexModeFlag)
+const WarpDataReadySource	dataReadySourceBMX055gyro =
 {
-	uint16_t	readSensorRegisterValueLSB;
-	uint16_t	readSensorRegisterValueMSB;
-	int16_t		readSensorRegisterValueCombined;
-	WarpStatus	i2cReadStatus;
+	.deviceState	= &deviceBMX055gyroState,
+	.deviceRegister	= kWarpSensorOutputRegisterBMX055gyroRATE_X_LSB,
+	.numberOfBytes	= kWarpSensorOutputRegisterBMX055gyroINT_STATUS_1 - kWarpSensorOutputRegisterBMX055gyroRATE_X_LSB + 1,
+	.decode		= decodeDataReadySampleBMX055gyro,
+};
 
 
-	i2cReadStatus = readSensorRegisterBMX055mag(kWarpSensorOutputRegisterBMX055magX_LSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceBMX055magState.i2cBuffer[0];
-	readSensorRegisterValueMSB = deviceBMX055magState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 5) | (readSensorRegisterValueLSB >> 3);
+/*
+ *	FIFO batching. The accelerometer (32 frames) and gyro (100 frames)
+ *	both stream X/Y/Z frames at 1 kHz into their FIFOs; the gyro's
+ *	watermark interrupt, on the shared data-ready line, paces the rounds.
+ *	Each round in drainFifoBMX055() reads both frame counters, then the
+ *	same number of frames from each FIFO in one burst per part (FIFO_DATA
+ *	does not auto-increment), so frame i of one pairs with frame i of the
+ *	other. Their clocks are independent, so the pairing can slip by a
+ *	frame when the faster part's FIFO overruns; the round reports that.
+ *
+ *	The magnetometer has no FIFO. Each round reads the forced-mode
+ *	measurement triggered by the round before and triggers the next,
+ *	without waiting, so its conversion (about 3 ms at the default
+ *	repetitions) overlaps the FIFO drains and the sleep between rounds.
+ */
+enum
+{
+	kWarpBMX055FifoFramePeriodMicroseconds	= 1000,
+	kWarpBMX055FifoFrameBytes		= 6,
+};
+
+/*
+ *	Stream mode for both FIFOs, at 1 kHz: accel PMU_BW 500 Hz, filtered
+ *	(which gives 1 kHz updates), gyro ODR 1 kHz. The gyro's watermark
+ *	interrupt goes to its INT1 (INT3 on the package) as for
+ *	configureDataReadyBMX055gyro(). The magnetometer goes to sleep mode,
+ *	from which drainFifoBMX055() triggers single measurements.
+ */
+WarpStatus
+configureFifoBMX055(uint8_t gyroWatermark, uint16_t menuI2cPullupValue)
+{
+	WarpStatus	status = kWarpStatusOK;
+
+	status |= writeSensorRegisterBMX055accel(kWarpSensorConfigurationRegisterBMX055accelPMU_BW /* register address PMU_BW */,
+							0b00001110 /* payload: 500 Hz bandwidth */,
+							menuI2cPullupValue);
+	status |= writeSensorRegisterBMX055accel(kWarpSensorConfigurationRegisterBMX055accelACCD_HBW /* register address ACCD_HBW */,
+							0b00000000 /* payload: filtered data, shadowing enabled */,
+							menuI2cPullupValue);
+	status |= writeSensorRegisterBMX055accel(kWarpSensorConfigurationRegisterBMX055accelFIFO_CONFIG_1 /* register address FIFO_CONFIG_1 */,
+							0b10000000 /* payload: stream mode, X/Y/Z; clears the FIFO */,
+							menuI2cPullupValue);
+
+	status |= writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroBW /* register address BW */,
+							0b00000010 /* payload: ODR 1 kHz, filter 116 Hz */,
+							menuI2cPullupValue);
+	status |= writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroFIFO_CONFIG_0 /* register address FIFO_CONFIG_0 */,
+							gyroWatermark & 0x7F /* payload: watermark, no tag */,
+							menuI2cPullupValue);
+	status |= writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroFIFO_CONFIG_1 /* register address FIFO_CONFIG_1 */,
+							0b10000000 /* payload: stream mode, X/Y/Z; clears the FIFO */,
+							menuI2cPullupValue);
+	status |= writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroINT_EN_1 /* register address INT_EN_1 */,
+							0b00000010 /* payload: int1_od open drain, int1_lvl active low */,
+							menuI2cPullupValue);
+	status |= writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroINT_MAP_1 /* register address INT_MAP_1 */,
+							0b00000100 /* payload: int1_fifo */,
+							menuI2cPullupValue);
+	status |= writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroFIFO_WM_INT /* register address FIFO_WM_INT */,
+							0b10000000 /* payload: fifo_wm_en */,
+							menuI2cPullupValue);
+	status |= writeSensorRegisterBMX055gyro(kWarpSensorConfigurationRegisterBMX055gyroINT_EN_0 /* register address INT_EN_0 */,
+							0b01000000 /* payload: fifo_en */,
+							menuI2cPullupValue);
+
+	status |= writeSensorRegisterBMX055mag(kWarpSensorConfigurationRegisterBMX055magPowerCtrl /* register address PowerCtrl */,
+							0b00000001 /* payload: from suspend mode to sleep mode */,
+							menuI2cPullupValue);
+	status |= writeSensorRegisterBMX055mag(kWarpSensorConfigurationRegisterBMX055magOpMode /* register address OpMode */,
+							0b00000110 /* payload: sleep mode */,
+							menuI2cPullupValue);
 
 	/*
-	 *	Sign extend the 13-bit value based on knowledge that upper 3 bit are 0:
+	 *	Nothing to wait for before the first trigger.
 	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 12)) - (1 << 12);
+	magTriggerTransaction.done = true;
 
+	return status;
+}
 
-	if (i2cReadStatus != kWarpStatusOK)
+/*
+ *	FIFO_STATUS: frame counter and overrun flag.
+ */
+static WarpStatus
+readFifoStatusBMX055(uint8_t i2cAddress, uint8_t deviceRegister, size_t *  frameCount, bool *  overrun)
+{
+	uint8_t		fifoStatus;
+	WarpStatus	status;
+
+	status = warpI2cReadBurst(i2cAddress, deviceRegister, &fifoStatus, 1);
+	if (status != kWarpStatusOK)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		return status;
 	}
-	else
+
+	*frameCount = fifoStatus & 0x7F /* fifo_frame_counter */;
+	if (fifoStatus & 0x80 /* fifo_overrun */)
 	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
+		*overrun = true;
 	}
 
-	i2cReadStatus = readSensorRegisterBMX055mag(kWarpSensorOutputRegisterBMX055magY_LSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceBMX055magState.i2cBuffer[0];
-	readSensorRegisterValueMSB = deviceBMX055magState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 5) | (readSensorRegisterValueLSB >> 3);
+	return kWarpStatusOK;
+}
 
+static void
+triggerMeasurementBMX055mag(void)
+{
 	/*
-	 *	Sign extend the 13-bit value based on knowledge that upper 4 bit are 0:
+	 *	The previous trigger has long gone out by the time we come round.
 	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 12)) - (1 << 12);
+	warpI2cWait(&magTriggerTransaction);
 
+	magTriggerPayload			= 0b00000010 /* forced mode */;
+	magTriggerTransaction.i2cAddress	= deviceBMX055magState.i2cAddress;
+	magTriggerTransaction.deviceRegister	= kWarpSensorConfigurationRegisterBMX055magOpMode;
+	magTriggerTransaction.direction		= kWarpI2cDirectionWrite;
+	magTriggerTransaction.buffer		= &magTriggerPayload;
+	magTriggerTransaction.numberOfBytes	= 1;
+	magTriggerTransaction.callback		= NULL;
 
-	if (i2cReadStatus != kWarpStatusOK)
+	warpI2cSubmit(&magTriggerTransaction);
+}
+
+/*
+ *	One round: collect the last magnetometer measurement and trigger the
+ *	next, then drain as many frame pairs as both FIFOs hold (up to
+ *	batch->maxFrames; any more stay for the next round). Six transactions
+ *	however many frames there are.
+ */
+WarpStatus
+drainFifoBMX055(WarpBMX055Batch *  batch)
+{
+	size_t		accelFrames = 0, gyroFrames = 0, frameCount;
+	uint32_t	nowMicroseconds;
+	WarpStatus	status;
+
+	batch->frameCount	= 0;
+	batch->overrun		= false;
+	batch->magFresh		= false;
+
+	status = warpI2cReadBurst(deviceBMX055magState.i2cAddress, kWarpSensorOutputRegisterBMX055magX_LSB,
+				magSampleRegisterValues, sizeof(magSampleRegisterValues));
+	if (status != kWarpStatusOK)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		return status;
 	}
-	else
+
+	if (magSampleRegisterValues[kWarpSensorOutputRegisterBMX055magRHALL_LSB - kWarpSensorOutputRegisterBMX055magX_LSB] & 0x01 /* data ready */)
 	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
+		static const uint8_t	fieldBits[3] = {13, 13, 15};
+
+		for (int field = 0; field < 3; field++)
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			uint16_t	readSensorRegisterValueLSB = magSampleRegisterValues[2*field];
+			uint16_t	readSensorRegisterValueMSB = magSampleRegisterValues[2*field + 1];
+
+			batch->mag[field] = warpFixedPointSignExtend(((readSensorRegisterValueMSB & 0xFF) << (fieldBits[field] - 8)) |
+							(readSensorRegisterValueLSB >> (16 - fieldBits[field])), fieldBits[field]);
 		}
+		batch->magFresh = true;
 	}
+	triggerMeasurementBMX055mag();
 
-	i2cReadStatus = readSensorRegisterBMX055mag(kWarpSensorOutputRegisterBMX055magZ_LSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceBMX055magState.i2cBuffer[0];
-	readSensorRegisterValueMSB = deviceBMX055magState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 7) | (readSensorRegisterValueLSB >> 1);
-
-	/*
-	 *	Sign extend the 15-bit value based on knowledge that upper 1 bit are 0:
-	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 14)) - (1 << 14);
-
+	nowMicroseconds = (uint32_t)warpTimeNowUs();
+	status = readFifoStatusBMX055(deviceBMX055gyroState.i2cAddress, kWarpSensorOutputRegisterBMX055gyroFIFO_STATUS, &gyroFrames, &batch->overrun);
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+	status = readFifoStatusBMX055(deviceBMX055accelState.i2cAddress, kWarpSensorOutputRegisterBMX055accelFIFO_STATUS, &accelFrames, &batch->overrun);
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
 
-	if (i2cReadStatus != kWarpStatusOK)
+	frameCount = (accelFrames < gyroFrames) ? accelFrames : gyroFrames;
+	if (frameCount > batch->maxFrames)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		frameCount = batch->maxFrames;
 	}
-	else
+	if (frameCount == 0)
 	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
+		return kWarpStatusOK;
 	}
 
-	i2cReadStatus = readSensorRegisterBMX055mag(kWarpSensorOutputRegisterBMX055magRHALL_LSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceBMX055magState.i2cBuffer[0];
-	readSensorRegisterValueMSB = deviceBMX055magState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 6) | (readSensorRegisterValueLSB >> 2);
+	status = warpI2cReadBurst(deviceBMX055accelState.i2cAddress, kWarpSensorOutputRegisterBMX055accelFIFO_DATA,
+				(uint8_t *)batch->accel, frameCount * kWarpBMX055FifoFrameBytes);
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+	status = warpI2cReadBurst(deviceBMX055gyroState.i2cAddress, kWarpSensorOutputRegisterBMX055gyroFIFO_DATA,
+				(uint8_t *)batch->gyro, frameCount * kWarpBMX055FifoFrameBytes);
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
 
 	/*
-	 *	Sign extend the 14-bit value based on knowledge that upper 2 bit are 0:
+	 *	Each frame's six bytes become its three values in place, in the
+	 *	same layout as the data registers.
 	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 13)) - (1 << 13);
-
-
-	if (i2cReadStatus != kWarpStatusOK)
+	for (size_t i = 0; i < frameCount * 3; i++)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
+		uint8_t *	accelBytes = (uint8_t *)batch->accel;
+		uint8_t *	gyroBytes = (uint8_t *)batch->gyro;
+		uint16_t	accelLSB = accelBytes[2*i], accelMSB = accelBytes[2*i + 1];
+		uint16_t	gyroLSB = gyroBytes[2*i], gyroMSB = gyroBytes[2*i + 1];
+
+		batch->accel[i]	= warpFixedPointSignExtend(((accelMSB & 0xFF) << 4) | (accelLSB >> 4), 12);
+		batch->gyro[i]	= (int16_t)(((gyroMSB & 0xFF) << 8) | (gyroLSB & 0xFF));
 	}
-}
+
+	/*
+	 *	The newest of the gyro's frames arrived at most a period before we
+	 *	read its counter, and we read from the oldest.
+	 */
+	batch->frameCount		= frameCount;
+	batch->framePeriodMicroseconds	= kWarpBMX055FifoFramePeriodMicroseconds;
+	batch->firstFrameMicroseconds	= nowMicroseconds - (gyroFrames - 1) * kWarpBMX055FifoFramePeriodMicroseconds;
+
+	return kWarpStatusOK;
+}
\ No newline at end of file
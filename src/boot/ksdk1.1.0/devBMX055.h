@@ -39,6 +39,27 @@
 #define WARP_BUILD_ENABLE_DEVBMX055
 #endif
 
+/*
+ *	One drainFifoBMX055() round. The caller provides accel and gyro, room
+ *	for maxFrames X/Y/Z frames each; the rest is filled in. Frame i of
+ *	both was sampled at about firstFrameMicroseconds + i *
+ *	framePeriodMicroseconds, and mag is the newest magnetometer reading
+ *	(raw X, Y, Z, uncompensated), fresh if it was taken since the last round.
+ */
+typedef struct
+{
+	int16_t *	accel;
+	int16_t *	gyro;
+	size_t		maxFrames;
+
+	size_t		frameCount;
+	uint32_t	firstFrameMicroseconds;
+	uint32_t	framePeriodMicroseconds;
+	bool		overrun;
+	int16_t		mag[3];
+	bool		magFresh;
+} WarpBMX055Batch;
+
 
 void		initBMX055accel(const uint8_t i2cAddress, WarpI2CDeviceState volatile *  deviceStatePointer);
 void		initBMX055gyro(const uint8_t i2cAddress, WarpI2CDeviceState volatile *  deviceStatePointer);
@@ -84,4 +105,17 @@ WarpStatus	readSensorSignalBMX055mag(WarpTypeMask signal,
 
 void		printSensorDataBMX055accel(bool hexModeFlag);
 void		printSensorDataBMX055gyro(bool hexModeFlag);
-void		printSensorDataBMX055mag(bool hexModeFlag);
\ No newline at end of file
+void		printSensorDataBMX055mag(bool hexModeFlag);
+WarpStatus	queueSensorSampleBMX055accel(void);
+WarpStatus	queueSensorSampleBMX055gyro(void);
+WarpStatus	queueSensorSampleBMX055mag(void);
+void		printSensorSampleBMX055accel(bool hexModeFlag);
+void		printSensorSampleBMX055gyro(bool hexModeFlag);
+void		printSensorSampleBMX055mag(bool hexModeFlag);
+WarpStatus	configureDataReadyBMX055accel(uint16_t menuI2cPullupValue);
+WarpStatus	configureDataReadyBMX055gyro(uint16_t menuI2cPullupValue);
+
+extern const WarpDataReadySource	dataReadySourceBMX055accel;
+extern const WarpDataReadySource	dataReadySourceBMX055gyro;
+WarpStatus	configureFifoBMX055(uint8_t gyroWatermark, uint16_t menuI2cPullupValue);
+WarpStatus	drainFifoBMX055(WarpBMX055Batch *  batch);
\ No newline at end of file
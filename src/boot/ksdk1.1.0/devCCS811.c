@@ -251,21 +251,20 @@ printSensorDataCCS811(bool hexModeFlag)
 	TVOC		= (deviceCCS811State.i2cBuffer[2] << 8) | deviceCCS811State.i2cBuffer[3];
 	if (i2cReadStatus != kWarpStatusOK)
 	{
-		SEGGER_RTT_WriteString(0, " ----, ----,");
+		warpCsvMissing();
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x, 0x%02x 0x%02x,",
-				deviceCCS811State.i2cBuffer[3],
-				deviceCCS811State.i2cBuffer[2],
-				deviceCCS811State.i2cBuffer[1],
-				deviceCCS811State.i2cBuffer[0]);
+			warpCsvHex((deviceCCS811State.i2cBuffer[3] << 8) | deviceCCS811State.i2cBuffer[2], 2);
+			warpCsvHex((deviceCCS811State.i2cBuffer[1] << 8) | deviceCCS811State.i2cBuffer[0], 2);
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d, %d,", equivalentCO2, TVOC);
+			warpCsvInt(equivalentCO2);
+			warpCsvInt(TVOC);
 		}
 	}
 
@@ -281,17 +280,17 @@ printSensorDataCCS811(bool hexModeFlag)
 						(readSensorRegisterValueMSB & 0xFF);
 	if (i2cReadStatus != kWarpStatusOK)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			warpCsvInt(readSensorRegisterValueCombined);
 		}
 	}
 }
\ No newline at end of file
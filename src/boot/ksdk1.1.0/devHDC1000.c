@@ -243,20 +243,20 @@ printSensorDataHDC1000(bool hexModeFlag)
 
 	if (i2cReadStatus != kWarpStatusOK)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
 		}
 		else
 		{
 			/*
 			 *	See Section 8.6.1 of the HDC1000 manual for the conversion to temperature.
 			 */
-			SEGGER_RTT_printf(0, " %d,", (readSensorRegisterValueCombined*165 / (1u << 16)) - 40);
+			warpCsvInt((readSensorRegisterValueCombined*165 / (1u << 16)) - 40);
 		}
 	}
 
@@ -271,20 +271,20 @@ printSensorDataHDC1000(bool hexModeFlag)
 
 	if (i2cReadStatus != kWarpStatusOK)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
 		}
 		else
 		{
 			/*
 			 *	See Section 8.6.2 of the HDC1000 manual for the conversion to temperature.
 			 */
-			SEGGER_RTT_printf(0, " %d,", (readSensorRegisterValueCombined*100 / (1u << 16)));
+			warpCsvInt((readSensorRegisterValueCombined*100 / (1u << 16)));
 		}
 	}
 }
\ No newline at end of file
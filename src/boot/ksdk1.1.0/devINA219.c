@@ -16,6 +16,7 @@
 #include "gpio_pins.h"
 #include "SEGGER_RTT.h"
 #include "warp.h"
+#include "devINA219.h"
 
 
 extern volatile WarpI2CDeviceState	deviceINA219State;
@@ -23,6 +24,46 @@ extern volatile uint32_t		gWarpI2cBaudRateKbps;
 extern volatile uint32_t		gWarpI2cTimeoutMilliseconds;
 extern volatile uint32_t		gWarpSupplySettlingDelayMilliseconds;
 
+enum
+{
+	/*
+	 *	The power-on defaults (BRNG 32 V, PGA /8, 12-bit bus ADC, shunt and
+	 *	bus continuous) with the SADC field (bits 6--3) set to the chosen
+	 *	averaging mode.
+	 */
+	kWarpINA219ConfigurationBase	= (0x1 << 13) | (0x3 << 11) | (0x3 << 7) | 0x7,
+	kWarpINA219BusConversionMicroseconds = 532,
+	kWarpINA219ConfigurationSADC	= 3,
+
+	/*
+	 *	Calibration = 0.04096 / (Current_LSB * R_shunt). With the 0.1 ohm
+	 *	shunt and Current_LSB = 100 uA the Current register reads in units
+	 *	of 100 uA (i.e., it equals the Shunt Voltage register).
+	 */
+	kWarpINA219Calibration		= 4096,
+
+	kWarpINA219PointerUnknown	= 0xFF,
+};
+
+/*
+ *	The INA219 keeps its register pointer between reads, so we track it
+ *	and only write it when a read targets a different register.
+ */
+static volatile uint8_t			pointerRegister = kWarpINA219PointerUnknown;
+static WarpINA219Averaging		samplerAveraging = kWarpINA219Averaging1;
+
+/*
+ *	Current register samples, filled from the I2C interrupt and drained by
+ *	takeSamplesINA219(). Free-running indices; one writer, one reader.
+ */
+static int16_t				sampleRing[kWarpINA219SampleRingLength];
+static volatile uint8_t			sampleRingHead;
+static volatile uint8_t			sampleRingTail;
+static volatile uint32_t		sampleRingOverruns;
+static uint8_t				sampleRegisterValues[2];
+static WarpI2cTransaction		sampleTransaction;
+static volatile bool			sampleInFlight;
+
 
 
 void
@@ -92,38 +133,210 @@ writeSensorRegisterINA219(uint8_t deviceRegister, uint8_t payload, uint16_t menu
 
 	if (status != kStatus_I2C_Success)
 	{
+		pointerRegister = kWarpINA219PointerUnknown;
+
 		return kWarpStatusDeviceCommunicationFailed;
 	}
 
+	pointerRegister = deviceRegister;
+
 	return kWarpStatusOK;
 }
 
 
+/*
+ *	Write a 16-bit register, MSB first. This also leaves the pointer on it.
+ */
+static WarpStatus
+writeRegisterWordINA219(uint8_t deviceRegister, uint16_t payload)
+{
+	uint8_t		payloadBytes[2] = {payload >> 8, payload & 0xFF};
+	WarpStatus	status;
+
+	status = warpI2cWriteBurst(deviceINA219State.i2cAddress, deviceRegister, payloadBytes, sizeof(payloadBytes));
+	pointerRegister = (status == kWarpStatusOK) ? deviceRegister : kWarpINA219PointerUnknown;
+
+	return status;
+}
+
+/*
+ *	Fill in a 2-byte read of deviceRegister, skipping the pointer write if
+ *	the pointer is already there. The pointer is updated at submission,
+ *	which matches the order the queue runs transactions in.
+ */
+static void
+prepareRegisterReadINA219(WarpI2cTransaction *  transaction, uint8_t deviceRegister, uint8_t *  buffer)
+{
+	transaction->i2cAddress		= deviceINA219State.i2cAddress;
+	transaction->deviceRegister	= deviceRegister;
+	transaction->direction		= (pointerRegister == deviceRegister) ? kWarpI2cDirectionReadAtPointer : kWarpI2cDirectionRead;
+	transaction->buffer		= buffer;
+	transaction->numberOfBytes	= 2;
+	transaction->callback		= NULL;
+
+	pointerRegister = deviceRegister;
+}
+
+static WarpStatus
+readRegisterINA219(uint8_t deviceRegister, uint8_t *  buffer)
+{
+	WarpI2cTransaction	transaction;
+	WarpStatus		status;
+
+	prepareRegisterReadINA219(&transaction, deviceRegister, buffer);
+	status = warpI2cSubmit(&transaction);
+	if (status == kWarpStatusOK)
+	{
+		status = warpI2cWait(&transaction);
+	}
+
+	if (status != kWarpStatusOK)
+	{
+		pointerRegister = kWarpINA219PointerUnknown;
+	}
+
+	return status;
+}
+
+/*
+ *	Program the configuration (continuous, with the given shunt
+ *	hardware averaging) and calibration registers. Needed once; sampling
+ *	after that only ever reads.
+ */
+WarpStatus
+configureSensorINA219(WarpINA219Averaging averaging)
+{
+	WarpStatus	status;
+
+	status = writeRegisterWordINA219(kWarpSensorConfigurationRegisterINA219Configuration,
+					kWarpINA219ConfigurationBase | (averaging << kWarpINA219ConfigurationSADC));
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+	samplerAveraging = averaging;
+
+	return writeRegisterWordINA219(kWarpSensorConfigurationRegisterINA219Calibration,
+					kWarpINA219Calibration);
+}
+
+/*
+ *	Time between new Current register values in the configured mode: the
+ *	shunt conversion (532 us times the number of samples averaged) plus
+ *	the 12-bit bus conversion.
+ */
+uint32_t
+conversionMicrosecondsINA219(void)
+{
+	return (532UL << (samplerAveraging - kWarpINA219Averaging1)) + kWarpINA219BusConversionMicroseconds;
+}
+
+static void
+sampleCompleteINA219(WarpI2cTransaction *  transaction)
+{
+	if (transaction->status != kWarpStatusOK)
+	{
+		pointerRegister = kWarpINA219PointerUnknown;
+	}
+	else if ((uint8_t)(sampleRingHead - sampleRingTail) == kWarpINA219SampleRingLength)
+	{
+		sampleRingOverruns++;
+	}
+	else
+	{
+		sampleRing[sampleRingHead & (kWarpINA219SampleRingLength - 1)] = (int16_t)((sampleRegisterValues[0] << 8) | sampleRegisterValues[1]);
+		sampleRingHead++;
+	}
+
+	sampleInFlight = false;
+}
+
+/*
+ *	Queue one read of the Current register into the sample ring. With the
+ *	pointer cached this is a single 3-byte bus transaction (address and two
+ *	data bytes). Call at most once per conversionMicrosecondsINA219() to
+ *	avoid reading the same conversion twice; a call while the previous read
+ *	is still in flight is ignored.
+ */
+WarpStatus
+queueSampleINA219(void)
+{
+	WarpStatus	status;
+
+	if (sampleInFlight)
+	{
+		return kWarpStatusOK;
+	}
+
+	sampleInFlight = true;
+	prepareRegisterReadINA219(&sampleTransaction, kWarpSensorOutputRegisterINA219Current, sampleRegisterValues);
+	sampleTransaction.callback = sampleCompleteINA219;
+
+	status = warpI2cSubmit(&sampleTransaction);
+	if (status != kWarpStatusOK)
+	{
+		sampleInFlight = false;
+	}
+
+	return status;
+}
+
+/*
+ *	Copy up to maxSamples of the oldest queued samples (units of 100 uA)
+ *	out of the ring and return how many were copied.
+ */
+size_t
+takeSamplesINA219(int16_t *  samples, size_t maxSamples)
+{
+	size_t	count = 0;
+
+	while ((count < maxSamples) && (sampleRingTail != sampleRingHead))
+	{
+		samples[count++] = sampleRing[sampleRingTail & (kWarpINA219SampleRingLength - 1)];
+		sampleRingTail++;
+	}
+
+	return count;
+}
+
+/*
+ *	Samples dropped because the ring was full.
+ */
+uint32_t
+sampleOverrunsINA219(void)
+{
+	return sampleRingOverruns;
+}
+
+
 void
 printSensorDataINA219()
 {
-	uint16_t	readSensorRegisterValueLSB;
-	uint16_t	readSensorRegisterValueMSB;
+	uint8_t		registerValues[2];
 	int16_t		readSensorRegisterValueCombined;
 
-	// Set pointer address to Bus Voltage (0x02 from data sheet)
-	writeSensorRegisterINA219(0x02,0x00,1);
-
-	// Read both MSB and LSB of Bus Voltage:
-	readSensorRegisterINA219(2);
-	readSensorRegisterValueMSB = deviceINA219State.i2cBuffer[0];
-	readSensorRegisterValueLSB = deviceINA219State.i2cBuffer[1];
-	// Taking the top 12 bits as defined by the data sheet:
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 5) | ((readSensorRegisterValueLSB & 0xF8) >> 3);
-	SEGGER_RTT_printf(0, "\nBus Voltage Reading: %d, giving Bus Voltage: %dmV", readSensorRegisterValueCombined, readSensorRegisterValueCombined * 4);
-
-	// Set pointer address to Shunt Voltage (0x01 from data sheet)
-        writeSensorRegisterINA219(0x01,0x00,1);
-        // Read both MSB and LSB of Shunt Voltage:
-        readSensorRegisterINA219(2);
-        readSensorRegisterValueMSB = deviceINA219State.i2cBuffer[0];
-        readSensorRegisterValueLSB = deviceINA219State.i2cBuffer[1];
-        readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
-        SEGGER_RTT_printf(0, "\nShunt Voltage Reading: %d, giving Shunt Voltage: %duV, giving Current: %duA", readSensorRegisterValueCombined,readSensorRegisterValueCombined*10, readSensorRegisterValueCombined*100);
-}
+	/*
+	 *	Bus Voltage: the top 13 bits, 4 mV per LSB.
+	 */
+	if (readRegisterINA219(kWarpSensorOutputRegisterINA219BusVoltage, registerValues) != kWarpStatusOK)
+	{
+		SEGGER_RTT_WriteString(0, "\nINA219 read failed");
+		return;
+	}
+	readSensorRegisterValueCombined = ((registerValues[0] & 0xFF) << 5) | ((registerValues[1] & 0xF8) >> 3);
+	SEGGER_RTT_printf(0, "\nBus Voltage Reading: %d, giving Bus Voltage: %dmV", readSensorRegisterValueCombined,
+			warpFixedPointConvert(readSensorRegisterValueCombined, kWarpFixedPointScaleINA219BusMillivolts));
 
+	/*
+	 *	Shunt Voltage: 10 uV per LSB, across the 0.1 ohm shunt.
+	 */
+	if (readRegisterINA219(kWarpSensorOutputRegisterINA219ShuntVoltage, registerValues) != kWarpStatusOK)
+	{
+		SEGGER_RTT_WriteString(0, "\nINA219 read failed");
+		return;
+	}
+	readSensorRegisterValueCombined = ((registerValues[0] & 0xFF) << 8) | (registerValues[1] & 0xFF);
+	SEGGER_RTT_printf(0, "\nShunt Voltage Reading: %d, giving Shunt Voltage: %duV, giving Current: %duA", readSensorRegisterValueCombined,
+			warpFixedPointConvert(readSensorRegisterValueCombined, kWarpFixedPointScaleINA219ShuntMicrovolts),
+			warpFixedPointConvert(readSensorRegisterValueCombined, kWarpFixedPointScaleINA219ShuntMicroamps));
+}
@@ -4,7 +4,37 @@
 #define WARP_BUILD_ENABLE_DEVINA219
 #endif
 
+typedef enum
+{
+	/*
+	 *	Configuration register SADC field values: 12-bit shunt conversions
+	 *	averaged in hardware over 1--128 samples, trading sample rate for
+	 *	noise. Conversion times are from Table 5 of the datasheet.
+	 */
+	kWarpINA219Averaging1		= 0x8,	/*	532 us		*/
+	kWarpINA219Averaging2		= 0x9,	/*	1.06 ms		*/
+	kWarpINA219Averaging4		= 0xA,	/*	2.13 ms		*/
+	kWarpINA219Averaging8		= 0xB,	/*	4.26 ms		*/
+	kWarpINA219Averaging16		= 0xC,	/*	8.51 ms		*/
+	kWarpINA219Averaging32		= 0xD,	/*	17.02 ms	*/
+	kWarpINA219Averaging64		= 0xE,	/*	34.05 ms	*/
+	kWarpINA219Averaging128		= 0xF,	/*	68.10 ms	*/
+} WarpINA219Averaging;
+
+typedef enum
+{
+	/*
+	 *	Must be a power of two.
+	 */
+	kWarpINA219SampleRingLength	= 16,
+} WarpINA219Constants;
+
 void		initINA219(const uint8_t i2cAddress, WarpI2CDeviceState volatile *  deviceStatePointer);
+WarpStatus	configureSensorINA219(WarpINA219Averaging averaging);
+uint32_t	conversionMicrosecondsINA219(void);
+WarpStatus	queueSampleINA219(void);
+size_t		takeSamplesINA219(int16_t *  samples, size_t maxSamples);
+uint32_t	sampleOverrunsINA219(void);
 WarpStatus	readSensorRegisterINA219(int numberOfBytes);
 WarpStatus	writeSensorRegisterINA219(uint8_t deviceRegister,
 					uint8_t payloadBtye, uint16_t menuI2cPullupValue);
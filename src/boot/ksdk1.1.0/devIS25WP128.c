@@ -49,6 +49,468 @@
 #include "gpio_pins.h"
 #include "SEGGER_RTT.h"
 #include "warp.h"
+#include "devIS25WP128.h"
 
 
+extern volatile WarpSPIDeviceState	deviceIS25WP128State;
+extern volatile uint32_t		gWarpSpiBaudRateKbps;
 
+
+/*
+ *	The flash sits in deep power-down (around 1 uA, against several in
+ *	standby) except while a call below is using it: each wakes it with
+ *	Release Power-Down, waits tRES1, does its work, and puts it back.
+ *	Programs and erases poll the status register until the write has
+ *	finished, since the part ignores Deep Power-Down while busy.
+ *
+ *	Data goes over the bus straight from and into the caller's buffers,
+ *	in one transfer per page programmed or per read, with /CS held low
+ *	from the command: only the command and address bytes go through
+ *	deviceIS25WP128State.
+ *
+ *	The driver never touches the SPI pin mux or the KSDK SPI master: it
+ *	uses the bus as devSSD1331init() (or enableSPIpins(), without the
+ *	SSD1331) left it, as the SSD1331 drives PTB0 as its reset line and
+ *	has its own transfers queued on the same master. Deep Power-Down alone
+ *	brings the part to its lowest current. Callers share the bus by
+ *	fencing the SSD1331's queued commands (devSSD1331fenceCommands())
+ *	first, so that no queued transfer starts under the flash's /CS.
+ */
+enum
+{
+	kWarpIS25WP128CommandBytes		= 4,
+	kWarpIS25WP128FastReadCommandBytes	= 5,
+	kWarpIS25WP128SpiTimeoutMarginMilliseconds	= 5,
+};
+
+static bool	poweredDown;
+
+
+static void
+waitMicroseconds(uint32_t microseconds)
+{
+	uint64_t	until = warpTimeNowUs() + microseconds;
+
+	while (warpTimeNowUs() < until)
+	{
+	}
+}
+
+/*
+ *	One SPI transfer within the current /CS assertion. Either buffer may be
+ *	NULL: the KSDK then sends zeros, or drops what it receives.
+ */
+static WarpStatus
+transfer(const uint8_t *  sendBuffer, uint8_t *  receiveBuffer, size_t numberOfBytes)
+{
+	deviceIS25WP128State.ksdk_spi_status = SPI_DRV_MasterTransferBlocking(0 /* master instance */,
+					NULL /* spi_master_user_config_t */,
+					sendBuffer,
+					receiveBuffer,
+					numberOfBytes,
+					(numberOfBytes * 8) / gWarpSpiBaudRateKbps + kWarpIS25WP128SpiTimeoutMarginMilliseconds);
+
+	return (deviceIS25WP128State.ksdk_spi_status == kStatus_SPI_Success) ? kWarpStatusOK : kWarpStatusCommsError;
+}
+
+static void
+chipSelect(void)
+{
+	/*
+	 *	Make sure there is a high-to-low transition by first driving high, then drive low.
+	 */
+	GPIO_DRV_SetPinOutput(kWarpPinIS25WP128_nCS);
+	GPIO_DRV_ClearPinOutput(kWarpPinIS25WP128_nCS);
+}
+
+static void
+chipDeselect(void)
+{
+	GPIO_DRV_SetPinOutput(kWarpPinIS25WP128_nCS);
+}
+
+/*
+ *	A command with no address or data.
+ */
+static WarpStatus
+sendCommand(WarpIS25WP128Command command)
+{
+	WarpStatus	status;
+
+	deviceIS25WP128State.spiSourceBuffer[0] = command;
+	chipSelect();
+	status = transfer((const uint8_t *)deviceIS25WP128State.spiSourceBuffer, NULL, 1);
+	chipDeselect();
+
+	return status;
+}
+
+/*
+ *	Assert /CS and send command and the 24-bit address, plus a dummy byte
+ *	for Fast Read. The caller transfers the data and deasserts /CS.
+ */
+static WarpStatus
+startAddressedCommand(WarpIS25WP128Command command, uint32_t address)
+{
+	size_t		numberOfBytes = kWarpIS25WP128CommandBytes;
+
+	deviceIS25WP128State.spiSourceBuffer[0] = command;
+	deviceIS25WP128State.spiSourceBuffer[1] = (address >> 16) & 0xFF;
+	deviceIS25WP128State.spiSourceBuffer[2] = (address >> 8) & 0xFF;
+	deviceIS25WP128State.spiSourceBuffer[3] = address & 0xFF;
+	if (command == kWarpIS25WP128CommandFastRead)
+	{
+		deviceIS25WP128State.spiSourceBuffer[4] = 0x00;
+		numberOfBytes = kWarpIS25WP128FastReadCommandBytes;
+	}
+
+	chipSelect();
+
+	return transfer((const uint8_t *)deviceIS25WP128State.spiSourceBuffer, NULL, numberOfBytes);
+}
+
+static WarpStatus
+leavePowerDown(void)
+{
+	WarpStatus	status;
+
+	if (!poweredDown)
+	{
+		return kWarpStatusOK;
+	}
+
+	status = sendCommand(kWarpIS25WP128CommandReleasePowerDown);
+	waitMicroseconds(kWarpIS25WP128ReleaseMicroseconds);
+	poweredDown = false;
+
+	return status;
+}
+
+static void
+enterPowerDown(void)
+{
+	sendCommand(kWarpIS25WP128CommandDeepPowerDown);
+	poweredDown = true;
+}
+
+static WarpStatus
+readStatus(uint8_t *  status)
+{
+	WarpStatus	spiStatus;
+
+	deviceIS25WP128State.spiSourceBuffer[0] = kWarpIS25WP128CommandReadStatus;
+	deviceIS25WP128State.spiSourceBuffer[1] = 0x00;
+	chipSelect();
+	spiStatus = transfer((const uint8_t *)deviceIS25WP128State.spiSourceBuffer, (uint8_t *)deviceIS25WP128State.spiSinkBuffer, 2);
+	chipDeselect();
+	*status = deviceIS25WP128State.spiSinkBuffer[1];
+
+	return spiStatus;
+}
+
+/*
+ *	Poll until the write in progress finishes. Erases take hundreds of
+ *	milliseconds, so they are polled every millisecond, sleeping between.
+ */
+static WarpStatus
+waitWhileBusy(uint32_t timeoutMicroseconds, bool sleepBetweenPolls)
+{
+	uint64_t	deadline = warpTimeNowUs() + timeoutMicroseconds;
+	uint8_t		statusRegister;
+	WarpStatus	status;
+
+	while (1)
+	{
+		status = readStatus(&statusRegister);
+		if (status != kWarpStatusOK)
+		{
+			return status;
+		}
+
+		if (!(statusRegister & kWarpIS25WP128StatusWIP))
+		{
+			return kWarpStatusOK;
+		}
+
+		if (warpTimeNowUs() > deadline)
+		{
+			return kWarpStatusTimeout;
+		}
+
+		if (sleepBetweenPolls)
+		{
+			OSA_TimeDelay(1);
+		}
+	}
+}
+
+/*
+ *	Write Enable, checking that it took (it does not if the part is not
+ *	there, or is still busy).
+ */
+static WarpStatus
+writeEnable(void)
+{
+	uint8_t		statusRegister;
+	WarpStatus	status;
+
+	status = sendCommand(kWarpIS25WP128CommandWriteEnable);
+	if (status == kWarpStatusOK)
+	{
+		status = readStatus(&statusRegister);
+	}
+	if ((status == kWarpStatusOK) && !(statusRegister & kWarpIS25WP128StatusWEL))
+	{
+		status = kWarpStatusDeviceCommunicationFailed;
+	}
+
+	return status;
+}
+
+static WarpStatus
+erase(WarpIS25WP128Command command, uint32_t address, uint32_t timeoutMilliseconds)
+{
+	WarpStatus	status;
+
+	status = writeEnable();
+	if (status == kWarpStatusOK)
+	{
+		status = startAddressedCommand(command, address);
+		chipDeselect();
+	}
+	if (status == kWarpStatusOK)
+	{
+		status = waitWhileBusy(timeoutMilliseconds * 1000, true);
+	}
+
+	return status;
+}
+
+/*
+ *	Leaves the part in deep power-down. Requires warpTimeInit() and the
+ *	SPI master already set up (see above).
+ */
+void
+initIS25WP128(WarpSPIDeviceState volatile *  deviceStatePointer)
+{
+	chipDeselect();
+
+	/*
+	 *	Whatever state it powered up in, Release Power-Down is harmless.
+	 */
+	poweredDown = true;
+	leavePowerDown();
+	enterPowerDown();
+}
+
+WarpStatus
+readJedecIdIS25WP128(uint8_t *  manufacturerId, uint16_t *  deviceId)
+{
+	WarpStatus	status;
+
+	status = leavePowerDown();
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+
+	deviceIS25WP128State.spiSourceBuffer[0] = kWarpIS25WP128CommandReadJedecId;
+	deviceIS25WP128State.spiSourceBuffer[1] = 0x00;
+	deviceIS25WP128State.spiSourceBuffer[2] = 0x00;
+	deviceIS25WP128State.spiSourceBuffer[3] = 0x00;
+	chipSelect();
+	status = transfer((const uint8_t *)deviceIS25WP128State.spiSourceBuffer, (uint8_t *)deviceIS25WP128State.spiSinkBuffer, 4);
+	chipDeselect();
+	enterPowerDown();
+
+	*manufacturerId	= deviceIS25WP128State.spiSinkBuffer[1];
+	*deviceId	= (deviceIS25WP128State.spiSinkBuffer[2] << 8) | deviceIS25WP128State.spiSinkBuffer[3];
+
+	if ((status == kWarpStatusOK) && ((*manufacturerId != kWarpIS25WP128ManufacturerId) ||
+		(*deviceId != ((kWarpIS25WP128MemoryType << 8) | kWarpIS25WP128CapacityId))))
+	{
+		status = kWarpStatusDeviceNotInitialized;
+	}
+
+	return status;
+}
+
+WarpStatus
+readStatusIS25WP128(uint8_t *  status)
+{
+	WarpStatus	spiStatus;
+
+	spiStatus = leavePowerDown();
+	if (spiStatus == kWarpStatusOK)
+	{
+		spiStatus = readStatus(status);
+	}
+	enterPowerDown();
+
+	return spiStatus;
+}
+
+/*
+ *	Fast Read (up to 133 MHz, far above what the KL03's SPI can clock): the
+ *	whole range in one burst, the address counter running on across pages
+ *	and sectors.
+ */
+WarpStatus
+readIS25WP128(uint32_t address, uint8_t *  buffer, size_t numberOfBytes)
+{
+	WarpStatus	status;
+
+	if ((address >= kWarpIS25WP128CapacityBytes) || (numberOfBytes > kWarpIS25WP128CapacityBytes - address))
+	{
+		return kWarpStatusBadDeviceCommand;
+	}
+
+	status = leavePowerDown();
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+
+	status = startAddressedCommand(kWarpIS25WP128CommandFastRead, address);
+	if ((status == kWarpStatusOK) && (numberOfBytes > 0))
+	{
+		status = transfer(NULL, buffer, numberOfBytes);
+	}
+	chipDeselect();
+	enterPowerDown();
+
+	return status;
+}
+
+/*
+ *	Program numberOfBytes (previously erased) from address, split at page
+ *	boundaries: a Page Program that crosses one wraps round to the start
+ *	of its page.
+ */
+WarpStatus
+programIS25WP128(uint32_t address, const uint8_t *  buffer, size_t numberOfBytes)
+{
+	WarpStatus	status;
+
+	if ((address >= kWarpIS25WP128CapacityBytes) || (numberOfBytes > kWarpIS25WP128CapacityBytes - address))
+	{
+		return kWarpStatusBadDeviceCommand;
+	}
+
+	status = leavePowerDown();
+	while ((status == kWarpStatusOK) && (numberOfBytes > 0))
+	{
+		size_t	chunkBytes = kWarpIS25WP128PageBytes - (address & (kWarpIS25WP128PageBytes - 1));
+
+		if (chunkBytes > numberOfBytes)
+		{
+			chunkBytes = numberOfBytes;
+		}
+
+		status = writeEnable();
+		if (status == kWarpStatusOK)
+		{
+			status = startAddressedCommand(kWarpIS25WP128CommandPageProgram, address);
+			if (status == kWarpStatusOK)
+			{
+				status = transfer(buffer, NULL, chunkBytes);
+			}
+			chipDeselect();
+		}
+		if (status == kWarpStatusOK)
+		{
+			status = waitWhileBusy(kWarpIS25WP128PageProgramMicroseconds, false);
+		}
+
+		address		+= chunkBytes;
+		buffer		+= chunkBytes;
+		numberOfBytes	-= chunkBytes;
+	}
+	enterPowerDown();
+
+	return status;
+}
+
+/*
+ *	Erase the 4 KB sector containing address.
+ */
+WarpStatus
+eraseSectorIS25WP128(uint32_t address)
+{
+	WarpStatus	status;
+
+	if (address >= kWarpIS25WP128CapacityBytes)
+	{
+		return kWarpStatusBadDeviceCommand;
+	}
+
+	status = leavePowerDown();
+	if (status == kWarpStatusOK)
+	{
+		status = erase(kWarpIS25WP128CommandSectorErase, address, kWarpIS25WP128SectorEraseMilliseconds);
+	}
+	enterPowerDown();
+
+	return status;
+}
+
+/*
+ *	Erase the 64 KB block containing address.
+ */
+WarpStatus
+eraseBlockIS25WP128(uint32_t address)
+{
+	WarpStatus	status;
+
+	if (address >= kWarpIS25WP128CapacityBytes)
+	{
+		return kWarpStatusBadDeviceCommand;
+	}
+
+	status = leavePowerDown();
+	if (status == kWarpStatusOK)
+	{
+		status = erase(kWarpIS25WP128CommandBlockErase, address, kWarpIS25WP128BlockEraseMilliseconds);
+	}
+	enterPowerDown();
+
+	return status;
+}
+
+/*
+ *	Erase every sector that overlaps the range, with 64 KB Block Erases
+ *	where a whole aligned block is covered (about a quarter of the time
+ *	of sixteen sector erases) and 4 KB Sector Erases elsewhere.
+ */
+WarpStatus
+eraseIS25WP128(uint32_t address, size_t numberOfBytes)
+{
+	uint32_t	end;
+	WarpStatus	status;
+
+	if ((address >= kWarpIS25WP128CapacityBytes) || (numberOfBytes > kWarpIS25WP128CapacityBytes - address))
+	{
+		return kWarpStatusBadDeviceCommand;
+	}
+
+	end	= address + numberOfBytes;
+	address	&= ~(uint32_t)(kWarpIS25WP128SectorBytes - 1);
+
+	status = leavePowerDown();
+	while ((status == kWarpStatusOK) && (address < end))
+	{
+		if (((address & (kWarpIS25WP128BlockBytes - 1)) == 0) && (end - address >= kWarpIS25WP128BlockBytes))
+		{
+			status = erase(kWarpIS25WP128CommandBlockErase, address, kWarpIS25WP128BlockEraseMilliseconds);
+			address += kWarpIS25WP128BlockBytes;
+		}
+		else
+		{
+			status = erase(kWarpIS25WP128CommandSectorErase, address, kWarpIS25WP128SectorEraseMilliseconds);
+			address += kWarpIS25WP128SectorBytes;
+		}
+	}
+	enterPowerDown();
+
+	return status;
+}
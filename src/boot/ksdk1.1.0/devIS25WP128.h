@@ -34,3 +34,59 @@
 	ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 	POSSIBILITY OF SUCH DAMAGE.
 */
+
+#ifndef WARP_BUILD_ENABLE_DEVIS25WP128
+#define WARP_BUILD_ENABLE_DEVIS25WP128
+#endif
+
+/*
+ *	ISSI IS25WP128, 128 Mbit (16 MB) SPI NOR flash, in its standard
+ *	single-bit SPI mode. Commands and timing are from the datasheet.
+ */
+typedef enum
+{
+	kWarpIS25WP128CommandPageProgram		= 0x02,
+	kWarpIS25WP128CommandReadStatus			= 0x05,
+	kWarpIS25WP128CommandWriteEnable		= 0x06,
+	kWarpIS25WP128CommandFastRead			= 0x0B,
+	kWarpIS25WP128CommandSectorErase		= 0x20,
+	kWarpIS25WP128CommandReadJedecId		= 0x9F,
+	kWarpIS25WP128CommandReleasePowerDown		= 0xAB,
+	kWarpIS25WP128CommandDeepPowerDown		= 0xB9,
+	kWarpIS25WP128CommandBlockErase			= 0xD8,
+} WarpIS25WP128Command;
+
+typedef enum
+{
+	kWarpIS25WP128StatusWIP				= 0x01,
+	kWarpIS25WP128StatusWEL				= 0x02,
+} WarpIS25WP128Status;
+
+typedef enum
+{
+	kWarpIS25WP128ManufacturerId			= 0x9D,
+	kWarpIS25WP128MemoryType			= 0x70,
+	kWarpIS25WP128CapacityId			= 0x18,
+
+	kWarpIS25WP128CapacityBytes			= 16 * 1024 * 1024,
+	kWarpIS25WP128PageBytes				= 256,
+	kWarpIS25WP128SectorBytes			= 4 * 1024,
+	kWarpIS25WP128BlockBytes			= 64 * 1024,
+
+	/*
+	 *	tRES1, and the maximum tPP, tSE and tBE.
+	 */
+	kWarpIS25WP128ReleaseMicroseconds		= 5,
+	kWarpIS25WP128PageProgramMicroseconds		= 800,
+	kWarpIS25WP128SectorEraseMilliseconds		= 300,
+	kWarpIS25WP128BlockEraseMilliseconds		= 1000,
+} WarpIS25WP128Constants;
+
+void		initIS25WP128(WarpSPIDeviceState volatile *  deviceStatePointer);
+WarpStatus	readJedecIdIS25WP128(uint8_t *  manufacturerId, uint16_t *  deviceId);
+WarpStatus	readStatusIS25WP128(uint8_t *  status);
+WarpStatus	readIS25WP128(uint32_t address, uint8_t *  buffer, size_t numberOfBytes);
+WarpStatus	programIS25WP128(uint32_t address, const uint8_t *  buffer, size_t numberOfBytes);
+WarpStatus	eraseSectorIS25WP128(uint32_t address);
+WarpStatus	eraseBlockIS25WP128(uint32_t address);
+WarpStatus	eraseIS25WP128(uint32_t address, size_t numberOfBytes);
@@ -49,6 +49,7 @@
 #include "gpio_pins.h"
 #include "SEGGER_RTT.h"
 #include "warp.h"
+#include "devL3GD20H.h"
 
 
 extern volatile WarpI2CDeviceState	deviceL3GD20HState;
@@ -56,6 +57,16 @@ extern volatile uint32_t		gWarpI2cBaudRateKbps;
 extern volatile uint32_t		gWarpI2cTimeoutMilliseconds;
 extern volatile uint32_t		gWarpSupplySettlingDelayMilliseconds;
 
+/*
+ *	Setting the MSB of the sub address makes multi-byte reads auto-increment.
+ */
+enum
+{
+	kWarpSensorL3GD20HSubAddressAutoIncrement	= 0x80,
+};
+
+static uint8_t				sampleRegisterValues[8];
+static WarpI2cTransaction		sampleTransaction;
 
 
 void
@@ -137,6 +148,156 @@ configureSensorL3GD20H(uint8_t payloadCTRL1, uint8_t payloadCTRL2, uint8_t paylo
 	return (status1 | status2 | status3);
 }
 
+/*
+ *	Route data-ready to the DRDY/INT2 pin (CTRL3 INT2_DRDY) as an
+ *	open-drain (CTRL3 PP_OD), active-low (LOW_ODR DRDY_HL) output, so that
+ *	it can share kWarpPinSensorDataReady with the other sensors. LOW_ODR
+ *	keeps Low_ODR clear, i.e., the rates configureSensorL3GD20H() selects.
+ */
+WarpStatus
+configureDataReadyL3GD20H(uint16_t menuI2cPullupValue)
+{
+	WarpStatus	status1, status2;
+
+	status1 = writeSensorRegisterL3GD20H(kWarpSensorConfigurationRegisterL3GD20HCTRL3 /* register address CTRL3 */,
+							0b00011000 /* payload: PP_OD open drain, INT2_DRDY */,
+							menuI2cPullupValue);
+
+	status2 = writeSensorRegisterL3GD20H(kWarpSensorConfigurationRegisterL3GD20HLOW_ODR /* register address LOW_ODR */,
+							0b00100000 /* payload: DRDY_HL active low */,
+							menuI2cPullupValue);
+
+	return (status1 | status2);
+}
+
+/*
+ *	Batch samples in the 32-level FIFO, in mode (see WarpL3GD20HFifoMode),
+ *	with its watermark (FIFO_CTRL FTH) routed to the DRDY/INT2 pin as for
+ *	configureDataReadyL3GD20H(), so the pin asserts once more than
+ *	watermark samples are stored. The FIFO passes through bypass mode,
+ *	which empties it, on the way. CTRL5 is rewritten with FIFO_EN set and
+ *	the high-pass filter off, as configureSensorL3GD20H()'s callers set it.
+ */
+WarpStatus
+configureFifoL3GD20H(WarpL3GD20HFifoMode mode, uint8_t watermark, uint16_t menuI2cPullupValue)
+{
+	WarpStatus	status1, status2, status3, status4, status5;
+
+	status1 = writeSensorRegisterL3GD20H(kWarpSensorConfigurationRegisterL3GD20HFIFO_CTRL /* register address FIFO_CTRL */,
+							kWarpL3GD20HFifoModeBypass /* payload: bypass, empties the FIFO */,
+							menuI2cPullupValue);
+
+	status2 = writeSensorRegisterL3GD20H(kWarpSensorConfigurationRegisterL3GD20HCTRL5 /* register address CTRL5 */,
+							0b01000000 /* payload: FIFO_EN, StopOnFTH clear, high pass filter off */,
+							menuI2cPullupValue);
+
+	status3 = writeSensorRegisterL3GD20H(kWarpSensorConfigurationRegisterL3GD20HFIFO_CTRL /* register address FIFO_CTRL */,
+							mode | (watermark & 0x1F) /* payload: FM, FTH */,
+							menuI2cPullupValue);
+
+	status4 = writeSensorRegisterL3GD20H(kWarpSensorConfigurationRegisterL3GD20HCTRL3 /* register address CTRL3 */,
+							0b00010100 /* payload: PP_OD open drain, INT2_FTH */,
+							menuI2cPullupValue);
+
+	status5 = writeSensorRegisterL3GD20H(kWarpSensorConfigurationRegisterL3GD20HLOW_ODR /* register address LOW_ODR */,
+							0b00100000 /* payload: DRDY_HL active low */,
+							menuI2cPullupValue);
+
+	return (status1 | status2 | status3 | status4 | status5);
+}
+
+/*
+ *	The number of samples in the FIFO, from FIFO_SRC. FSS only counts to
+ *	31, so a full FIFO is recognised by its overrun flag, which is also
+ *	returned: in stream mode, samples have been overwritten since the last
+ *	drain; in FIFO mode, samples have been dropped.
+ */
+WarpStatus
+fifoLevelL3GD20H(size_t *  sampleCount, bool *  overrun)
+{
+	uint8_t		fifoSource;
+	WarpStatus	status;
+
+	status = warpI2cReadBurst(deviceL3GD20HState.i2cAddress, kWarpSensorOutputRegisterL3GD20HFIFO_SRC, &fifoSource, 1);
+	if (status != kWarpStatusOK)
+	{
+		*sampleCount = 0;
+		*overrun = false;
+
+		return status;
+	}
+
+	*overrun = (fifoSource & 0x40 /* OVRN */) != 0;
+	if (fifoSource & 0x20 /* EMPTY */)
+	{
+		*sampleCount = 0;
+	}
+	else if (*overrun)
+	{
+		*sampleCount = kWarpSizesL3GD20HFifoSamples;
+	}
+	else
+	{
+		*sampleCount = fifoSource & 0x1F /* FSS */;
+	}
+
+	return kWarpStatusOK;
+}
+
+/*
+ *	Drain the FIFO into samples (X/Y/Z per sample, at most maxSamples of
+ *	them), oldest first, in one auto-incrementing burst read from OUT_X_L:
+ *	with the FIFO enabled the sub address wraps from OUT_Z_H back to
+ *	OUT_X_L, and each wrap pops a sample. Reading below the watermark
+ *	releases the pin.
+ */
+WarpStatus
+drainFifoL3GD20H(int16_t *  samples, size_t maxSamples, size_t *  sampleCount, bool *  overrun)
+{
+	uint8_t *	registerValues = (uint8_t *)samples;
+	size_t		count;
+	WarpStatus	status;
+
+	status = fifoLevelL3GD20H(&count, overrun);
+	*sampleCount = 0;
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+
+	if (count > maxSamples)
+	{
+		count = maxSamples;
+	}
+	if (count == 0)
+	{
+		return kWarpStatusOK;
+	}
+
+	status = warpI2cReadBurst(deviceL3GD20HState.i2cAddress,
+				kWarpSensorOutputRegisterL3GD20HOUT_X_L | kWarpSensorL3GD20HSubAddressAutoIncrement,
+				registerValues, count * 6);
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+
+	/*
+	 *	Little endian, as the core is, but unpack explicitly rather than
+	 *	rely on it.
+	 */
+	for (size_t i = 0; i < count * 3; i++)
+	{
+		uint16_t	readSensorRegisterValueLSB = registerValues[2*i];
+		uint16_t	readSensorRegisterValueMSB = registerValues[2*i + 1];
+
+		samples[i] = (int16_t)(((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF));
+	}
+	*sampleCount = count;
+
+	return kWarpStatusOK;
+}
+
 WarpStatus
 readSensorRegisterL3GD20H(uint8_t deviceRegister, int numberOfBytes)
 {
@@ -195,114 +356,122 @@ readSensorRegisterL3GD20H(uint8_t deviceRegister, int numberOfBytes)
 }
 
 
+/*
+ *	Queue a read of one X/Y/Z sample (and OUT_TEMP) on the asynchronous I2C
+ *	queue, for printSensorSampleL3GD20H() to wait for and print.
+ */
+WarpStatus
+queueSensorSampleL3GD20H(void)
+{
+	/*
+	 *	OUT_TEMP, STATUS and OUT_X_L through OUT_Z_H are contiguous, so we
+	 *	read all eight in one transaction. The L3GD20H only auto-increments
+	 *	the sub address when its MSB is set (Section 5.1.1 of the manual).
+	 */
+	sampleTransaction.i2cAddress		= deviceL3GD20HState.i2cAddress;
+	sampleTransaction.deviceRegister	= kWarpSensorOutputRegisterL3GD20HOUT_TEMP | kWarpSensorL3GD20HSubAddressAutoIncrement;
+	sampleTransaction.direction		= kWarpI2cDirectionRead;
+	sampleTransaction.buffer		= sampleRegisterValues;
+	sampleTransaction.numberOfBytes		= sizeof(sampleRegisterValues);
+	sampleTransaction.callback		= NULL;
+
+	return warpI2cSubmit(&sampleTransaction);
+}
+
 void
-printSensorDataL3GD20H(bool hexModeFlag)
+printSensorSampleL3GD20H(bool hexModeFlag)
 {
 	uint16_t	readSensorRegisterValueLSB;
 	uint16_t	readSensorRegisterValueMSB;
 	int16_t		readSensorRegisterValueCombined;
 	int8_t		readSensorRegisterSignedByte;
-	WarpStatus	i2cReadStatusLow, i2cReadStatusHigh;
-
+	WarpStatus	i2cReadStatus;
 
-	i2cReadStatusLow = readSensorRegisterL3GD20H(kWarpSensorOutputRegisterL3GD20HOUT_X_L, 1 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceL3GD20HState.i2cBuffer[0];
-	i2cReadStatusHigh = readSensorRegisterL3GD20H(kWarpSensorOutputRegisterL3GD20HOUT_X_H, 1 /* numberOfBytes */);
-	readSensorRegisterValueMSB = deviceL3GD20HState.i2cBuffer[0];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
 
-	/*
-	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
-	 */
+	i2cReadStatus = warpI2cWait(&sampleTransaction);
 
-	if ((i2cReadStatusLow != kWarpStatusOK) || (i2cReadStatusHigh != kWarpStatusOK))
+	for (int axis = 0; axis < 3; axis++)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
-	}
-
-	i2cReadStatusLow = readSensorRegisterL3GD20H(kWarpSensorOutputRegisterL3GD20HOUT_Y_L, 1 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceL3GD20HState.i2cBuffer[0];
-	i2cReadStatusHigh = readSensorRegisterL3GD20H(kWarpSensorOutputRegisterL3GD20HOUT_Y_H, 1 /* numberOfBytes */);
-	readSensorRegisterValueMSB = deviceL3GD20HState.i2cBuffer[0];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
+		readSensorRegisterValueLSB = sampleRegisterValues[kWarpSensorOutputRegisterL3GD20HOUT_X_L - kWarpSensorOutputRegisterL3GD20HOUT_TEMP + 2*axis];
+		readSensorRegisterValueMSB = sampleRegisterValues[kWarpSensorOutputRegisterL3GD20HOUT_X_H - kWarpSensorOutputRegisterL3GD20HOUT_TEMP + 2*axis];
+		readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
 
-	/*
-	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
-	 */
+		/*
+		 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
+		 */
 
-	if ((i2cReadStatusLow != kWarpStatusOK) || (i2cReadStatusHigh != kWarpStatusOK))
-	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
+		if (i2cReadStatus != kWarpStatusOK)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvMissing();
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			if (hexModeFlag)
+			{
+				warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
+			}
+			else
+			{
+				warpCsvInt(readSensorRegisterValueCombined);
+			}
 		}
 	}
 
-	i2cReadStatusLow = readSensorRegisterL3GD20H(kWarpSensorOutputRegisterL3GD20HOUT_Z_L, 1 /* numberOfBytes */);
-	readSensorRegisterValueLSB = deviceL3GD20HState.i2cBuffer[0];
-	i2cReadStatusHigh = readSensorRegisterL3GD20H(kWarpSensorOutputRegisterL3GD20HOUT_Z_H, 1 /* numberOfBytes */);
-	readSensorRegisterValueMSB = deviceL3GD20HState.i2cBuffer[0];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
+	readSensorRegisterSignedByte = sampleRegisterValues[0];
 
 	/*
-	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
+	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int8_t
 	 */
 
-	if ((i2cReadStatusLow != kWarpStatusOK) || (i2cReadStatusHigh != kWarpStatusOK))
+	if (i2cReadStatus != kWarpStatusOK)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvHex(sampleRegisterValues[0], 1);
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			warpCsvInt(readSensorRegisterSignedByte);
 		}
 	}
+}
 
-	i2cReadStatusLow = readSensorRegisterL3GD20H(kWarpSensorOutputRegisterL3GD20HOUT_TEMP, 1 /* numberOfBytes */);
-	readSensorRegisterSignedByte = deviceL3GD20HState.i2cBuffer[0];
-
-	/*
-	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int8_t
-	 */
+void
+printSensorDataL3GD20H(bool hexModeFlag)
+{
+	queueSensorSampleL3GD20H();
+	printSensorSampleL3GD20H(hexModeFlag);
+}
 
-	if (i2cReadStatusLow != kWarpStatusOK)
+/*
+ *	STATUS precedes OUT_X_L, so one auto-incrementing read from STATUS gets
+ *	the ZYXDA flag with the sample it describes. Reading the data clears
+ *	DRDY.
+ */
+static bool
+decodeDataReadySampleL3GD20H(const uint8_t *  registerValues, int16_t *  axes)
+{
+	if (!(registerValues[0] & 0x08 /* ZYXDA */))
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		return false;
 	}
-	else
+
+	for (int axis = 0; axis < 3; axis++)
 	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x,", deviceL3GD20HState.i2cBuffer[0]);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterSignedByte);
-		}
+		axes[axis] = (int16_t)(((registerValues[2 + 2*axis] & 0xFF) << 8) | (registerValues[1 + 2*axis] & 0xFF));
 	}
-}
\ No newline at end of file
+
+	return true;
+}
+
+const WarpDataReadySource	dataReadySourceL3GD20H =
+{
+	.deviceState	= &deviceL3GD20HState,
+	.deviceRegister	= kWarpSensorOutputRegisterL3GD20HSTATUS | kWarpSensorL3GD20HSubAddressAutoIncrement,
+	.numberOfBytes	= 7,
+	.decode		= decodeDataReadySampleL3GD20H,
+};
@@ -39,6 +39,20 @@
 #define WARP_BUILD_ENABLE_DEVL3GD20H
 #endif
 
+typedef enum
+{
+	/*
+	 *	FIFO_CTRL FM[2:0] values (Table 45 of the manual). In stream mode
+	 *	the oldest samples are overwritten once the 32 levels are full; in
+	 *	stream-to-FIFO mode the FIFO switches to FIFO mode, and so stops
+	 *	filling when full, once an interrupt event occurs.
+	 */
+	kWarpL3GD20HFifoModeBypass		= 0x00,
+	kWarpL3GD20HFifoModeFifo		= 0x20,
+	kWarpL3GD20HFifoModeStream		= 0x40,
+	kWarpL3GD20HFifoModeStreamToFifo	= 0x60,
+} WarpL3GD20HFifoMode;
+
 void		initL3GD20H(const uint8_t i2cAddress, WarpI2CDeviceState volatile *  deviceStatePointer);
 WarpStatus	readSensorRegisterL3GD20H(uint8_t deviceRegister, int numberOfBytes);
 WarpStatus	readSensorSignalL3GD20H(WarpTypeMask signal,
@@ -48,4 +62,12 @@ WarpStatus	readSensorSignalL3GD20H(WarpTypeMask signal,
 					WarpSignalNoise noise);
 WarpStatus	writeSensorRegisterL3GD20H(uint8_t deviceRegister, uint8_t payload, uint16_t menuI2cPullupValue);
 WarpStatus	configureSensorL3GD20H(uint8_t payloadCTRL1, uint8_t payloadCTRL2, uint8_t payloadCTRL5, uint16_t menuI2cPullupValue);
-void		printSensorDataL3GD20H(bool hexModeFlag);
\ No newline at end of file
+void		printSensorDataL3GD20H(bool hexModeFlag);
+WarpStatus	queueSensorSampleL3GD20H(void);
+void		printSensorSampleL3GD20H(bool hexModeFlag);
+WarpStatus	configureDataReadyL3GD20H(uint16_t menuI2cPullupValue);
+
+extern const WarpDataReadySource	dataReadySourceL3GD20H;
+WarpStatus	configureFifoL3GD20H(WarpL3GD20HFifoMode mode, uint8_t watermark, uint16_t menuI2cPullupValue);
+WarpStatus	fifoLevelL3GD20H(size_t *  sampleCount, bool *  overrun);
+WarpStatus	drainFifoL3GD20H(int16_t *  samples, size_t maxSamples, size_t *  sampleCount, bool *  overrun);
\ No newline at end of file
@@ -56,6 +56,11 @@ extern volatile uint32_t		gWarpI2cBaudRateKbps;
 extern volatile uint32_t		gWarpI2cTimeoutMilliseconds;
 extern volatile uint32_t		gWarpSupplySettlingDelayMilliseconds;
 
+static uint8_t				sampleRegisterValues[6];
+static uint8_t				sampleTemperature;
+static WarpI2cTransaction		sampleTransaction;
+static WarpI2cTransaction		temperatureTransaction;
+
 
 
 void
@@ -188,8 +193,43 @@ readSensorRegisterMAG3110(uint8_t deviceRegister, int numberOfBytes)
 	return kWarpStatusOK;
 }
 
+/*
+ *	Queue reads of one X/Y/Z sample and of DIE_TEMP on the asynchronous I2C
+ *	queue, for printSensorSampleMAG3110() to wait for and print.
+ */
+WarpStatus
+queueSensorSampleMAG3110(void)
+{
+	WarpStatus	status;
+
+
+	/*
+	 *	OUT_X_MSB through OUT_Z_LSB in one 6-byte transaction (the register
+	 *	address auto-increments while FR is clear), so that the three axes
+	 *	come from the same measurement.
+	 */
+	sampleTransaction.i2cAddress		= deviceMAG3110State.i2cAddress;
+	sampleTransaction.deviceRegister	= kWarpSensorOutputRegisterMAG3110OUT_X_MSB;
+	sampleTransaction.direction		= kWarpI2cDirectionRead;
+	sampleTransaction.buffer		= sampleRegisterValues;
+	sampleTransaction.numberOfBytes		= sizeof(sampleRegisterValues);
+	sampleTransaction.callback		= NULL;
+
+	temperatureTransaction.i2cAddress	= deviceMAG3110State.i2cAddress;
+	temperatureTransaction.deviceRegister	= kWarpSensorOutputRegisterMAG3110DIE_TEMP;
+	temperatureTransaction.direction	= kWarpI2cDirectionRead;
+	temperatureTransaction.buffer		= &sampleTemperature;
+	temperatureTransaction.numberOfBytes	= sizeof(sampleTemperature);
+	temperatureTransaction.callback		= NULL;
+
+	status = warpI2cSubmit(&sampleTransaction);
+	status |= warpI2cSubmit(&temperatureTransaction);
+
+	return status;
+}
+
 void
-printSensorDataMAG3110(bool hexModeFlag)
+printSensorSampleMAG3110(bool hexModeFlag)
 {
 	uint16_t	readSensorRegisterValueLSB;
 	uint16_t	readSensorRegisterValueMSB;
@@ -198,86 +238,38 @@ printSensorDataMAG3110(bool hexModeFlag)
 	WarpStatus	i2cReadStatus;
 
 
-	i2cReadStatus = readSensorRegisterMAG3110(kWarpSensorOutputRegisterMAG3110OUT_X_MSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueMSB = deviceMAG3110State.i2cBuffer[0];
-	readSensorRegisterValueLSB = deviceMAG3110State.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
+	i2cReadStatus = warpI2cWait(&sampleTransaction);
 
-	/*
-	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
-	 */
-
-	if (i2cReadStatus != kWarpStatusOK)
+	for (int axis = 0; axis < 3; axis++)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
-	}
+		readSensorRegisterValueMSB = sampleRegisterValues[2*axis];
+		readSensorRegisterValueLSB = sampleRegisterValues[2*axis + 1];
+		readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
 
+		/*
+		 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
+		 */
 
-	i2cReadStatus = readSensorRegisterMAG3110(kWarpSensorOutputRegisterMAG3110OUT_Y_MSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueMSB = deviceMAG3110State.i2cBuffer[0];
-	readSensorRegisterValueLSB = deviceMAG3110State.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
-
-	/*
-	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
-	 */
-
-	if (i2cReadStatus != kWarpStatusOK)
-	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
+		if (i2cReadStatus != kWarpStatusOK)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvMissing();
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			if (hexModeFlag)
+			{
+				warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
+			}
+			else
+			{
+				warpCsvInt(readSensorRegisterValueCombined);
+			}
 		}
 	}
 
 
-	i2cReadStatus = readSensorRegisterMAG3110(kWarpSensorOutputRegisterMAG3110OUT_Z_MSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueMSB = deviceMAG3110State.i2cBuffer[0];
-	readSensorRegisterValueLSB = deviceMAG3110State.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);
-
-	/*
-	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int16_t
-	 */
-
-	if (i2cReadStatus != kWarpStatusOK)
-	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
-	}
-
-
-	i2cReadStatus = readSensorRegisterMAG3110(kWarpSensorOutputRegisterMAG3110DIE_TEMP, 1 /* numberOfBytes */);
-	readSensorRegisterSignedByte = deviceMAG3110State.i2cBuffer[0];
+	i2cReadStatus = warpI2cWait(&temperatureTransaction);
+	readSensorRegisterSignedByte = sampleTemperature;
 
 	/*
 	 *	NOTE: Here, we don't need to manually sign extend since we are packing directly into an int8_t
@@ -285,17 +277,24 @@ printSensorDataMAG3110(bool hexModeFlag)
 
 	if (i2cReadStatus != kWarpStatusOK)
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		warpCsvMissing();
 	}
 	else
 	{
 		if (hexModeFlag)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x,", deviceMAG3110State.i2cBuffer[0]);
+			warpCsvHex(sampleTemperature, 1);
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterSignedByte);
+			warpCsvInt(readSensorRegisterSignedByte);
 		}
 	}
-}
\ No newline at end of file
+}
+
+void
+printSensorDataMAG3110(bool hexModeFlag)
+{
+	queueSensorSampleMAG3110();
+	printSensorSampleMAG3110(hexModeFlag);
+}
@@ -49,3 +49,5 @@ WarpStatus	readSensorSignalMAG3110(WarpTypeMask signal,
 					WarpSignalReliability reliability,
 					WarpSignalNoise noise);
 void		printSensorDataMAG3110(bool hexModeFlag);
+WarpStatus	queueSensorSampleMAG3110(void);
+void		printSensorSampleMAG3110(bool hexModeFlag);
@@ -56,6 +56,9 @@ extern volatile uint32_t		gWarpI2cBaudRateKbps;
 extern volatile uint32_t		gWarpI2cTimeoutMilliseconds;
 extern volatile uint32_t		gWarpSupplySettlingDelayMilliseconds;
 
+static uint8_t				sampleRegisterValues[6];
+static WarpI2cTransaction		sampleTransaction;
+
 
 
 void
@@ -137,6 +140,138 @@ configureSensorMMA8451Q(uint8_t payloadF_SETUP, uint8_t payloadCTRL_REG1, uint16
 	return (i2cWriteStatus1 | i2cWriteStatus2);
 }
 
+/*
+ *	Route the data-ready interrupt to INT1, as an open-drain, active-low
+ *	output so that it can share kWarpPinSensorDataReady with the other
+ *	sensors (CTRL_REG3 PP_OD set, IPOL clear). CTRL_REG3 to CTRL_REG5 may
+ *	only be written in standby, so we leave active mode for the writes and
+ *	then restore payloadCTRL_REG1.
+ */
+WarpStatus
+configureDataReadyMMA8451Q(uint8_t payloadCTRL_REG1, uint16_t menuI2cPullupValue)
+{
+	WarpStatus	status1, status2, status3, status4, status5;
+
+	status1 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QCTRL_REG1 /* register address CTRL_REG1 */,
+							payloadCTRL_REG1 & ~0x01 /* payload: standby */,
+							menuI2cPullupValue);
+
+	status2 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QCTRL_REG3 /* register address CTRL_REG3 */,
+							0x01 /* payload: PP_OD open drain, IPOL active low */,
+							menuI2cPullupValue);
+
+	status3 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QCTRL_REG4 /* register address CTRL_REG4 */,
+							0x01 /* payload: INT_EN_DRDY */,
+							menuI2cPullupValue);
+
+	status4 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QCTRL_REG5 /* register address CTRL_REG5 */,
+							0x01 /* payload: INT_CFG_DRDY, to INT1 */,
+							menuI2cPullupValue);
+
+	status5 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QCTRL_REG1 /* register address CTRL_REG1 */,
+							payloadCTRL_REG1 /* payload */,
+							menuI2cPullupValue);
+
+	return (status1 | status2 | status3 | status4 | status5);
+}
+
+/*
+ *	FIFO streaming: F_SETUP selects circular mode with the given watermark
+ *	(1 to 31 samples), and the watermark interrupt goes to INT1, open
+ *	drain and active low like the data-ready interrupt above. The FIFO then
+ *	holds up to 32 X/Y/Z samples between drains. As for
+ *	configureDataReadyMMA8451Q(), the writes are made in standby.
+ */
+WarpStatus
+configureFifoMMA8451Q(uint8_t watermark, uint8_t payloadCTRL_REG1, uint16_t menuI2cPullupValue)
+{
+	WarpStatus	status1, status2, status3, status4, status5, status6;
+
+	status1 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QCTRL_REG1 /* register address CTRL_REG1 */,
+							payloadCTRL_REG1 & ~0x01 /* payload: standby */,
+							menuI2cPullupValue);
+
+	status2 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QF_SETUP /* register address F_SETUP */,
+							0x40 | (watermark & 0x3F) /* payload: F_MODE circular, F_WMRK */,
+							menuI2cPullupValue);
+
+	status3 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QCTRL_REG3 /* register address CTRL_REG3 */,
+							0x01 /* payload: PP_OD open drain, IPOL active low */,
+							menuI2cPullupValue);
+
+	status4 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QCTRL_REG4 /* register address CTRL_REG4 */,
+							0x40 /* payload: INT_EN_FIFO */,
+							menuI2cPullupValue);
+
+	status5 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QCTRL_REG5 /* register address CTRL_REG5 */,
+							0x40 /* payload: INT_CFG_FIFO, to INT1 */,
+							menuI2cPullupValue);
+
+	status6 = writeSensorRegisterMMA8451Q(kWarpSensorConfigurationRegisterMMA8451QCTRL_REG1 /* register address CTRL_REG1 */,
+							payloadCTRL_REG1 /* payload */,
+							menuI2cPullupValue);
+
+	return (status1 | status2 | status3 | status4 | status5 | status6);
+}
+
+/*
+ *	Drain the FIFO into samples (three raw 14-bit values, X/Y/Z, per
+ *	sample, at most maxSamples of them), oldest first. F_STATUS gives the
+ *	count; the samples then come out in a single burst read, as with
+ *	the FIFO enabled the register address wraps from OUT_Z_LSB back to
+ *	OUT_X_MSB. *overflowed is set if the FIFO filled up and the oldest
+ *	samples were overwritten since the last drain. Reading below the
+ *	watermark clears the watermark interrupt.
+ */
+WarpStatus
+drainFifoMMA8451Q(int16_t *  samples, size_t maxSamples, size_t *  sampleCount, bool *  overflowed)
+{
+	uint8_t *	registerValues = (uint8_t *)samples;
+	uint8_t		fifoStatus;
+	size_t		count;
+	WarpStatus	status;
+
+	*sampleCount = 0;
+	*overflowed = false;
+
+	status = warpI2cReadBurst(deviceMMA8451QState.i2cAddress, kWarpSensorOutputRegisterMMA8451QSTATUS, &fifoStatus, 1);
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+
+	*overflowed = (fifoStatus & 0x80 /* F_OVF */) != 0;
+	count = fifoStatus & 0x3F /* F_CNT */;
+	if (count > maxSamples)
+	{
+		count = maxSamples;
+	}
+	if (count == 0)
+	{
+		return kWarpStatusOK;
+	}
+
+	status = warpI2cReadBurst(deviceMMA8451QState.i2cAddress, kWarpSensorOutputRegisterMMA8451QOUT_X_MSB, registerValues, count * 6);
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+
+	/*
+	 *	Each sample's six bytes become its three values in place.
+	 */
+	for (size_t i = 0; i < count * 3; i++)
+	{
+		uint16_t	readSensorRegisterValueMSB = registerValues[2*i];
+		uint16_t	readSensorRegisterValueLSB = registerValues[2*i + 1];
+
+		samples[i] = warpFixedPointSignExtend(((readSensorRegisterValueMSB & 0xFF) << 6) | (readSensorRegisterValueLSB >> 2), 14);
+	}
+	*sampleCount = count;
+
+	return kWarpStatusOK;
+}
+
 WarpStatus
 readSensorRegisterMMA8451Q(uint8_t deviceRegister, int numberOfBytes)
 {
@@ -196,15 +331,13 @@ readSensorRegisterMMA8451Q(uint8_t deviceRegister, int numberOfBytes)
 	return kWarpStatusOK;
 }
 
-void
-printSensorDataMMA8451Q(bool hexModeFlag)
+/*
+ *	Queue a read of one X/Y/Z sample on the asynchronous I2C queue, for
+ *	printSensorSampleMMA8451Q() to wait for and print.
+ */
+WarpStatus
+queueSensorSampleMMA8451Q(void)
 {
-	uint16_t	readSensorRegisterValueLSB;
-	uint16_t	readSensorRegisterValueMSB;
-	int16_t		readSensorRegisterValueCombined;
-	WarpStatus	i2cReadStatus;
-
-
 	/*
 	 *	From the MMA8451Q datasheet:
 	 *
@@ -214,89 +347,90 @@ printSensorDataMMA8451Q(bool hexModeFlag)
 	 *		sample, even if a new data sample arrives between reading the
 	 *		MSB and the LSB byte."
 	 *
-	 *	We therefore do 2-byte read transactions, for each of the registers.
-	 *	We could also improve things by doing a 6-byte read transaction.
+	 *	We therefore read OUT_X_MSB through OUT_Z_LSB in one 6-byte
+	 *	transaction (the register address auto-increments while F_READ is
+	 *	clear), which also keeps the three axes from the same sample.
 	 */
-	i2cReadStatus = readSensorRegisterMMA8451Q(kWarpSensorOutputRegisterMMA8451QOUT_X_MSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueMSB = deviceMMA8451QState.i2cBuffer[0];
-	readSensorRegisterValueLSB = deviceMMA8451QState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 6) | (readSensorRegisterValueLSB >> 2);
-
-	/*
-	 *	Sign extend the 14-bit value based on knowledge that upper 2 bit are 0:
-	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 13)) - (1 << 13);
-
+	sampleTransaction.i2cAddress		= deviceMMA8451QState.i2cAddress;
+	sampleTransaction.deviceRegister	= kWarpSensorOutputRegisterMMA8451QOUT_X_MSB;
+	sampleTransaction.direction		= kWarpI2cDirectionRead;
+	sampleTransaction.buffer		= sampleRegisterValues;
+	sampleTransaction.numberOfBytes		= sizeof(sampleRegisterValues);
+	sampleTransaction.callback		= NULL;
+
+	return warpI2cSubmit(&sampleTransaction);
+}
 
-	if (i2cReadStatus != kWarpStatusOK)
-	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
-	}
+void
+printSensorSampleMMA8451Q(bool hexModeFlag)
+{
+	uint16_t	readSensorRegisterValueLSB;
+	uint16_t	readSensorRegisterValueMSB;
+	int16_t		readSensorRegisterValueCombined;
+	WarpStatus	i2cReadStatus;
 
 
-	i2cReadStatus = readSensorRegisterMMA8451Q(kWarpSensorOutputRegisterMMA8451QOUT_Y_MSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueMSB = deviceMMA8451QState.i2cBuffer[0];
-	readSensorRegisterValueLSB = deviceMMA8451QState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 6) | (readSensorRegisterValueLSB >> 2);
+	i2cReadStatus = warpI2cWait(&sampleTransaction);
 
-	/*
-	 *	Sign extend the 14-bit value based on knowledge that upper 2 bit are 0:
-	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 13)) - (1 << 13);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		readSensorRegisterValueMSB = sampleRegisterValues[2*axis];
+		readSensorRegisterValueLSB = sampleRegisterValues[2*axis + 1];
+		readSensorRegisterValueCombined = warpFixedPointSignExtend(((readSensorRegisterValueMSB & 0xFF) << 6) | (readSensorRegisterValueLSB >> 2), 14);
 
 
-	if (i2cReadStatus != kWarpStatusOK)
-	{
-		SEGGER_RTT_WriteString(0, " ----,");
-	}
-	else
-	{
-		if (hexModeFlag)
+		if (i2cReadStatus != kWarpStatusOK)
 		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
+			warpCsvMissing();
 		}
 		else
 		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
+			if (hexModeFlag)
+			{
+				warpCsvHex((readSensorRegisterValueMSB << 8) | readSensorRegisterValueLSB, 2);
+			}
+			else
+			{
+				warpCsvInt(warpFixedPointConvert(readSensorRegisterValueCombined, kWarpFixedPointScaleMMA8451QMilliG));
+			}
 		}
 	}
+}
 
+void
+printSensorDataMMA8451Q(bool hexModeFlag)
+{
+	queueSensorSampleMMA8451Q();
+	printSensorSampleMMA8451Q(hexModeFlag);
+}
 
-	i2cReadStatus = readSensorRegisterMMA8451Q(kWarpSensorOutputRegisterMMA8451QOUT_Z_MSB, 2 /* numberOfBytes */);
-	readSensorRegisterValueMSB = deviceMMA8451QState.i2cBuffer[0];
-	readSensorRegisterValueLSB = deviceMMA8451QState.i2cBuffer[1];
-	readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 6) | (readSensorRegisterValueLSB >> 2);
-
-	/*
-	 *	Sign extend the 14-bit value based on knowledge that upper 2 bit are 0:
-	 */
-	readSensorRegisterValueCombined = (readSensorRegisterValueCombined ^ (1 << 13)) - (1 << 13);
-
-
-	if (i2cReadStatus != kWarpStatusOK)
+/*
+ *	STATUS precedes OUT_X_MSB, so one read from STATUS gets the ZYXDR flag
+ *	with the sample it describes. Reading the data clears the interrupt.
+ */
+static bool
+decodeDataReadySampleMMA8451Q(const uint8_t *  registerValues, int16_t *  axes)
+{
+	if (!(registerValues[0] & 0x08 /* ZYXDR */))
 	{
-		SEGGER_RTT_WriteString(0, " ----,");
+		return false;
 	}
-	else
+
+	for (int axis = 0; axis < 3; axis++)
 	{
-		if (hexModeFlag)
-		{
-			SEGGER_RTT_printf(0, " 0x%02x 0x%02x,", readSensorRegisterValueMSB, readSensorRegisterValueLSB);
-		}
-		else
-		{
-			SEGGER_RTT_printf(0, " %d,", readSensorRegisterValueCombined);
-		}
+		uint16_t	readSensorRegisterValueMSB = registerValues[1 + 2*axis];
+		uint16_t	readSensorRegisterValueLSB = registerValues[2 + 2*axis];
+
+		axes[axis] = warpFixedPointSignExtend(((readSensorRegisterValueMSB & 0xFF) << 6) | (readSensorRegisterValueLSB >> 2), 14);
 	}
-}
\ No newline at end of file
+
+	return true;
+}
+
+const WarpDataReadySource	dataReadySourceMMA8451Q =
+{
+	.deviceState	= &deviceMMA8451QState,
+	.deviceRegister	= kWarpSensorOutputRegisterMMA8451QSTATUS,
+	.numberOfBytes	= 7,
+	.decode		= decodeDataReadySampleMMA8451Q,
+};
@@ -50,4 +50,11 @@ WarpStatus	readSensorSignalMMA8451Q(WarpTypeMask signal,
 					WarpSignalAccuracy accuracy,
 					WarpSignalReliability reliability,
 					WarpSignalNoise noise);
-void		printSensorDataMMA8451Q(bool hexModeFlag);
\ No newline at end of file
+void		printSensorDataMMA8451Q(bool hexModeFlag);
+WarpStatus	queueSensorSampleMMA8451Q(void);
+void		printSensorSampleMMA8451Q(bool hexModeFlag);
+WarpStatus	configureDataReadyMMA8451Q(uint8_t payloadCTRL_REG1, uint16_t menuI2cPullupValue);
+WarpStatus	configureFifoMMA8451Q(uint8_t watermark, uint8_t payloadCTRL_REG1, uint16_t menuI2cPullupValue);
+WarpStatus	drainFifoMMA8451Q(int16_t *  samples, size_t maxSamples, size_t *  sampleCount, bool *  overflowed);
+
+extern const WarpDataReadySource	dataReadySourceMMA8451Q;
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "fsl_spi_master_driver.h"
 #include "fsl_port_hal.h"
@@ -8,9 +9,6 @@
 #include "warp.h"
 #include "devSSD1331.h"
 
-volatile uint8_t	inBuffer[1];
-volatile uint8_t	payloadBytes[1];
-
 
 /*
  *	Override Warp firmware's use of these pins and define new aliases.
@@ -24,41 +22,633 @@ enum
 	kSSD1331PinRST		= GPIO_MAKE_PIN(HW_GPIOB, 0),
 };
 
-static int
-writeCommand(uint8_t commandByte)
+/*
+ *	Pending commands. Drawing routines append at commandRingHead from thread
+ *	context and return at once; the SPI interrupt retires bytes at
+ *	commandRingTail once they have been shifted out and chains the next
+ *	transfer, so the ring drains in the background with /CS held low. A
+ *	delay entry (see appendAcceleratedCommand()) pauses the drain: it is
+ *	timed with warpTimeSetAlarm() and the LPTMR interrupt resumes the drain.
+ *	Both indices run freely and are masked on use.
+ */
+static uint8_t			commandRing[kSSD1331CommandRingBytes];
+static volatile uint16_t	commandRingHead;
+static volatile uint16_t	commandRingTail;
+
+/*
+ *	One bit per ring byte: set for display RAM data (sent with DC high),
+ *	clear for commands (DC low). Each transfer covers a run of one kind.
+ */
+static uint8_t			commandRingDataFlags[kSSD1331CommandRingBytes / 8];
+
+/*
+ *	One bit per ring byte: set for a delay entry, whose byte is the number
+ *	of milliseconds to wait instead of something to send.
+ */
+static uint8_t			commandRingDelayFlags[kSSD1331CommandRingBytes / 8];
+
+/*
+ *	Set while the drain is paused at a delay entry.
+ */
+static volatile bool		commandDelayPending;
+
+/*
+ *	Bytes handed to SPI_DRV_MasterTransfer() and not yet retired. Non-zero
+ *	while a transfer is in flight and /CS is asserted.
+ */
+static volatile uint16_t	commandInFlightBytes;
+
+/*
+ *	When set, every command byte goes out in its own transfer with the
+ *	10 ms /CS re-arm delay of the original byte-at-a-time driver. Only
+ *	used by devSSD1331_benchmark() to measure the difference.
+ */
+static bool			commandRingUnbatched;
+
+/*
+ *	What is on the panel from the last chart drawn, so that redraws only send
+ *	commands for the regions that changed. barTop is the top row of each bar
+ *	(its bottom is always row 0x38) and barRedBlue its red and blue colour
+ *	components. clearScreen() clears valid: there is nothing of the chart
+ *	left to clear. Drawing over the chart (devSSD1331_text()) sets
+ *	overdrawn: every bar must be redrawn, but barTop still says which rows
+ *	to clear when a bar has shrunk.
+ */
+typedef enum
 {
-	spi_status_t status;
+	kSSD1331AxesNone,
+	kSSD1331AxesTime,
+	kSSD1331AxesCurrent,
+} SSD1331Axes;
+
+typedef struct
+{
+	bool		valid;
+	bool		overdrawn;
+	uint8_t		growthStep;
+	uint8_t		barTop[kSSD1331BarBins];
+	uint8_t		barRedBlue[kSSD1331BarBins];
+} SSD1331BarChart;
+
+static SSD1331Axes		axesOnScreen;
+static SSD1331BarChart		barChart;
+
+
+/*
+ *	Initialization sequence, borrowed from https://github.com/adafruit/Adafruit-SSD1331-OLED-Driver-Library-for-Arduino
+ */
+static const uint8_t		initSequence[] =
+{
+	kSSD1331CommandDISPLAYOFF,		/*	0xAE					*/
+	kSSD1331CommandSETREMAP,	0x72,	/*	0xA0, RGB Color				*/
+	kSSD1331CommandSTARTLINE,	0x00,	/*	0xA1					*/
+	kSSD1331CommandDISPLAYOFFSET,	0x00,	/*	0xA2					*/
+	kSSD1331CommandNORMALDISPLAY,		/*	0xA4					*/
+	kSSD1331CommandSETMULTIPLEX,	0x3F,	/*	0xA8, 1/64 duty				*/
+	kSSD1331CommandSETMASTER,	0x8E,	/*	0xAD					*/
+	kSSD1331CommandPOWERMODE,	0x0B,	/*	0xB0					*/
+	kSSD1331CommandPRECHARGE,	0x31,	/*	0xB1					*/
+	kSSD1331CommandCLOCKDIV,	0xF0,	/*	0xB3, 7:4 = Oscillator Frequency, 3:0 = CLK Div Ratio	*/
+	kSSD1331CommandPRECHARGEA,	0x64,	/*	0x8A					*/
+	kSSD1331CommandPRECHARGEB,	0x78,	/*	0x8B					*/
+	kSSD1331CommandPRECHARGEA,	0x64,	/*	0x8A					*/
+	kSSD1331CommandPRECHARGELEVEL,	0x3A,	/*	0xBB					*/
+	kSSD1331CommandVCOMH,		0x3E,	/*	0xBE					*/
+	kSSD1331CommandMASTERCURRENT,	0x06,	/*	0x87					*/
+	kSSD1331CommandCONTRASTA,	0x91,	/*	0x81					*/
+	kSSD1331CommandCONTRASTB,	0x50,	/*	0x82					*/
+	kSSD1331CommandCONTRASTC,	0x7D,	/*	0x83					*/
+	kSSD1331CommandDISPLAYON,		/*	Turn on oled panel			*/
 
 	/*
-	 *	Drive /CS low.
-	 *
-	 *	Make sure there is a high-to-low transition by first driving high, delay, then drive low.
+	 *	To use fill commands, you will have to issue a command to the display to enable them. See the manual.
 	 */
-	GPIO_DRV_SetPinOutput(kSSD1331PinCSn);
-	OSA_TimeDelay(10);
-	GPIO_DRV_ClearPinOutput(kSSD1331PinCSn);
+	kSSD1331CommandFILL,		0x01,
+};
+
+/*
+ *	Line tables are {column start, row start, column end, row end, red, green, blue},
+ *	red and blue max 0xFF, green max 0x3F. The frame (axes, tick marks and the
+ *	"0" label) is shared by the reaction-time and current graphs.
+ */
+static const uint8_t		axesFrameLines[][kSSD1331LineOperandBytes] =
+{
+	/*
+	 *	y axis
+	 */
+	{0x00, 0x00, 0x00, 0x39,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	x axis
+	 */
+	{0x00, 0x39, 0x5F, 0x39,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	Green tick marks under the x axis at bins 0, 5, 10 and 15
+	 */
+	{0x00, 0x3A, 0x00, 0x3A,	0x00, 0x3F, 0x00},
+	{0x1E, 0x3A, 0x1E, 0x3A,	0x00, 0x3F, 0x00},
+	{0x3C, 0x3A, 0x3C, 0x3A,	0x00, 0x3F, 0x00},
+	{0x5A, 0x3A, 0x5A, 0x3A,	0x00, 0x3F, 0x00},
+	/*
+	 *	draw 0
+	 */
+	{0x00, 0x3B, 0x00, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x02, 0x3B, 0x02, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x01, 0x3B, 0x01, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x01, 0x3F, 0x01, 0x3F,	0xFF, 0x3F, 0xFF},
+};
 
+/*
+ *	Reaction-time graph labels: 100, 200 and 300 ms.
+ */
+static const uint8_t		timeAxisLabelLines[][kSSD1331LineOperandBytes] =
+{
+	/*
+	 *	draw 100
+	 */
+	{0x1A, 0x3B, 0x1A, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x1C, 0x3B, 0x1C, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x1E, 0x3B, 0x1E, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x1D, 0x3B, 0x1D, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x1D, 0x3F, 0x1D, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x20, 0x3B, 0x20, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x22, 0x3B, 0x22, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x21, 0x3B, 0x21, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x21, 0x3F, 0x21, 0x3F,	0xFF, 0x3F, 0xFF},
 	/*
-	 *	Drive DC low (command).
+	 *	2
 	 */
-	GPIO_DRV_ClearPinOutput(kSSD1331PinDC);
+	{0x37, 0x3B, 0x39, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x37, 0x3D, 0x39, 0x3D,	0xFF, 0x3F, 0xFF},
+	{0x37, 0x3F, 0x39, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x39, 0x3C, 0x39, 0x3C,	0xFF, 0x3F, 0xFF},
+	{0x37, 0x3E, 0x37, 0x3E,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	0 (tens)
+	 */
+	{0x3B, 0x3B, 0x3B, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x3D, 0x3B, 0x3D, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x3C, 0x3B, 0x3C, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x3C, 0x3F, 0x3C, 0x3F,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	0 (ones)
+	 */
+	{0x3F, 0x3B, 0x3F, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x41, 0x3B, 0x41, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x40, 0x3B, 0x40, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x40, 0x3F, 0x40, 0x3F,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	3
+	 */
+	{0x55, 0x3B, 0x57, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x55, 0x3D, 0x57, 0x3D,	0xFF, 0x3F, 0xFF},
+	{0x55, 0x3F, 0x57, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x57, 0x3C, 0x57, 0x3C,	0xFF, 0x3F, 0xFF},
+	{0x57, 0x3E, 0x57, 0x3E,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	0 (tens)
+	 */
+	{0x59, 0x3B, 0x59, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x5B, 0x3B, 0x5B, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x5A, 0x3B, 0x5A, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x5A, 0x3F, 0x5A, 0x3F,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	0 (ones)
+	 */
+	{0x5D, 0x3B, 0x5D, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x5F, 0x3B, 0x5F, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x5E, 0x3B, 0x5E, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x5E, 0x3F, 0x5E, 0x3F,	0xFF, 0x3F, 0xFF},
+};
+
+/*
+ *	Current graph labels: 5, 10, 15 and "mA".
+ */
+static const uint8_t		currentAxisLabelLines[][kSSD1331LineOperandBytes] =
+{
+	/*
+	 *	draw 5
+	 */
+	{0x1D, 0x3B, 0x1D, 0x3D,	0xFF, 0x3F, 0xFF},
+	{0x1F, 0x3D, 0x1F, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x1D, 0x3B, 0x1F, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x1D, 0x3D, 0x1F, 0x3D,	0xFF, 0x3F, 0xFF},
+	{0x1D, 0x3F, 0x1F, 0x3F,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	draw 10
+	 */
+	{0x3A, 0x3B, 0x3A, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x3C, 0x3B, 0x3C, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x3E, 0x3B, 0x3E, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x3D, 0x3B, 0x3D, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x3D, 0x3F, 0x3F, 0x3F,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	draw 15
+	 */
+	{0x58, 0x3B, 0x58, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x5A, 0x3B, 0x5C, 0x3B,	0xFF, 0x3F, 0xFF},
+	{0x5A, 0x3D, 0x5C, 0x3D,	0xFF, 0x3F, 0xFF},
+	{0x5A, 0x3F, 0x5C, 0x3F,	0xFF, 0x3F, 0xFF},
+	{0x5A, 0x3C, 0x5A, 0x3C,	0xFF, 0x3F, 0xFF},
+	{0x5C, 0x3E, 0x5C, 0x3E,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	m
+	 */
+	{0x52, 0x03, 0x52, 0x07,	0xFF, 0x3F, 0xFF},
+	{0x52, 0x03, 0x56, 0x03,	0xFF, 0x3F, 0xFF},
+	{0x54, 0x03, 0x54, 0x05,	0xFF, 0x3F, 0xFF},
+	{0x56, 0x03, 0x56, 0x07,	0xFF, 0x3F, 0xFF},
+	/*
+	 *	A
+	 */
+	{0x59, 0x04, 0x59, 0x07,	0xFF, 0x3F, 0xFF},
+	{0x5B, 0x02, 0x59, 0x04,	0xFF, 0x3F, 0xFF},
+	{0x5B, 0x02, 0x5D, 0x04,	0xFF, 0x3F, 0xFF},
+	{0x59, 0x05, 0x5D, 0x05,	0xFF, 0x3F, 0xFF},
+	{0x5D, 0x04, 0x5D, 0x07,	0xFF, 0x3F, 0xFF},
+};
+
+/*
+ *	Countdown digits as filled rectangles {column start, row start, column end, row end}.
+ */
+static const uint8_t		countdownThreeRects[][kSSD1331WindowOperandBytes] =
+{
+	{0x20, 0x00, 0x3F, 0x02},
+	{0x3D, 0x00, 0x3F, 0x3F},
+	{0x20, 0x1F, 0x3F, 0x21},
+	{0x20, 0x3D, 0x3F, 0x3F},
+};
+
+static const uint8_t		countdownTwoRects[][kSSD1331WindowOperandBytes] =
+{
+	{0x20, 0x00, 0x3F, 0x02},
+	{0x3D, 0x00, 0x3F, 0x20},
+	{0x20, 0x1F, 0x3F, 0x21},
+	{0x20, 0x20, 0x22, 0x3F},
+	{0x20, 0x3D, 0x3F, 0x3F},
+};
+
+static const uint8_t		countdownOneRects[][kSSD1331WindowOperandBytes] =
+{
+	{0x3D, 0x00, 0x3F, 0x3F},
+};
+
+/*
+ *	5x7 font, one byte per column with the top row in bit 0, after the
+ *	classic glcdfont. Only the characters the firmware displays are
+ *	included; fontCharacters[i] is drawn by fontGlyphs[i] and anything
+ *	else is drawn as a space.
+ */
+static const char		fontCharacters[] = " -.0123456789:AVmsu";
+
+static const uint8_t		fontGlyphs[][kSSD1331FontWidth] =
+{
+	{0x00, 0x00, 0x00, 0x00, 0x00},	/*	' '	*/
+	{0x08, 0x08, 0x08, 0x08, 0x08},	/*	'-'	*/
+	{0x00, 0x60, 0x60, 0x00, 0x00},	/*	'.'	*/
+	{0x3E, 0x51, 0x49, 0x45, 0x3E},	/*	'0'	*/
+	{0x00, 0x42, 0x7F, 0x40, 0x00},	/*	'1'	*/
+	{0x42, 0x61, 0x51, 0x49, 0x46},	/*	'2'	*/
+	{0x21, 0x41, 0x45, 0x4B, 0x31},	/*	'3'	*/
+	{0x18, 0x14, 0x12, 0x7F, 0x10},	/*	'4'	*/
+	{0x27, 0x45, 0x45, 0x45, 0x39},	/*	'5'	*/
+	{0x3C, 0x4A, 0x49, 0x49, 0x30},	/*	'6'	*/
+	{0x01, 0x71, 0x09, 0x05, 0x03},	/*	'7'	*/
+	{0x36, 0x49, 0x49, 0x49, 0x36},	/*	'8'	*/
+	{0x06, 0x49, 0x49, 0x29, 0x1E},	/*	'9'	*/
+	{0x00, 0x36, 0x36, 0x00, 0x00},	/*	':'	*/
+	{0x7E, 0x11, 0x11, 0x11, 0x7E},	/*	'A'	*/
+	{0x1F, 0x20, 0x40, 0x20, 0x1F},	/*	'V'	*/
+	{0x7C, 0x04, 0x18, 0x04, 0x78},	/*	'm'	*/
+	{0x48, 0x54, 0x54, 0x54, 0x20},	/*	's'	*/
+	{0x3C, 0x40, 0x40, 0x20, 0x7C},	/*	'u'	*/
+};
+
+
+static bool
+isDataByte(uint16_t index)
+{
+	index &= (kSSD1331CommandRingBytes - 1);
+
+	return (commandRingDataFlags[index >> 3] >> (index & 7)) & 1;
+}
+
+static bool
+isDelayEntry(uint16_t index)
+{
+	index &= (kSSD1331CommandRingBytes - 1);
+
+	return (commandRingDelayFlags[index >> 3] >> (index & 7)) & 1;
+}
 
-	payloadBytes[0] = commandByte;
-	status = SPI_DRV_MasterTransferBlocking(0	/* master instance */,
+static void
+setRingFlag(uint8_t *  flags, uint16_t index, bool set)
+{
+	if (set)
+	{
+		flags[index >> 3] |= (1 << (index & 7));
+	}
+	else
+	{
+		flags[index >> 3] &= ~(1 << (index & 7));
+	}
+}
+
+/*
+ *	Hand the longest contiguous run of pending bytes of one kind (commands or
+ *	data), up to the next delay entry, to the SPI driver, with DC set to
+ *	match. Called from drainCommands().
+ */
+static spi_status_t
+startCommandTransfer(void)
+{
+	uint16_t	start = commandRingTail & (kSSD1331CommandRingBytes - 1);
+	uint16_t	pending = commandRingHead - commandRingTail;
+	uint16_t	contiguous = kSSD1331CommandRingBytes - start;
+	uint16_t	limit = (pending < contiguous) ? pending : contiguous;
+	bool		data = isDataByte(commandRingTail);
+	uint16_t	run = 1;
+
+	while ((run < limit) && (isDataByte(commandRingTail + run) == data) && !isDelayEntry(commandRingTail + run))
+	{
+		run++;
+	}
+	commandInFlightBytes = run;
+
+	/*
+	 *	Drive DC low (command) or high (data).
+	 */
+	if (data)
+	{
+		GPIO_DRV_SetPinOutput(kSSD1331PinDC);
+	}
+	else
+	{
+		GPIO_DRV_ClearPinOutput(kSSD1331PinDC);
+	}
+
+	return SPI_DRV_MasterTransfer(0	/* master instance */,
 					NULL		/* spi_master_user_config_t */,
-					(const uint8_t * restrict)&payloadBytes[0],
-					(uint8_t * restrict)&inBuffer[0],
-					1		/* transfer size */,
-					1000		/* timeout in microseconds (unlike I2C which is ms) */);
+					(const uint8_t * restrict)&commandRing[start],
+					NULL		/* receive buffer: nothing to read back */,
+					commandInFlightBytes	/* transfer size */);
+}
+
+static void	commandDelayElapsed(void);
+
+/*
+ *	Call with nothing in flight and no delay pending: start the next transfer,
+ *	or the delay at the tail, or deassert /CS once the ring is empty. Before
+ *	warpTimeInit() there are no alarms, so a delay is waited out in place.
+ */
+static spi_status_t
+drainCommands(void)
+{
+	while (commandRingHead != commandRingTail)
+	{
+		uint8_t		delayMilliseconds;
+
+		if (!isDelayEntry(commandRingTail))
+		{
+			return startCommandTransfer();
+		}
+
+		delayMilliseconds = commandRing[commandRingTail & (kSSD1331CommandRingBytes - 1)];
+		commandDelayPending = true;
+		commandRingTail++;
+		if (warpTimeSetAlarm(warpTimeNowTicks() + warpTimeMillisecondsToTicks(delayMilliseconds), commandDelayElapsed) == kWarpStatusOK)
+		{
+			return kStatus_SPI_Success;
+		}
+
+		commandDelayPending = false;
+		OSA_TimeDelay(delayMilliseconds);
+	}
 
 	/*
 	 *	Drive /CS high
 	 */
 	GPIO_DRV_SetPinOutput(kSSD1331PinCSn);
 
+	return kStatus_SPI_Success;
+}
+
+/*
+ *	From LPTMR0_IRQHandler(), at the end of a delay entry.
+ */
+static void
+commandDelayElapsed(void)
+{
+	commandDelayPending = false;
+	drainCommands();
+}
+
+/*
+ *	From the KSDK's fsl_spi_shared_function.h, which is not on the include path.
+ */
+void	SPI_DRV_IRQHandler(uint32_t instance);
+
+/*
+ *	Replaces the KSDK's fsl_spi_irq.c (no longer linked) so that completion of
+ *	a display transfer can start the next one from the ring. Other SPI users
+ *	must call devSSD1331fenceCommands() before issuing their own transfers.
+ */
+void
+SPI0_IRQHandler(void)
+{
+	SPI_DRV_IRQHandler(HW_SPI0);
+
+	if ((commandInFlightBytes != 0) && (SPI_DRV_MasterGetTransferStatus(0, NULL) == kStatus_SPI_Success))
+	{
+		commandRingTail += commandInFlightBytes;
+		commandInFlightBytes = 0;
+		drainCommands();
+	}
+}
+
+/*
+ *	Start draining the ring if it is not already draining. Returns at once.
+ */
+int
+devSSD1331flushCommands(void)
+{
+	spi_status_t	status;
+
+	if ((commandInFlightBytes != 0) || commandDelayPending || (commandRingHead == commandRingTail))
+	{
+		return kStatus_SPI_Success;
+	}
+
+	/*
+	 *	Drive /CS low.
+	 *
+	 *	Make sure there is a high-to-low transition by first driving high, then drive low.
+	 */
+	GPIO_DRV_SetPinOutput(kSSD1331PinCSn);
+	if (commandRingUnbatched)
+	{
+		OSA_TimeDelay(10);
+	}
+	GPIO_DRV_ClearPinOutput(kSSD1331PinCSn);
+
+	status = drainCommands();
+	if (status != kStatus_SPI_Success)
+	{
+		/*
+		 *	Drop what was queued rather than wait forever on a transfer that never started.
+		 */
+		commandInFlightBytes = 0;
+		commandRingTail = commandRingHead;
+		GPIO_DRV_SetPinOutput(kSSD1331PinCSn);
+	}
+
 	return status;
 }
 
+/*
+ *	True while a transfer is being shifted out by the SPI interrupt. The
+ *	transfer needs the bus clock, so callers must not enter VLPS.
+ */
+bool
+devSSD1331busy(void)
+{
+	return commandInFlightBytes != 0;
+}
+
+/*
+ *	Flush and wait until every queued command has been shifted out and every
+ *	queued delay has passed.
+ */
+void
+devSSD1331fenceCommands(void)
+{
+	devSSD1331flushCommands();
+	while ((commandInFlightBytes != 0) || commandDelayPending)
+	{
+	}
+}
+
+static void
+appendEntry(uint8_t byte, bool data, bool delay)
+{
+	uint16_t	index;
+
+	/*
+	 *	If the ring is full, wait for the interrupt handler to make
+	 *	room, starting the drain if it is idle.
+	 */
+	while ((uint16_t)(commandRingHead - commandRingTail) == kSSD1331CommandRingBytes)
+	{
+		devSSD1331flushCommands();
+	}
+
+	index = commandRingHead & (kSSD1331CommandRingBytes - 1);
+	commandRing[index] = byte;
+	setRingFlag(commandRingDataFlags, index, data);
+	setRingFlag(commandRingDelayFlags, index, delay);
+	commandRingHead++;
+
+	if (commandRingUnbatched)
+	{
+		devSSD1331fenceCommands();
+	}
+}
+
+static void
+appendBytes(const uint8_t *  bytes, int count, bool data)
+{
+	for (int i = 0; i < count; i++)
+	{
+		appendEntry(bytes[i], data, false);
+	}
+}
+
+void
+devSSD1331appendCommands(const uint8_t *  commandBytes, int count)
+{
+	appendBytes(commandBytes, count, false);
+}
+
+/*
+ *	The graphic acceleration commands (DRAWLINE, DRAWRECT, CLEAR) keep the
+ *	controller busy after their last byte: up to kSSD1331DelaysHWLINE ms for
+ *	a line and kSSD1331DelaysHWFILL ms for a filled rectangle or a clear,
+ *	and a command arriving meanwhile can be lost. So each one is followed
+ *	in the ring by a delay entry, and the drain waits there before sending
+ *	anything else. The caller does not wait. Plain register writes and
+ *	display RAM data have no such wait.
+ */
+static void
+appendAcceleratedCommand(const uint8_t *  commandBytes, int count, uint8_t delayMilliseconds)
+{
+	devSSD1331appendCommands(commandBytes, count);
+	appendEntry(delayMilliseconds, false, true);
+}
+
+/*
+ *	Hardware-accelerated clear of a window.
+ */
+static void
+clearWindow(uint8_t columnStart, uint8_t rowStart, uint8_t columnEnd, uint8_t rowEnd)
+{
+	uint8_t	command[] = {kSSD1331CommandCLEAR, columnStart, rowStart, columnEnd, rowEnd};
+
+	appendAcceleratedCommand(command, sizeof(command), kSSD1331DelaysHWFILL);
+}
+
+/*
+ *	Nothing retained from earlier drawing is on the panel afterwards.
+ */
+static void
+clearScreen(void)
+{
+	clearWindow(0x00, 0x00, 0x5F, 0x3F);
+
+	axesOnScreen = kSSD1331AxesNone;
+	barChart.valid = false;
+}
+
+/*
+ *	Rectangle with the same outline and fill colour.
+ */
+static void
+drawFilledRect(uint8_t columnStart, uint8_t rowStart, uint8_t columnEnd, uint8_t rowEnd,
+		uint8_t red, uint8_t green, uint8_t blue)
+{
+	uint8_t	command[1 + kSSD1331RectOperandBytes] =
+	{
+		kSSD1331CommandDRAWRECT,
+		columnStart, rowStart, columnEnd, rowEnd,
+		red, green, blue,	/*	outline	*/
+		red, green, blue,	/*	fill	*/
+	};
+
+	appendAcceleratedCommand(command, sizeof(command), kSSD1331DelaysHWFILL);
+}
+
+static void
+drawLines(const uint8_t lines[][kSSD1331LineOperandBytes], int count)
+{
+	uint8_t	command[1 + kSSD1331LineOperandBytes];
+
+	command[0] = kSSD1331CommandDRAWLINE;
+	for (int i = 0; i < count; i++)
+	{
+		for (int j = 0; j < kSSD1331LineOperandBytes; j++)
+		{
+			command[1 + j] = lines[i][j];
+		}
+		appendAcceleratedCommand(command, sizeof(command), kSSD1331DelaysHWLINE);
+	}
+}
+
+static void
+drawWhiteRects(const uint8_t rects[][kSSD1331WindowOperandBytes], int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		drawFilledRect(rects[i][0], rects[i][1], rects[i][2], rects[i][3], 0xFF, 0x3F, 0xFF);
+	}
+}
 
 
 int
@@ -94,134 +684,57 @@ devSSD1331init(void)
 	GPIO_DRV_SetPinOutput(kSSD1331PinRST);
 	OSA_TimeDelay(100);
 
-	/*
-	 *	Initialization sequence, borrowed from https://github.com/adafruit/Adafruit-SSD1331-OLED-Driver-Library-for-Arduino
-	 */
-	writeCommand(kSSD1331CommandDISPLAYOFF);	// 0xAE
-	writeCommand(kSSD1331CommandSETREMAP);		// 0xA0
-	writeCommand(0x72);				// RGB Color
-	writeCommand(kSSD1331CommandSTARTLINE);		// 0xA1
-	writeCommand(0x0);
-	writeCommand(kSSD1331CommandDISPLAYOFFSET);	// 0xA2
-	writeCommand(0x0);
-	writeCommand(kSSD1331CommandNORMALDISPLAY);	// 0xA4
-	writeCommand(kSSD1331CommandSETMULTIPLEX);	// 0xA8
-	writeCommand(0x3F);				// 0x3F 1/64 duty
-	writeCommand(kSSD1331CommandSETMASTER);		// 0xAD
-	writeCommand(0x8E);
-	writeCommand(kSSD1331CommandPOWERMODE);		// 0xB0
-	writeCommand(0x0B);
-	writeCommand(kSSD1331CommandPRECHARGE);		// 0xB1
-	writeCommand(0x31);
-	writeCommand(kSSD1331CommandCLOCKDIV);		// 0xB3
-	writeCommand(0xF0);				// 7:4 = Oscillator Frequency, 3:0 = CLK Div Ratio (A[3:0]+1 = 1..16)
-	writeCommand(kSSD1331CommandPRECHARGEA);	// 0x8A
-	writeCommand(0x64);
-	writeCommand(kSSD1331CommandPRECHARGEB);	// 0x8B
-	writeCommand(0x78);
-	writeCommand(kSSD1331CommandPRECHARGEA);	// 0x8C
-	writeCommand(0x64);
-	writeCommand(kSSD1331CommandPRECHARGELEVEL);	// 0xBB
-	writeCommand(0x3A);
-	writeCommand(kSSD1331CommandVCOMH);		// 0xBE
-	writeCommand(0x3E);
-	writeCommand(kSSD1331CommandMASTERCURRENT);	// 0x87
-	writeCommand(0x06);
-	writeCommand(kSSD1331CommandCONTRASTA);		// 0x81
-	writeCommand(0x91);
-	writeCommand(kSSD1331CommandCONTRASTB);		// 0x82
-	writeCommand(0x50);
-	writeCommand(kSSD1331CommandCONTRASTC);		// 0x83
-	writeCommand(0x7D);
-	writeCommand(kSSD1331CommandDISPLAYON);		// Turn on oled panel
+	devSSD1331appendCommands(initSequence, sizeof(initSequence));
+	clearScreen();
 
 	/*
-	 *	To use fill commands, you will have to issue a command to the display to enable them. See the manual.
+	 *	The screen is filled with red to tell the user that the initialisation sequence has been completed.
 	 */
-	writeCommand(kSSD1331CommandFILL);
-	writeCommand(0x01);
-
-	/*
-	 *	Clear Screen
-	 */
-	writeCommand(kSSD1331CommandCLEAR);
-	writeCommand(0x00);
-	writeCommand(0x00);
-	writeCommand(0x5F);
-	writeCommand(0x3F);
-	
-	//The screen is filled with RED to tell the user that the initilisation sequence has been completed
-
-	writeCommand(0x22);	//draw rectangle command
-	writeCommand(0x00);	//column address start
-	writeCommand(0x00);	//row address start
-	writeCommand(0x5F);	//column address end
-	writeCommand(0x3F);	//row address end	
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x00);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0x00);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x00);	//colour B of fill
-	writeCommand(0x00);	//colour A of fill
+	drawFilledRect(0x00, 0x00, 0x5F, 0x3F, 0xFF, 0x00, 0x00);
+	devSSD1331flushCommands();
 	OSA_TimeDelay(1000);
 
+	clearScreen();
+	devSSD1331flushCommands();
 
-	//Clear Screen Again
+	return 0;
+}
 
-	writeCommand(kSSD1331CommandCLEAR);
-        writeCommand(0x00);
-        writeCommand(0x00);
-        writeCommand(0x5F);
-        writeCommand(0x3F);
+//function to turn the screen white and start timing the reaction to it, leaving the caller to clear it again; returns the reaction timer's status
+WarpStatus
+devSSD1331_flash_start(void)
+{
+	clearScreen();
 
-	return 0;
+	//draw rectangle that is white and fills the screen
+	drawFilledRect(0x00, 0x00, 0x5F, 0x3F, 0xFF, 0x3F, 0xFF);
+	devSSD1331fenceCommands();
+
+	//reaction times are measured from here, once the fill has been drawn
+	return warpReactionTimerStart();
 }
 
 //function to generate a white flash on the OLED screen
 int
 devSSD1331_flash(int flash_period)
 {
-	
-	writeCommand(kSSD1331CommandCLEAR);
-        writeCommand(0x00);
-        writeCommand(0x00);
-        writeCommand(0x5F);
-        writeCommand(0x3F);
-	
-	//draw rectangle that is white and fills the screen
-	writeCommand(0x22);
-	writeCommand(0x00);
-	writeCommand(0x00);
-	writeCommand(0x5F);
-	writeCommand(0x3F);
-	writeCommand(0xFF);
-	writeCommand(0x3F);
-	writeCommand(0xFF);
-	writeCommand(0xFF);
-	writeCommand(0x3F);
-	writeCommand(0xFF);
-	
+	devSSD1331_flash_start();
+
 	//keep the screen white for the flash period
 	OSA_TimeDelay(flash_period);
-	
-	writeCommand(kSSD1331CommandCLEAR);
-        writeCommand(0x00);
-        writeCommand(0x00);
-        writeCommand(0x5F);
-        writeCommand(0x3F);
-	
+
+	clearScreen();
+	devSSD1331flushCommands();
+
 	return 0;
 }
 
 int
 devSSD1331_clearscreen(void)
 {
-	writeCommand(kSSD1331CommandCLEAR);
-        writeCommand(0x00);
-        writeCommand(0x00);
-        writeCommand(0x5F);
-        writeCommand(0x3F);
-	
+	clearScreen();
+	devSSD1331flushCommands();
+
 	return 0;
 }
 
@@ -230,299 +743,123 @@ devSSD1331_clearscreen(void)
 //function to generate and manipulate the bars in the graph
 int
 devSSD1331_bars(int *time_bin, int *time_bin_indicator, int size)
-{	
-	int t_array[16] = {0};		//array to store the frequency count for each time bin
-	int t_indicator[16] = {0};	//array to store the indicator for which time bin is increasing
-	int growth_step = 0x10; 	//number of pixels grown per unit of frequency
-	int max_bar_height = 0x38;	//maximum number of pixels the bar can grow before reaching the top of the screen
-	
-	//create local array of the time bins
-	for(int x = 0; x < size; x ++)
-    	{
-		/* The pointer time_bin is pointing to the first element of
-		 * the array and size is the size of the array. In the
-		 * loop we are incrementing pointer so that it points to
-		 * the next element of the array on each increment.
-		 *
-		 */
-		t_array[x] = *time_bin;
-		/*increment pointer for next element fetch*/
-		time_bin ++;
-    	}
-	
-	/* create local array which will indicate which time bin has been changed 
-	* This is an array of 1's with one 0 value corresponding to the bin that has changed
-	* Later, the indicator is used as a multiplier for the colour of the bar generated
-	* If the multiplier is 0 (ie the bin has changed) this bar's red and blue colours are zeroed out by the multiplier, 
-	* leaving a green bar surrounded by white bars.
-	*/
-	for(int x = 0; x < size; x ++)
-    	{
-		t_indicator[x] = *time_bin_indicator;
-		/*increment pointer for next element fetch*/
-		time_bin_indicator ++;
-    	}
-	
-	//The following code goes through the time array to find the largest value and store it in max_value
-	int max_value = t_array[0];
-	for(int x = 0; x < size; x ++)
-    	{
-		if(t_array[x] > max_value)
+{
+	uint8_t	growthStep;		//number of pixels grown per unit of frequency
+	int	maxBarHeight = 0x38;	//maximum number of pixels the bar can grow before reaching the top of the screen
+	int	maxValue = 0;
+	bool	redrawAll;
+
+	if (size > kSSD1331BarBins)
+	{
+		size = kSSD1331BarBins;
+	}
+
+	//find the largest value in the time array
+	for (int x = 0; x < size; x++)
+	{
+		if (time_bin[x] > maxValue)
 		{
-			max_value = t_array[x];
-		}			
-    	}
-	
+			maxValue = time_bin[x];
+		}
+	}
+
+	/*
+	 *	Scale the results when the highest bar hits the top of the OLED screen,
+	 *	by adjusting the number of pixels in each growth step depending on the
+	 *	maximum value in the time array. The height of the chart is 56 pixels
+	 *	(0x38) and the first growth step is 16 pixels (0x10).
+	 */
+	if (maxValue == 0 || maxBarHeight/maxValue >= 0x10)
+	{
+		growthStep = 0x10;
+	}
+	else if (maxBarHeight/maxValue >= 0x08)
+	{
+		growthStep = 0x08;
+	}
+	else if (maxBarHeight/maxValue >= 0x04)
+	{
+		growthStep = 0x04;
+	}
+	else if (maxBarHeight/maxValue >= 0x02)
+	{
+		growthStep = 0x02;
+	}
+	else
+	{
+		growthStep = 0x01;
+	}
 
 	/*
-	* The following code is used to scale the results when the highest bar hits the top of the OLED screen
-	* It does this by adjusting the number of pixels in each growth step depending on the maximum value in the time array
-	*The height of the chart is 56 pixels (0x38)
-	*The first growth step is 16 pixels (0x10)
-	*/
-	int scale = max_bar_height/max_value;	//divide the max height of the chart (56 pixels) by the maximum value in the time array
-	switch(scale)
+	 *	Every bar is redrawn only if nothing retained is on the panel, something
+	 *	was drawn over it, or the scale changed. Otherwise a bar that grew has just its new top drawn, a
+	 *	bar that shrank has the rows it lost cleared, and a bar that changed
+	 *	colour is redrawn whole.
+	 */
+	redrawAll = !barChart.valid || barChart.overdrawn || (barChart.growthStep != growthStep);
+
+	/*
+	 *	Bins 0 to 14 are 5 pixels wide on a 6 pixel pitch. The indicator is 1 for
+	 *	every bin except the one that has just changed, and is used as a multiplier
+	 *	on the red and blue components: that bar is drawn green, the others white.
+	 *	Bins beyond size are drawn empty with an indicator of 0, as before. The
+	 *	last bin (300+ ms) is 4 pixels wide and always red.
+	 */
+	for (int bin = 0; bin < kSSD1331BarBins; bin++)
 	{
-		case 0x10 ... 0x38:		//result is between 16 and 56
+		bool	lastBin = (bin == kSSD1331BarBins - 1);
+		uint8_t	columnStart = lastBin ? 0x5C : 0x02 + 6*bin;
+		uint8_t	columnEnd = lastBin ? 0x5F : 0x06 + 6*bin;
+		int	value = (bin < size) ? time_bin[bin] : 0;
+		int	top = 0x38 - growthStep*value;
+		uint8_t	redBlue;
+
+		if (lastBin)
 		{
-			growth_step = 0x10;	//set growth step to 16
-			break;	
+			redBlue = 0x00;
 		}
-		case 0x08 ... 0x0F:		//result is between 8 and 16
+		else
 		{
-			growth_step = 0x08;	//set growth step to 8
-			break;
+			redBlue = (bin < size) ? (uint8_t)(0xFF * time_bin_indicator[bin]) : 0x00;
 		}
-		case 0x04 ... 0x07:		//result is between 4 and 8
+
+		if (top < 0)
 		{
-			growth_step = 0x04;	//set growth step to 4
-			break;
+			top = 0;
 		}
-		case 0x02 ... 0x03:		//result is between 2 and 4
+
+		if (!barChart.valid)
 		{
-			growth_step = 0x02;	//set growth step to 2
-			break;
-		}			
-		case 0x00 ... 0x01:		//result is between 0 and 2
+			/*
+			 *	Screen is blank: nothing to clear.
+			 */
+		}
+		else if (top > barChart.barTop[bin])
 		{
-			growth_step = 0x01;	//set growth to 1
-			break;
+			clearWindow(columnStart, barChart.barTop[bin], columnEnd, top - 1);
 		}
-		default:
+
+		if (redrawAll || (redBlue != barChart.barRedBlue[bin]))
 		{
-			growth_step = 0x01;
-			break;
+			drawFilledRect(columnStart, top, columnEnd, 0x38,
+					lastBin ? 0xFF : redBlue, lastBin ? 0x00 : 0x3F, redBlue);
+		}
+		else if (top < barChart.barTop[bin])
+		{
+			drawFilledRect(columnStart, top, columnEnd, barChart.barTop[bin] - 1,
+					lastBin ? 0xFF : redBlue, lastBin ? 0x00 : 0x3F, redBlue);
 		}
+
+		barChart.barTop[bin] = top;
+		barChart.barRedBlue[bin] = redBlue;
 	}
-	
-	//0-19 bin 0
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x02);	//column start
-	writeCommand(0x38 - (growth_step * t_array[0]));	//row start
-	writeCommand(0x06);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[0]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[0]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[0]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[0]);	//colour A of fill
-	
-	//20-39 bin 1
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x08);	//column start
-	writeCommand(0x38 - (growth_step * t_array[1]));	//row start
-	writeCommand(0x0C);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[1]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[1]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[1]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[1]);	//colour A of fill
-	
-	//40-59 bin 2
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x0E);	//column start
-	writeCommand(0x38 - (growth_step * t_array[2]));	//row start
-	writeCommand(0x12);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[2]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[2]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[2]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[2]);	//colour A of fill
-	
-	//60-79 bin 3
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x14);	//column start
-	writeCommand(0x38 - (growth_step * t_array[3]));	//row start
-	writeCommand(0x18);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[3]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[3]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[3]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[3]);	//colour A of fill
-	
-	//80-99 bin 4
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x1A);	//column start
-	writeCommand(0x38 - (growth_step * t_array[4]));	//row start
-	writeCommand(0x1E);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[4]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[4]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[4]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[4]);	//colour A of fill
-	
-	//100-119 bin 5
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x20);	//column start
-	writeCommand(0x38 - (growth_step * t_array[5]));	//row start
-	writeCommand(0x24);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[5]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[5]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[5]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[5]);	//colour A of fill
-	
-	//120-139 bin 6
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x26);	//column start
-	writeCommand(0x38 - (growth_step * t_array[6]));	//row start
-	writeCommand(0x2A);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[6]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[6]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[6]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[6]);	//colour A of fill
-	
-	//140-159 bin 7
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x2C);	//column start
-	writeCommand(0x38 - (growth_step * t_array[7]));	//row start
-	writeCommand(0x30);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[7]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[7]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[7]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[7]);	//colour A of fill
-	
-	//160-179 bin 8
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x32);	//column start
-	writeCommand(0x38 - (growth_step * t_array[8]));	//row start
-	writeCommand(0x36);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[8]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[8]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[8]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[8]);	//colour A of fill
-	
-	//180-199 bin 9
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x38);	//column start
-	writeCommand(0x38 - (growth_step * t_array[9]));	//row start
-	writeCommand(0x3C);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[9]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[9]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[9]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[9]);	//colour A of fill
-	
-	//200-219 bin 10
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x3E);	//column start
-	writeCommand(0x38 - (growth_step * t_array[10]));	//row start
-	writeCommand(0x42);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[10]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[10]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[10]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[10]);	//colour A of fill
-
-	//220-239 bin 11
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x44);	//column start
-	writeCommand(0x38 - (growth_step * t_array[11]));	//row start
-	writeCommand(0x48);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[11]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[11]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[11]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[11]);	//colour A of fill
-	
-	//240-259 bin 12
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x4A);	//column start
-	writeCommand(0x38 - (growth_step * t_array[12]));	//row start
-	writeCommand(0x4E);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[12]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[12]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[12]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[12]);	//colour A of fill
-	
-	//260-279 bin 13
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x50);	//column start
-	writeCommand(0x38 - (growth_step * t_array[13]));	//row start
-	writeCommand(0x54);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[13]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[13]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[13]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[13]);	//colour A of fill
-	
-	//280-299 bin 14
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x56);	//column start
-	writeCommand(0x38 - (growth_step * t_array[14]));	//row start
-	writeCommand(0x5A);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF * t_indicator[14]);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);			//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF * t_indicator[14]);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF * t_indicator[14]);	//colour C of fill
-	writeCommand(0x3F);			//colour B of fill
-	writeCommand(0xFF * t_indicator[14]);	//colour A of fill
-	
-	//300+ bin 15
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x5C);	//column start
-	writeCommand(0x38 - (growth_step * t_array[15]));	//row start
-	writeCommand(0x5F);	//column end
-	writeCommand(0x38);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x00);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0x00);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x00);	//colour B of fill
-	writeCommand(0x00);	//colour A of fill
-	
+
+	barChart.growthStep = growthStep;
+	barChart.valid = true;
+	barChart.overdrawn = false;
+
+	devSSD1331flushCommands();
+
 	return 0;
 }
 
@@ -532,920 +869,267 @@ devSSD1331_bars(int *time_bin, int *time_bin_indicator, int size)
 int
 devSSD1331_axes(void)
 {
-	//draw y axis line
-	writeCommand(0x21);	//line command
-	writeCommand(0x00);	//column start
-	writeCommand(0x00);	//row start
-	writeCommand(0x00);	//column end
-	writeCommand(0x39);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	//draw x axis line with pointers
-	writeCommand(0x21);	//line command
-	writeCommand(0x00);	//column start
-	writeCommand(0x39);	//row start
-	writeCommand(0x5F);	//column end
-	writeCommand(0x39);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	//0 pointer
-	writeCommand(0x21);	//line command
-	writeCommand(0x00);	//column start
-	writeCommand(0x3A);	//row start
-	writeCommand(0x00);	//column end
-	writeCommand(0x3A);	//row end
-	writeCommand(0x00);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0x00);	//blue colour
-	//100 pointer
-	writeCommand(0x21);	//line command
-	writeCommand(0x1E);	//column start
-	writeCommand(0x3A);	//row start
-	writeCommand(0x1E);	//column end
-	writeCommand(0x3A);	//row end
-	writeCommand(0x00);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0x00);	//blue colour
-	//200 pointer
-	writeCommand(0x21);	//line command
-	writeCommand(0x3C);	//column start
-	writeCommand(0x3A);	//row start
-	writeCommand(0x3C);	//column end
-	writeCommand(0x3A);	//row end
-	writeCommand(0x00);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0x00);	//blue colour
-	//300 pointer
-	writeCommand(0x21);	//line command
-	writeCommand(0x5A);	//column start
-	writeCommand(0x3A);	//row start
-	writeCommand(0x5A);	//column end
-	writeCommand(0x3A);	//row end
-	writeCommand(0x00);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0x00);	//blue colour
-	
-	//draw 0
-	writeCommand(0x21);	//line command
-	writeCommand(0x00);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x02);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x02);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x01);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x01);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	//draw 100
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x1a);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00+0x1a);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x1c);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00+0x1c);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x02+0x1c);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x02+0x1c);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x1c);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x01+0x1c);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x1c);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x01+0x1c);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x20);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00+0x20);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x02+0x20);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x02+0x20);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x20);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x01+0x20);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x20);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x01+0x20);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	//draw 200
-		//2
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x37);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00+0x39);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x37);	//column start
-	writeCommand(0x3D);	//row start
-	writeCommand(0x00+0x39);	//column end
-	writeCommand(0x3D);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x37);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x00+0x39);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x39);	//column start
-	writeCommand(0x3C);	//row start
-	writeCommand(0x00+0x39);	//column end
-	writeCommand(0x3C);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x37);	//column start
-	writeCommand(0x3E);	//row start
-	writeCommand(0x00+0x37);	//column end
-	writeCommand(0x3E);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-		//0 (tens)
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x3B);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00+0x3B);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x02+0x3B);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x02+0x3B);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x3B);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x01+0x3B);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x3B);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x01+0x3B);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-		//0 (ones)
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x3F);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00+0x3F);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x02+0x3F);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x02+0x3F);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x3F);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x01+0x3F);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x3F);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x01+0x3F);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	//draw 300
-		//3
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x37+0x1E);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00+0x39+0x1E);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x37+0x1E);	//column start
-	writeCommand(0x3D);	//row start
-	writeCommand(0x00+0x39+0x1E);	//column end
-	writeCommand(0x3D);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x37+0x1E);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x00+0x39+0x1E);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x39+0x1E);	//column start
-	writeCommand(0x3C);	//row start
-	writeCommand(0x00+0x39+0x1E);	//column end
-	writeCommand(0x3C);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x39+0x1E);	//column start
-	writeCommand(0x3E);	//row start
-	writeCommand(0x00+0x39+0x1E);	//column end
-	writeCommand(0x3E);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-		//0 (tens)
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x59);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00+0x59);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x02+0x59);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x02+0x59);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x59);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x01+0x59);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x59);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x01+0x59);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-		//0 (ones)
-	writeCommand(0x21);	//line command
-	writeCommand(0x00+0x5D);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00+0x5D);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x02+0x5D);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x02+0x5D);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x5D);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x01+0x5D);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01+0x5D);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x01+0x5D);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
+	if (axesOnScreen == kSSD1331AxesTime)
+	{
+		return 0;
+	}
+
+	drawLines(axesFrameLines, sizeof(axesFrameLines)/sizeof(axesFrameLines[0]));
+	drawLines(timeAxisLabelLines, sizeof(timeAxisLabelLines)/sizeof(timeAxisLabelLines[0]));
+	devSSD1331flushCommands();
+	axesOnScreen = kSSD1331AxesTime;
+
 	return 0;
 }
 
 
+
 //function to draw the axes of the current graph
 int
 devSSD1331_current_axes(void)
+{
+	if (axesOnScreen == kSSD1331AxesCurrent)
 	{
-	//draw y axis line
-	writeCommand(0x21);	//line command
-	writeCommand(0x00);	//column start
-	writeCommand(0x00);	//row start
-	writeCommand(0x00);	//column end
-	writeCommand(0x39);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	//draw x axis line with pointers
-	writeCommand(0x21);	//line command
-	writeCommand(0x00);	//column start
-	writeCommand(0x39);	//row start
-	writeCommand(0x5F);	//column end
-	writeCommand(0x39);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	//0 pointer
-	writeCommand(0x21);	//line command
-	writeCommand(0x00);	//column start
-	writeCommand(0x3A);	//row start
-	writeCommand(0x00);	//column end
-	writeCommand(0x3A);	//row end
-	writeCommand(0x00);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0x00);	//blue colour
-	//5 pointer
-	writeCommand(0x21);	//line command
-	writeCommand(0x1E);	//column start
-	writeCommand(0x3A);	//row start
-	writeCommand(0x1E);	//column end
-	writeCommand(0x3A);	//row end
-	writeCommand(0x00);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0x00);	//blue colour
-	//10 pointer
-	writeCommand(0x21);	//line command
-	writeCommand(0x3C);	//column start
-	writeCommand(0x3A);	//row start
-	writeCommand(0x3C);	//column end
-	writeCommand(0x3A);	//row end
-	writeCommand(0x00);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0x00);	//blue colour
-	//15 pointer
-	writeCommand(0x21);	//line command
-	writeCommand(0x5A);	//column start
-	writeCommand(0x3A);	//row start
-	writeCommand(0x5A);	//column end
-	writeCommand(0x3A);	//row end
-	writeCommand(0x00);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0x00);	//blue colour
-	
-	//draw 0
-	writeCommand(0x21);	//line command
-	writeCommand(0x00);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x00);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x02);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x02);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x01);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x01);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x01);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	//draw 5
-	writeCommand(0x21);	//line command
-	writeCommand(0x1D);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x1D);	//column end
-	writeCommand(0x3D);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x1F);	//column start
-	writeCommand(0x3D);	//row start
-	writeCommand(0x1F);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x1D);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x1F);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x1D);	//column start
-	writeCommand(0x3D);	//row start
-	writeCommand(0x1F);	//column end
-	writeCommand(0x3D);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x1D);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x1F);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	//draw 10
-	writeCommand(0x21);	//line command
-	writeCommand(0x3A);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x3A);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x3C);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x3C);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x3E);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x3E);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x3D);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(0x3D);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(0x3D);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(0x3F);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	//draw 15
-	writeCommand(0x21);	//line command
-	writeCommand(88);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(88);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(90);	//column start
-	writeCommand(0x3B);	//row start
-	writeCommand(92);	//column end
-	writeCommand(0x3B);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(90);	//column start
-	writeCommand(0x3D);	//row start
-	writeCommand(92);	//column end
-	writeCommand(0x3D);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(90);	//column start
-	writeCommand(0x3F);	//row start
-	writeCommand(92);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(90);	//column start
-	writeCommand(0x3C);	//row start
-	writeCommand(90);	//column end
-	writeCommand(0x3C);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(92);	//column start
-	writeCommand(0x3E);	//row start
-	writeCommand(92);	//column end
-	writeCommand(0x3E);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	//draw mA
-	//m
-	writeCommand(0x21);	//line command
-	writeCommand(82);	//column start
-	writeCommand(0x03);	//row start
-	writeCommand(82);	//column end
-	writeCommand(0x07);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(82);	//column start
-	writeCommand(0x03);	//row start
-	writeCommand(86);	//column end
-	writeCommand(0x03);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(84);	//column start
-	writeCommand(0x03);	//row start
-	writeCommand(84);	//column end
-	writeCommand(0x05);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(86);	//column start
-	writeCommand(0x03);	//row start
-	writeCommand(86);	//column end
-	writeCommand(0x07);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	//A
-	writeCommand(0x21);	//line command
-	writeCommand(89);	//column start
-	writeCommand(0x04);	//row start
-	writeCommand(89);	//column end
-	writeCommand(0x07);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(91);	//column start
-	writeCommand(0x02);	//row start
-	writeCommand(89);	//column end
-	writeCommand(0x04);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(91);	//column start
-	writeCommand(0x02);	//row start
-	writeCommand(93);	//column end
-	writeCommand(0x04);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(89);	//column start
-	writeCommand(0x05);	//row start
-	writeCommand(93);	//column end
-	writeCommand(0x05);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
-	writeCommand(0x21);	//line command
-	writeCommand(93);	//column start
-	writeCommand(0x04);	//row start
-	writeCommand(93);	//column end
-	writeCommand(0x07);	//row end
-	writeCommand(0xFF);	//red colour
-	writeCommand(0x3F);	//green colour
-	writeCommand(0xFF);	//blue colour
-	
+		return 0;
+	}
+
+	drawLines(axesFrameLines, sizeof(axesFrameLines)/sizeof(axesFrameLines[0]));
+	drawLines(currentAxisLabelLines, sizeof(currentAxisLabelLines)/sizeof(currentAxisLabelLines[0]));
+	devSSD1331flushCommands();
+	axesOnScreen = kSSD1331AxesCurrent;
+
 	return 0;
 }
 
 
 
+//function to draw one digit (3, 2 or 1) of the countdown onto a clear screen
+int
+devSSD1331_countdown_digit(int digit)
+{
+	switch (digit)
+	{
+		case 3:
+		{
+			drawWhiteRects(countdownThreeRects, sizeof(countdownThreeRects)/sizeof(countdownThreeRects[0]));
+			break;
+		}
+
+		case 2:
+		{
+			drawWhiteRects(countdownTwoRects, sizeof(countdownTwoRects)/sizeof(countdownTwoRects[0]));
+			break;
+		}
+
+		case 1:
+		{
+			drawWhiteRects(countdownOneRects, sizeof(countdownOneRects)/sizeof(countdownOneRects[0]));
+			break;
+		}
+
+		default:
+		{
+			return -1;
+		}
+	}
+
+	return devSSD1331flushCommands();
+}
+
 //function which will generate a 3, 2, 1 countdown on the screen, with one second per number
 int
 devSSD1331_countdown(void)
 {
-	writeCommand(kSSD1331CommandCLEAR);
-        writeCommand(0x00);
-        writeCommand(0x00);
-        writeCommand(0x5F);
-        writeCommand(0x3F);
-	
-	//3
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x20);	//column start
-	writeCommand(0x00);	//row start
-	writeCommand(0x3F);	//column end
-	writeCommand(0x02);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x3F);	//colour B of fill
-	writeCommand(0xFF);	//colour A of fill
-	
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x3D);	//column start
-	writeCommand(0x00);	//row start
-	writeCommand(0x3F);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x3F);	//colour B of fill
-	writeCommand(0xFF);	//colour A of fill
-	
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x20);	//column start
-	writeCommand(0x1F);	//row start
-	writeCommand(0x3F);	//column end
-	writeCommand(0x21);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x3F);	//colour B of fill
-	writeCommand(0xFF);	//colour A of fill
-	
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x20);	//column start
-	writeCommand(0x3D);	//row start
-	writeCommand(0x3F);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x3F);	//colour B of fill
-	writeCommand(0xFF);	//colour A of fill
-	
-	OSA_TimeDelay(700);
-	
-	writeCommand(kSSD1331CommandCLEAR);
-        writeCommand(0x00);
-        writeCommand(0x00);
-        writeCommand(0x5F);
-        writeCommand(0x3F);
-	
-	OSA_TimeDelay(300);
-	
-	//2
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x20);	//column start
-	writeCommand(0x00);	//row start
-	writeCommand(0x3F);	//column end
-	writeCommand(0x02);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x3F);	//colour B of fill
-	writeCommand(0xFF);	//colour A of fill
-	
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x3D);	//column start
-	writeCommand(0x00);	//row start
-	writeCommand(0x3F);	//column end
-	writeCommand(0x20);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x3F);	//colour B of fill
-	writeCommand(0xFF);	//colour A of fill
-	
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x20);	//column start
-	writeCommand(0x1F);	//row start
-	writeCommand(0x3F);	//column end
-	writeCommand(0x21);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x3F);	//colour B of fill
-	writeCommand(0xFF);	//colour A of fill
-	
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x20);	//column start
-	writeCommand(0x20);	//row start
-	writeCommand(0x22);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x3F);	//colour B of fill
-	writeCommand(0xFF);	//colour A of fill
-	
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x20);	//column start
-	writeCommand(0x3D);	//row start
-	writeCommand(0x3F);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x3F);	//colour B of fill
-	writeCommand(0xFF);	//colour A of fill
-	
-	OSA_TimeDelay(700);
-	
-	writeCommand(kSSD1331CommandCLEAR);
-        writeCommand(0x00);
-        writeCommand(0x00);
-        writeCommand(0x5F);
-        writeCommand(0x3F);
-	
-	OSA_TimeDelay(300);
-	
-	//1
-	
-	writeCommand(0x22);	//rectangle command
-	writeCommand(0x3D);	//column start
-	writeCommand(0x00);	//row start
-	writeCommand(0x3F);	//column end
-	writeCommand(0x3F);	//row end
-	writeCommand(0xFF);	//colour C (RED) of outline (max FF)
-	writeCommand(0x3F);	//colour B (GREEN) of outline (max 3F)
-	writeCommand(0xFF);	//colour A (BLUE) of outline (max FF)
-	writeCommand(0xFF);	//colour C of fill
-	writeCommand(0x3F);	//colour B of fill
-	writeCommand(0xFF);	//colour A of fill
-	
-	OSA_TimeDelay(700);
-	
-	writeCommand(kSSD1331CommandCLEAR);
-        writeCommand(0x00);
-        writeCommand(0x00);
-        writeCommand(0x5F);
-        writeCommand(0x3F);
-	
-	
+	clearScreen();
+
+	for (int digit = 3; digit > 0; digit--)
+	{
+		devSSD1331_countdown_digit(digit);
+		OSA_TimeDelay(700);
+		clearScreen();
+		devSSD1331flushCommands();
+
+		if (digit > 1)
+		{
+			OSA_TimeDelay(300);
+		}
+	}
+
+	return 0;
+}
+
+
+
+static const uint8_t *
+fontGlyph(char character)
+{
+	for (int i = 0; fontCharacters[i] != '\0'; i++)
+	{
+		if (fontCharacters[i] == character)
+		{
+			return fontGlyphs[i];
+		}
+	}
+
+	return fontGlyphs[0];
+}
+
+/*
+ *	Draw text in the given RGB565 colour on black, with its top left corner at
+ *	(column, row). The whole string is one SETCOLUMN/SETROW window whose pixels
+ *	are streamed row by row as display RAM data, so it costs one 6-byte command
+ *	plus two bytes per pixel. Characters that do not fit on the panel are dropped.
+ */
+int
+devSSD1331_text(uint8_t column, uint8_t row, const char *  text, uint16_t colour)
+{
+	const uint8_t *	glyphs[kSSD1331TextMaxCharacters];
+	uint8_t		foreground[2] = {colour >> 8, colour & 0xFF};
+	uint8_t		background[2] = {0x00, 0x00};
+	int		length = 0;
+
+	while ((text[length] != '\0') && (length < kSSD1331TextMaxCharacters)
+		&& (column + (length + 1)*kSSD1331FontCellWidth - 2 <= 0x5F))
+	{
+		glyphs[length] = fontGlyph(text[length]);
+		length++;
+	}
+
+	if ((length == 0) || (row + kSSD1331FontHeight - 1 > 0x3F))
+	{
+		return 0;
+	}
+
+	uint8_t		window[] =
+	{
+		kSSD1331CommandSETCOLUMN, column, column + length*kSSD1331FontCellWidth - 2,
+		kSSD1331CommandSETROW, row, row + kSSD1331FontHeight - 1,
+	};
+	devSSD1331appendCommands(window, sizeof(window));
+
+	/*
+	 *	The window excludes the spacing column after the last character.
+	 */
+	for (int y = 0; y < kSSD1331FontHeight; y++)
+	{
+		for (int i = 0; i < length; i++)
+		{
+			for (int x = 0; x < kSSD1331FontCellWidth; x++)
+			{
+				if ((i == length - 1) && (x == kSSD1331FontCellWidth - 1))
+				{
+					break;
+				}
+
+				if ((x < kSSD1331FontWidth) && ((glyphs[i][x] >> y) & 1))
+				{
+					appendBytes(foreground, sizeof(foreground), true);
+				}
+				else
+				{
+					appendBytes(background, sizeof(background), true);
+				}
+			}
+		}
+	}
+	devSSD1331flushCommands();
+
+	/*
+	 *	The text may have overwritten bars.
+	 */
+	barChart.overdrawn = true;
+
 	return 0;
 }
 
+/*
+ *	Draw value with a decimal point before its last fractionDigits digits,
+ *	followed by suffix, using devSSD1331_text().
+ */
+int
+devSSD1331_number(uint8_t column, uint8_t row, int value, int fractionDigits, const char *  suffix, uint16_t colour)
+{
+	char		text[kSSD1331TextMaxCharacters + 1];
+	char		digits[10];
+	int		digitCount = 0;
+	int		length = 0;
+	unsigned	magnitude = (value < 0) ? -value : value;
+
+	do
+	{
+		digits[digitCount++] = '0' + (magnitude % 10);
+		magnitude /= 10;
+	} while ((magnitude != 0) || (digitCount <= fractionDigits));
+
+	if (value < 0)
+	{
+		text[length++] = '-';
+	}
+
+	while ((digitCount > 0) && (length < kSSD1331TextMaxCharacters))
+	{
+		if ((digitCount == fractionDigits) && (length < kSSD1331TextMaxCharacters - 1))
+		{
+			text[length++] = '.';
+		}
+		text[length++] = digits[--digitCount];
+	}
+
+	while ((*suffix != '\0') && (length < kSSD1331TextMaxCharacters))
+	{
+		text[length++] = *suffix++;
+	}
+	text[length] = '\0';
+
+	return devSSD1331_text(column, row, text, colour);
+}
+
+
 
+/*
+ *	Draw the reaction-time axes and a set of bars, first through the original
+ *	byte-at-a-time path and then batched, then update a single bar, and print
+ *	the core clock cycles each took as measured by the SysTick cycle counter.
+ *	Delays are spun while the counter runs, so they are included.
+ */
+void
+devSSD1331_benchmark(void)
+{
+	int		bins[kSSD1331BarBins]		= {1, 2, 3, 2, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1};
+	int		indicator[kSSD1331BarBins]	= {1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+	uint32_t	axesCycles[2];
+	uint32_t	barsCycles[2];
+	uint32_t	updateCycles;
+
+	for (int batched = 0; batched < 2; batched++)
+	{
+		commandRingUnbatched = !batched;
+		devSSD1331_clearscreen();
+
+		warpCycleCounterStart();
+		devSSD1331_axes();
+		devSSD1331fenceCommands();
+		axesCycles[batched] = warpCycleCounterRead();
+
+		warpCycleCounterStart();
+		devSSD1331_bars(bins, indicator, kSSD1331BarBins);
+		devSSD1331fenceCommands();
+		barsCycles[batched] = warpCycleCounterRead();
+	}
+	commandRingUnbatched = false;
+
+	/*
+	 *	One more result in bin 2: only that bar is retouched.
+	 */
+	bins[2]++;
+	warpCycleCounterStart();
+	devSSD1331_bars(bins, indicator, kSSD1331BarBins);
+	devSSD1331fenceCommands();
+	updateCycles = warpCycleCounterRead();
+	warpCycleCounterStop();
+
+	SEGGER_RTT_printf(0, "\r\n\tSSD1331 benchmark (core clock %u Hz)\n", SystemCoreClock);
+	SEGGER_RTT_printf(0, "\r\taxes: %u cycles unbatched, %u cycles batched\n", axesCycles[0], axesCycles[1]);
+	SEGGER_RTT_printf(0, "\r\tbars: %u cycles unbatched, %u cycles batched\n", barsCycles[0], barsCycles[1]);
+	SEGGER_RTT_printf(0, "\r\tbars, one bin changed: %u cycles\n", updateCycles);
+}
@@ -7,8 +7,27 @@ typedef enum
 	kSSD1331ColororderRGB		= 1,
 	kSSD1331DelaysHWFILL		= 3,
 	kSSD1331DelaysHWLINE		= 1,
+	kSSD1331CommandRingBytes	= 128,	/*	Must be a power of two	*/
+	kSSD1331LineOperandBytes	= 7,
+	kSSD1331RectOperandBytes	= 10,
+	kSSD1331WindowOperandBytes	= 4,
+	kSSD1331BarBins			= 16,
+	kSSD1331FontWidth		= 5,
+	kSSD1331FontHeight		= 7,
+	kSSD1331FontCellWidth		= 6,
+	kSSD1331TextMaxCharacters	= 16,
 } SSD1331Constants;
 
+/*
+ *	RGB565, as used for display RAM data (devSSD1331_text()).
+ */
+typedef enum
+{
+	kSSD1331ColorWhite		= 0xFFFF,
+	kSSD1331ColorGreen		= 0x07E0,
+	kSSD1331ColorRed		= 0xF800,
+} SSD1331Colors;
+
 typedef enum
 {
 	kSSD1331CommandDRAWLINE		= 0x21,
@@ -43,3 +62,18 @@ typedef enum
 } SSD1331Commands;
 
 int	devSSD1331init(void);
+void	devSSD1331appendCommands(const uint8_t *  commandBytes, int count);
+int	devSSD1331flushCommands(void);
+void	devSSD1331fenceCommands(void);
+bool	devSSD1331busy(void);
+int	devSSD1331_flash(int flash_period);
+WarpStatus	devSSD1331_flash_start(void);
+int	devSSD1331_clearscreen(void);
+int	devSSD1331_bars(int *time_bin, int *time_bin_indicator, int size);
+int	devSSD1331_axes(void);
+int	devSSD1331_current_axes(void);
+int	devSSD1331_countdown(void);
+int	devSSD1331_countdown_digit(int digit);
+int	devSSD1331_text(uint8_t column, uint8_t row, const char *  text, uint16_t colour);
+int	devSSD1331_number(uint8_t column, uint8_t row, int value, int fractionDigits, const char *  suffix, uint16_t colour);
+void	devSSD1331_benchmark(void);
@@ -84,12 +84,13 @@ gpio_output_pin_user_config_t	outputPins[] = {
 		.config.slewRate = kPortSlowSlewRate,
 		.config.driveStrength = kPortLowDriveStrength,
 	},
-	{
-		.pinName = kWarpPinSI4705_nRST,				/*	Was kWarpPinUnusedPTB7 in Warp v2			*/
-		.config.outputLogic = 1,
-		.config.slewRate = kPortSlowSlewRate,
-		.config.driveStrength = kPortLowDriveStrength,
-	},
+//Move this pin from an output pin to an input pin for the sensor data-ready line
+//	{
+//		.pinName = kWarpPinSI4705_nRST,				/*	Was kWarpPinUnusedPTB7 in Warp v2			*/
+//		.config.outputLogic = 1,
+//		.config.slewRate = kPortSlowSlewRate,
+//		.config.driveStrength = kPortLowDriveStrength,
+//	},
 #ifndef WARP_BUILD_ENABLE_THERMALCHAMBERANALYSIS
 	{
 		.pinName = kWarpPinPAN1326_nSHUTD,			/*	Was kWarpPinUnusedPTB10 in Warp v2			*/
@@ -251,6 +252,15 @@ gpio_input_pin_user_config_t	inputPins[] = {
         	.config.isPassiveFilterEnabled = false,
         	.config.interrupt = kPortIntDisabled,
         },
+
+	//PTB7 - SENSOR DATA-READY LINE (OPEN DRAIN, ACTIVE LOW)
+	{
+		.pinName = kWarpPinSensorDataReady,
+		.config.isPullEnable = true,
+		.config.pullSelect = kPortPullUp,
+		.config.isPassiveFilterEnabled = false,
+		.config.interrupt = kPortIntDisabled,
+	},
 	{
 		.pinName = GPIO_PINS_OUT_OF_RANGE,
 	}
@@ -65,7 +65,14 @@ enum _gpio_pins
 	kWarpPinTS5A3154_IN			= GPIO_MAKE_PIN(HW_GPIOB, 6),		/*	Warp TS5A3154_IN	--> PTB6		(was unused in Warp v2)					*/
 	kWarpPinSI4705_nRST			= GPIO_MAKE_PIN(HW_GPIOB, 7),		/*	Warp SI4705_nRST	--> PTB7		(was unused in Warp v2)					*/
 
+	//use kWarpPinSI4705_nRST (PTB7, IRQ_3) as the sensors' wire-ORed, open-drain, active-low data-ready line
+	kWarpPinSensorDataReady			= GPIO_MAKE_PIN(HW_GPIOB, 7),		/*	MMA8451Q INT1, L3GD20H DRDY, BMX055 INT1/INT3 --> PTB7					*/
+
 	kWarpPinPAN1326_nSHUTD			= GPIO_MAKE_PIN(HW_GPIOB, 10),		/*	Warp PAN1326_nSHUTD	--> PTB10		(was unused in Warp v2)					*/
+
+	//use kWarpPinPAN1326_nSHUTD (PTB10) as the IS25WP128's chip select on boards without the PAN1326
+	kWarpPinIS25WP128_nCS			= GPIO_MAKE_PIN(HW_GPIOB, 10),		/*	IS25WP128 /CS		--> PTB10									*/
+
 	kWarpPinISL23415_nCS			= GPIO_MAKE_PIN(HW_GPIOB, 11),		/*	Warp ISL23415_nCS	--> PTB11		(was TPS82675_MODE in Warp v2)				*/
 	kWarpPinCLKOUT32K			= GPIO_MAKE_PIN(HW_GPIOB, 13),		/*	Warp KL03_CLKOUT32K	--> PTB13									*/
 
@@ -78,6 +78,7 @@
 //#include "devSI7021.h"
 //#include "devLPS25H.h"
 //#include "devADXL362.h"
+//#include "devIS25WP128.h"
 //#include "devPAN1326.h"
 //#include "devAS7262.h"
 //#include "devAS7263.h"
@@ -85,11 +86,52 @@
 #else
 #	include "devMMA8451Q.h"
 #	include "devINA219.h"	//include header file of INA219
+#	include "devSSD1331.h"
 #endif
 
 #define WARP_BUILD_ENABLE_SEGGER_RTT_PRINTF
 //#define WARP_BUILD_BOOT_TO_CSVSTREAM
 
+/*
+ *	Print the cycles taken to draw the SSD1331 axes and bars, unbatched and batched, after initialising the display.
+ */
+//#define WARP_BUILD_ENABLE_SSD1331_BENCHMARK
+
+/*
+ *	Print the cycles per CSV row with SEGGER_RTT_printf() per field and through warp-kl03-ksdk1.1-csv.c, at boot.
+ */
+//#define WARP_BUILD_ENABLE_CSV_BENCHMARK
+
+/*
+ *	Print the cycles per INA219 current conversion in soft-float and through warp-kl03-ksdk1.1-fixedpoint.c, at boot.
+ */
+//#define WARP_BUILD_ENABLE_FIXEDPOINT_BENCHMARK
+
+/*
+ *	Alongside the game, print every sample the accelerometers and gyros flag on the data-ready line, with its timestamp.
+ */
+//#define WARP_BUILD_ENABLE_DATAREADY_STREAM
+
+/*
+ *	In the data-ready stream, batch the MMA8451Q's samples in its FIFO and drain them at each watermark interrupt.
+ */
+//#define WARP_BUILD_ENABLE_MMA8451Q_FIFO_STREAM
+
+/*
+ *	Likewise for the L3GD20H, in FIFO stream mode.
+ */
+//#define WARP_BUILD_ENABLE_L3GD20H_FIFO_STREAM
+
+/*
+ *	Likewise for the BMX055, as one 9-axis record per accel/gyro frame pair, with the latest magnetometer reading.
+ */
+//#define WARP_BUILD_ENABLE_BMX055_FIFO_STREAM
+
+/*
+ *	Send the data-ready and FIFO streams and the game's current samples as binary frames on RTT up-channel 1 (decode with tools/telemetrydecode), rather than as text.
+ */
+//#define WARP_BUILD_ENABLE_TELEMETRY
+
 
 /*
 *	BTstack includes WIP
@@ -106,6 +148,10 @@
 volatile WarpSPIDeviceState			deviceADXL362State;
 #endif
 
+#ifdef WARP_BUILD_ENABLE_DEVIS25WP128
+volatile WarpSPIDeviceState			deviceIS25WP128State;
+#endif
+
 #ifdef WARP_BUILD_ENABLE_DEVBMX055
 volatile WarpI2CDeviceState			deviceBMX055accelState;
 volatile WarpI2CDeviceState			deviceBMX055gyroState;
@@ -335,13 +381,7 @@ sleepUntilReset(void)
 {
 	while (1)
 	{
-#ifdef WARP_BUILD_ENABLE_DEVSI4705
-		GPIO_DRV_SetPinOutput(kWarpPinSI4705_nRST);
-#endif
 		warpLowPowerSecondsSleep(1, false /* forceAllPinsIntoLowPowerState */);
-#ifdef WARP_BUILD_ENABLE_DEVSI4705
-		GPIO_DRV_ClearPinOutput(kWarpPinSI4705_nRST);
-#endif
 		warpLowPowerSecondsSleep(60, true /* forceAllPinsIntoLowPowerState */);
 	}
 }
@@ -639,7 +679,11 @@ lowPowerPinStates(void)
 #endif
 
 	GPIO_DRV_ClearPinOutput(kWarpPinTS5A3154_IN);
-	GPIO_DRV_ClearPinOutput(kWarpPinSI4705_nRST);
+
+	/*
+	 *	kWarpPinSI4705_nRST (PTB7) is now the sensors' data-ready input,
+	 *	so it is left alone.
+	 */
 
 	/*
 	 *	Drive these chip selects high since they are active low:
@@ -650,6 +694,9 @@ lowPowerPinStates(void)
 #ifdef WARP_BUILD_ENABLE_DEVADXL362
 	GPIO_DRV_SetPinOutput(kWarpPinADXL362_CS);
 #endif
+#ifdef WARP_BUILD_ENABLE_DEVIS25WP128
+	GPIO_DRV_SetPinOutput(kWarpPinIS25WP128_nCS);
+#endif
 
 	/*
 	 *	When the PAN1326 is installed, note that it has the
@@ -1024,33 +1071,741 @@ checkSum(uint8_t *  pointer, uint16_t length) /*	Adapted from https://stackoverf
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int latch = 0;
-int time_count = 0;
+/*
+ *	The reaction game runs as cooperative tasks (see
+ *	warp-kl03-ksdk1.1-scheduler.c): the game itself, INA219 current
+ *	sampling and drawing of the result screens, with button events from
+ *	warp-kl03-ksdk1.1-buttons.c. None of them blocks, so sampling, drawing
+ *	and input can overlap, and the core sleeps whenever all are waiting.
+ */
+enum
+{
+	kWarpReactionTimeoutMicroseconds	= 3000000,
+	kWarpGameFlashes			= 3,
+	kWarpGameFlashMilliseconds		= 10,
+	kWarpGamePollMilliseconds		= 10,
+	kWarpGameCountdownOnMilliseconds	= 700,
+	kWarpGameCountdownOffMilliseconds	= 300,
+	kWarpGameResultsDelayMilliseconds	= 200,
+	kWarpGameBins				= 16,
+	kWarpGameTimeBinMilliseconds		= 20,
+	kWarpGameMaximumAverageMilliseconds	= 3000,
+	kWarpGameCurrentSamples			= 100,
+	kWarpGameCurrentBinMicroamps		= 1000,
+};
+
+typedef enum
+{
+	kWarpGameStateCountdown,
+	kWarpGameStateWaitForFlash,
+	kWarpGameStateFlash,
+	kWarpGameStateMeasuring,
+	kWarpGameStateResults,
+	kWarpGameStateShowingTimes,
+	kWarpGameStateMeasuringCurrent,
+	kWarpGameStateTimeGraph,
+	kWarpGameStateCurrentGraph,
+} WarpGameState;
+
+typedef enum
+{
+	kWarpGameEventNewRound		= kWarpTaskEventFirstUser << 0,
+	kWarpGameEventCurrentDone	= kWarpTaskEventFirstUser << 1,
+	kWarpGameEventButtons		= kWarpTaskEventFirstUser << 2,
+} WarpGameEvent;
 
-//function to return a reaction time
-int
-measure_time(void)
+typedef enum
+{
+	kWarpDisplayEventTimeGraph	= kWarpTaskEventFirstUser << 0,
+	kWarpDisplayEventHistoryCleared	= kWarpTaskEventFirstUser << 1,
+	kWarpDisplayEventCurrentGraph	= kWarpTaskEventFirstUser << 2,
+} WarpDisplayEvent;
+
+typedef enum
+{
+	kWarpCurrentEventStart		= kWarpTaskEventFirstUser << 0,
+} WarpCurrentEvent;
+
+/*
+ *	The game's messages are tokenized (see warpLog()) when telemetry is
+ *	on, so that none of them is formatted on the KL03.
+ */
+#ifdef WARP_BUILD_ENABLE_TELEMETRY
+#define	gamePrint(...)	warpLog(__VA_ARGS__)
+#else
+#define	gamePrint(...)	SEGGER_RTT_printf(0, __VA_ARGS__)
+#endif
+
+/*
+ *	Delay before each flash; they vary so that reaction time is better tested.
+ */
+static const uint16_t	gameFlashDelayMilliseconds[kWarpGameFlashes] = {1500, 2500, 1700};
+
+static WarpTask		gameTask;
+static WarpTask		currentTask;
+static WarpTask		displayTask;
+
+static int		timeArray[kWarpGameBins];
+static int		timeBinIndicator[kWarpGameBins];
+static int		averageTime;
+static uint32_t		reactionMicroseconds[kWarpGameFlashes];
+static uint8_t		flashIndex;
+static uint8_t		countdownDigit;
+static bool		countdownDigitShown;
+
+static int		currentArray[kWarpGameBins];
+static int		averageCurrent;
+static int		currentSum;
+static int		currentSamplesTaken;
+static int		currentReadsQueued;
+static uint32_t		currentSamplePeriodMilliseconds;
+
+
+static void
+startRound(WarpTask *  task)
+{
+	for (int i = 0; i < kWarpGameBins; i++)
+	{
+		timeBinIndicator[i] = 1;
+	}
+
+	gamePrint("\r\tPrepare for flash\n");
+	devSSD1331_clearscreen();
+	countdownDigit = 3;
+	devSSD1331_countdown_digit(countdownDigit);
+	countdownDigitShown = true;
+
+	task->state = kWarpGameStateCountdown;
+	warpTaskStartTimer(task, kWarpGameCountdownOnMilliseconds);
+}
+
+/*
+ *	Average the round's three reaction times and add the average to the
+ *	histogram, in 20 ms bins with the last for everything over 300 ms.
+ */
+static void
+recordRound(void)
+{
+	int	bin;
+
+	averageTime = (reactionMicroseconds[0] + reactionMicroseconds[1] + reactionMicroseconds[2]) / 3000;
+	gamePrint("\r\tAverage time = %d ms\n", averageTime);
+
+	if (averageTime > kWarpGameMaximumAverageMilliseconds)
+	{
+		gamePrint("\r\tThis shouldn't happen\n");
+		return;
+	}
+
+	bin = averageTime / kWarpGameTimeBinMilliseconds;
+	if (bin >= kWarpGameBins)
+	{
+		bin = kWarpGameBins - 1;
+	}
+
+	timeBinIndicator[bin] = 0;
+	timeArray[bin]++;
+
+	if (bin < kWarpGameBins - 1)
+	{
+		gamePrint("\r\t%d - %d = %d\n", bin * kWarpGameTimeBinMilliseconds, (bin + 1) * kWarpGameTimeBinMilliseconds - 1, timeArray[bin]);
+	}
+	else
+	{
+		gamePrint("\r\t300 plus = %d\n", timeArray[bin]);
+	}
+
+	//print frequency count for all bins
+	gamePrint("\r\n0-19 = %d, 20-39 = %d, 40-59 = %d, 60-79 = %d, 80-99 = %d, 100-119 = %d, 120-139 = %d, 140-159 = %d, 160-179 = %d, 180-199 %d, 200-219 = %d, 220-239 = %d, 240-259 = %d, 260-279 = %d, 280-299 = %d, 300 plus = %d\n\n", timeArray[0], timeArray[1], timeArray[2], timeArray[3], timeArray[4], timeArray[5], timeArray[6], timeArray[7], timeArray[8], timeArray[9], timeArray[10], timeArray[11], timeArray[12], timeArray[13], timeArray[14], timeArray[15]);
+}
+
+static void
+showCurrentGraph(WarpTask *  task)
+{
+	gamePrint("\r\tEscape graphing\n");
+	warpTaskSignal(&displayTask, kWarpDisplayEventCurrentGraph);
+	task->state = kWarpGameStateCurrentGraph;
+}
+
+/*
+ *	Countdown, three flashes with the reaction to each timed by the
+ *	reaction timer, the time histogram while the current through the OLED
+ *	is sampled, then the current histogram. The on board button moves on
+ *	from each graph; pressing it while holding the off board button clears
+ *	the time history.
+ */
+static void
+gameTaskRun(WarpTask *  task, uint32_t events)
+{
+	WarpButtonEvent		buttonEvent;
+	bool			onboardPress = false;
+	bool			chord = false;
+
+	while ((events & kWarpGameEventButtons) && warpButtonsTakeEvent(&buttonEvent))
+	{
+		onboardPress	|= (buttonEvent.type == kWarpButtonEventPress);
+		chord		|= (buttonEvent.type == kWarpButtonEventChord);
+	}
+
+	if (events & kWarpGameEventNewRound)
+	{
+		startRound(task);
+		return;
+	}
+
+	switch (task->state)
+	{
+		case kWarpGameStateCountdown:
+		{
+			if (!(events & kWarpTaskEventTimer))
+			{
+				break;
+			}
+
+			if (!countdownDigitShown)
+			{
+				devSSD1331_countdown_digit(countdownDigit);
+				countdownDigitShown = true;
+				warpTaskStartTimer(task, kWarpGameCountdownOnMilliseconds);
+				break;
+			}
+
+			devSSD1331_clearscreen();
+			countdownDigitShown = false;
+
+			if (countdownDigit > 1)
+			{
+				countdownDigit--;
+				warpTaskStartTimer(task, kWarpGameCountdownOffMilliseconds);
+			}
+			else
+			{
+				flashIndex = 0;
+				task->state = kWarpGameStateWaitForFlash;
+				warpTaskStartTimer(task, gameFlashDelayMilliseconds[flashIndex]);
+			}
+
+			break;
+		}
+
+		case kWarpGameStateWaitForFlash:
+		{
+			WarpStatus	status;
+
+			if (events & kWarpTaskEventTimer)
+			{
+				/*
+				 *	A flash we cannot time is not a 3 s reaction: report
+				 *	it and start the round again.
+				 */
+				status = devSSD1331_flash_start();
+				if (status != kWarpStatusOK)
+				{
+					gamePrint("\r\tReaction timer failed to start (status %d)\n", status);
+					startRound(task);
+					break;
+				}
+
+				task->state = kWarpGameStateFlash;
+				warpTaskStartTimer(task, kWarpGameFlashMilliseconds);
+			}
+
+			break;
+		}
+
+		case kWarpGameStateFlash:
+		{
+			if (events & kWarpTaskEventTimer)
+			{
+				devSSD1331_clearscreen();
+				task->state = kWarpGameStateMeasuring;
+				warpTaskStartTimer(task, kWarpGamePollMilliseconds);
+			}
+
+			break;
+		}
+
+		case kWarpGameStateMeasuring:
+		{
+			uint32_t	microseconds;
+			WarpStatus	status;
+
+			if (!(events & kWarpTaskEventTimer))
+			{
+				break;
+			}
+
+			/*
+			 *	The capture is in hardware, so how often we poll does not
+			 *	affect the result.
+			 */
+			status = warpReactionTimerPoll(kWarpReactionTimeoutMicroseconds, &microseconds);
+			if (status == kWarpStatusPending)
+			{
+				warpTaskStartTimer(task, kWarpGamePollMilliseconds);
+				break;
+			}
+
+			if (status == kWarpStatusTimeout)
+			{
+				microseconds = kWarpReactionTimeoutMicroseconds;
+			}
+			else if (status != kWarpStatusOK)
+			{
+				gamePrint("\r\tReaction timer failed (status %d)\n", status);
+				startRound(task);
+				break;
+			}
+
+			reactionMicroseconds[flashIndex] = microseconds;
+			gamePrint("\r\tMeasured time %d = %d us\n", flashIndex + 1, microseconds);
+
+			flashIndex++;
+			if (flashIndex < kWarpGameFlashes)
+			{
+				task->state = kWarpGameStateWaitForFlash;
+				warpTaskStartTimer(task, gameFlashDelayMilliseconds[flashIndex]);
+			}
+			else
+			{
+				task->state = kWarpGameStateResults;
+				warpTaskStartTimer(task, kWarpGameResultsDelayMilliseconds);
+			}
+
+			break;
+		}
+
+		case kWarpGameStateResults:
+		{
+			if (events & kWarpTaskEventTimer)
+			{
+				recordRound();
+				warpTaskSignal(&displayTask, kWarpDisplayEventTimeGraph);
+				task->state = kWarpGameStateShowingTimes;
+				warpTaskStartTimer(task, kWarpGameResultsDelayMilliseconds);
+			}
+
+			break;
+		}
+
+		case kWarpGameStateShowingTimes:
+		{
+			if (events & kWarpTaskEventTimer)
+			{
+				warpTaskSignal(&currentTask, kWarpCurrentEventStart);
+				task->state = kWarpGameStateMeasuringCurrent;
+			}
+
+			break;
+		}
+
+		case kWarpGameStateMeasuringCurrent:
+		{
+			if (events & kWarpGameEventCurrentDone)
+			{
+				task->state = kWarpGameStateTimeGraph;
+			}
+
+			break;
+		}
+
+		case kWarpGameStateTimeGraph:
+		{
+			if (chord)
+			{
+				for (int x = 0; x < kWarpGameBins; x++)
+				{
+					timeArray[x] = 0;
+				}
+				gamePrint("\r\tCleared history\n");
+				warpTaskSignal(&displayTask, kWarpDisplayEventHistoryCleared);
+				showCurrentGraph(task);
+			}
+			else if (onboardPress)
+			{
+				showCurrentGraph(task);
+			}
+
+			break;
+		}
+
+		case kWarpGameStateCurrentGraph:
+		{
+			if (onboardPress || chord)
+			{
+				startRound(task);
+			}
+
+			break;
+		}
+	}
+}
+
+static void
+recordCurrentSample(int16_t raw)
 {
-	latch = 1;
-	int i = 0;
-	while (latch == 1 && i < 1500)		//i is the counter which increments every time delay period (1ms)
+	int32_t		currentMeasurement = warpFixedPointConvert(raw, kWarpFixedPointScaleINA219CurrentMicroamps);	//100uA per LSB with the calibration from configureSensorINA219()
+
+#ifdef WARP_BUILD_ENABLE_TELEMETRY
+	warpTelemetryWrite(kWarpTelemetryRecordINA219Current, (uint32_t)warpTimeNowUs(), &raw, 1);
+#else
+	SEGGER_RTT_printf(0, "\r%d\n", currentMeasurement);
+#endif
+	currentSum += currentMeasurement;
+	currentSamplesTaken++;
+
+	//values outside the histogram's range are assumed to be outliers
+	if ((currentMeasurement >= 0) && (currentMeasurement < kWarpGameBins * kWarpGameCurrentBinMicroamps))
+	{
+		currentArray[currentMeasurement / kWarpGameCurrentBinMicroamps]++;
+	}
+}
+
+/*
+ *	Take kWarpGameCurrentSamples readings of the current through the OLED,
+ *	one per INA219 conversion, through the asynchronous I2C queue.
+ */
+static void
+currentTaskRun(WarpTask *  task, uint32_t events)
+{
+	int16_t		raw;
+
+	if (events & kWarpCurrentEventStart)
 	{
-		i = i + 1;
-		OSA_TimeDelay(1);
-		if (GPIO_DRV_ReadPinInput(kWarpPinTPS82740_VSEL1) == 0)		
+		for (int i = 0; i < kWarpGameBins; i++)
 		{
-			latch = 0;		//if the off board button is pressed, change the latch state to break from the while loop
+			currentArray[i] = 0;
 		}
+		currentSum = 0;
+		currentSamplesTaken = 0;
+		currentReadsQueued = 0;
+		currentSamplePeriodMilliseconds = conversionMicrosecondsINA219() / 1000 + 1;
+	}
+	else if (!(events & kWarpTaskEventTimer))
+	{
+		return;
+	}
+
+	while (takeSamplesINA219(&raw, 1) == 1)
+	{
+		recordCurrentSample(raw);
+	}
+
+	/*
+	 *	A read that fails on the bus just never arrives in the ring, so
+	 *	count reads queued rather than samples taken.
+	 */
+	if (currentReadsQueued < kWarpGameCurrentSamples)
+	{
+		queueSampleINA219();
+		currentReadsQueued++;
+		warpTaskStartTimer(task, currentSamplePeriodMilliseconds);
+		return;
+	}
+
+	if (currentSamplesTaken == 0)
+	{
+		gamePrint("\r\tINA219 read failed\n");
+		averageCurrent = 0;
+	}
+	else
+	{
+		averageCurrent = currentSum / currentSamplesTaken;
 	}
-	time_count = 2*i;			//experimental analysis has shown that multiplying the count by 2 gives a fairly accurate time reading
+	gamePrint("\r\taverage current = %d\n", averageCurrent);
 
-	return time_count;
+	warpTaskSignal(&gameTask, kWarpGameEventCurrentDone);
 }
-/*This is not the best way to measure time in a program but for the purposes of this project it is acceptable because:
-* - relative times are more important than absolute times because it is the change in reaction time which is of interest
-* - the average human reaction time is between 100-200ms, so granularity less than the ms scale is not required
-* If this project was taken further, a timing system which toggles GPIO pins and measures a crystal clock count could be implemented
-*/
+
+static void
+displayTaskRun(WarpTask *  task, uint32_t events)
+{
+	static int	currentBinIndicator[kWarpGameBins] = {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1};	//all 1s so that the current bars are all white
+
+	if (events & kWarpDisplayEventTimeGraph)
+	{
+		devSSD1331_axes();
+		devSSD1331_bars(timeArray, timeBinIndicator, kWarpGameBins);
+		devSSD1331_number(0x04, 0x00, averageTime, 0, "ms", kSSD1331ColorGreen);	//show this round's reaction time in the top left corner
+	}
+
+	if (events & kWarpDisplayEventHistoryCleared)
+	{
+		devSSD1331_bars(timeArray, timeBinIndicator, kWarpGameBins);	//only the bars that were showing get cleared
+	}
+
+	if (events & kWarpDisplayEventCurrentGraph)
+	{
+		devSSD1331_clearscreen();
+		devSSD1331_current_axes();
+		devSSD1331_bars(currentArray, currentBinIndicator, kWarpGameBins);
+		devSSD1331_number(0x33, 0x01, averageCurrent/10, 2, "", kSSD1331ColorWhite);	//average current in mA, next to the "mA" label
+	}
+}
+
+#ifdef WARP_BUILD_ENABLE_DATAREADY_STREAM
+typedef enum
+{
+	kWarpDataReadyStreamEventSamples	= kWarpTaskEventFirstUser << 0,
+} WarpDataReadyStreamEvent;
+
+static WarpTask		dataReadyStreamTask;
+
+/*
+ *	The streams' messages go on the telemetry channel with their samples
+ *	when it is on, tokenized like the game's.
+ */
+#ifdef WARP_BUILD_ENABLE_TELEMETRY
+#define	streamPrint(...)	warpLog(__VA_ARGS__)
+#else
+#define	streamPrint(...)	SEGGER_RTT_printf(0, __VA_ARGS__)
+#endif
+
+/*
+ *	One line per sample: record type, time (us), raw values; or one
+ *	telemetry frame of that type.
+ */
+static void
+streamRecord(WarpTelemetryRecordType type, uint32_t timeMicroseconds, const int16_t *  values, uint8_t valueCount)
+{
+#ifdef WARP_BUILD_ENABLE_TELEMETRY
+	warpTelemetryWrite(type, timeMicroseconds, values, valueCount);
+#else
+	SEGGER_RTT_printf(0, "%d, %u", type, timeMicroseconds);
+	for (uint8_t i = 0; i < valueCount; i++)
+	{
+		SEGGER_RTT_printf(0, ", %d", values[i]);
+	}
+	SEGGER_RTT_WriteString(0, "\n");
+#endif
+}
+
+static void
+streamSample(WarpDataReadySensor sensor, uint32_t timeMicroseconds, const int16_t *  values, uint8_t valueCount)
+{
+	streamRecord(kWarpTelemetryRecordDataReadyFirst + sensor, timeMicroseconds, values, valueCount);
+}
+
+/*
+ *	Each sample is timed at its data-ready edge, and is written out from
+ *	the ring record it was decoded into.
+ */
+static void
+dataReadyStreamTaskRun(WarpTask *  task, uint32_t events)
+{
+	WarpSampleRing *		samples = warpDataReadySamples();
+	const WarpSampleRecord *	record;
+
+	while ((record = warpSampleRingPeek(samples)) != NULL)
+	{
+		streamSample(record->source, record->timeMicroseconds, record->fields, record->fieldCount);
+		warpSampleRingRelease(samples);
+	}
+}
+
+#if (defined(WARP_BUILD_ENABLE_DEVMMA8451Q) && defined(WARP_BUILD_ENABLE_MMA8451Q_FIFO_STREAM)) || \
+	(defined(WARP_BUILD_ENABLE_DEVL3GD20H) && defined(WARP_BUILD_ENABLE_L3GD20H_FIFO_STREAM)) || \
+	(defined(WARP_BUILD_ENABLE_DEVBMX055) && defined(WARP_BUILD_ENABLE_BMX055_FIFO_STREAM))
+#define WARP_BUILD_ENABLE_FIFO_STREAM
+#endif
+
+#ifdef WARP_BUILD_ENABLE_FIFO_STREAM
+enum
+{
+	/*
+	 *	At 800 Hz, a watermark interrupt every 37.5 ms, leaving two samples'
+	 *	headroom for the drain to start before the FIFO overflows.
+	 */
+	kWarpMMA8451QFifoWatermark		= 30,
+
+	/*
+	 *	FTH asserts at 24 stored samples (every 30 ms at 800 Hz), leaving
+	 *	room for the MMA8451Q's drain to go first.
+	 */
+	kWarpL3GD20HFifoWatermark		= 24,
+
+	/*
+	 *	The BMX055's gyro watermark paces its rounds: every 12 ms at 1 kHz.
+	 *	Each round's accel and gyro frames share fifoStreamSamples, so at
+	 *	most half of it each; the accel FIFO's 32 frames leave ample slack.
+	 */
+	kWarpBMX055FifoWatermark		= 12,
+	kWarpBMX055FifoBatchFrames		= 16,
+
+	/*
+	 *	The deepest FIFO we drain; both hold 32 samples.
+	 */
+	kWarpFifoStreamMaxSamples		= 32,
+};
+
+typedef enum
+{
+	kWarpFifoStreamEventWatermark		= kWarpTaskEventFirstUser << 0,
+} WarpFifoStreamEvent;
+
+static WarpTask		fifoStreamTask;
+static int16_t		fifoStreamSamples[kWarpFifoStreamMaxSamples * 3];
+
+/*
+ *	Samples as dataReadyStreamTaskRun()'s, all with the time of the
+ *	watermark edge; the last sample in each batch is the newest.
+ */
+static void
+printFifoBatch(WarpDataReadySensor sensor, uint32_t edgeMicroseconds, WarpStatus status, size_t sampleCount, bool overflowed)
+{
+	if (status != kWarpStatusOK)
+	{
+		streamPrint("%d, %u, FIFO drain failed (%d)\n", kWarpTelemetryRecordDataReadyFirst + sensor, edgeMicroseconds, status);
+		return;
+	}
+
+	if (overflowed)
+	{
+		streamPrint("%d, %u, FIFO overflowed\n", kWarpTelemetryRecordDataReadyFirst + sensor, edgeMicroseconds);
+	}
+
+	for (size_t i = 0; i < sampleCount; i++)
+	{
+		streamSample(sensor, edgeMicroseconds, &fifoStreamSamples[i*3], 3);
+	}
+}
+
+#if defined(WARP_BUILD_ENABLE_DEVBMX055) && defined(WARP_BUILD_ENABLE_BMX055_FIFO_STREAM)
+/*
+ *	One kWarpTelemetryRecordBMX055NineAxis record per frame pair: accel X,
+ *	Y, Z, gyro X, Y, Z, mag X, Y, Z (all raw), the mag values repeating
+ *	until the next reading.
+ */
+static void
+printBMX055Batch(void)
+{
+	static int16_t		values[9];
+	WarpBMX055Batch		batch;
+	WarpStatus		status;
+
+	batch.accel	= &fifoStreamSamples[0];
+	batch.gyro	= &fifoStreamSamples[kWarpBMX055FifoBatchFrames * 3];
+	batch.maxFrames	= kWarpBMX055FifoBatchFrames;
+
+	status = drainFifoBMX055(&batch);
+	if (status != kWarpStatusOK)
+	{
+		streamPrint("%d, %u, FIFO drain failed (%d)\n", kWarpTelemetryRecordBMX055NineAxis, warpDataReadyEdgeMicroseconds(), status);
+		return;
+	}
+
+	if (batch.overrun)
+	{
+		streamPrint("%d, %u, FIFO overflowed\n", kWarpTelemetryRecordBMX055NineAxis, batch.firstFrameMicroseconds);
+	}
+
+	if (batch.magFresh)
+	{
+		values[6] = batch.mag[0];
+		values[7] = batch.mag[1];
+		values[8] = batch.mag[2];
+	}
+
+	for (size_t i = 0; i < batch.frameCount; i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			values[axis]		= batch.accel[i*3 + axis];
+			values[3 + axis]	= batch.gyro[i*3 + axis];
+		}
+		streamRecord(kWarpTelemetryRecordBMX055NineAxis, batch.firstFrameMicroseconds + i * batch.framePeriodMicroseconds, values, 9);
+	}
+}
+#endif
+
+/*
+ *	Any of the FIFOs on the data-ready line may have raised it, so each
+ *	edge drains them all. Each drain reads the fill level first and then
+ *	exactly that many samples in one burst.
+ */
+static void
+fifoStreamTaskRun(WarpTask *  task, uint32_t events)
+{
+	uint32_t	edgeMicroseconds = warpDataReadyEdgeMicroseconds();
+	size_t		sampleCount;
+	bool		overflowed;
+	WarpStatus	status;
+
+	#if defined(WARP_BUILD_ENABLE_DEVMMA8451Q) && defined(WARP_BUILD_ENABLE_MMA8451Q_FIFO_STREAM)
+	status = drainFifoMMA8451Q(fifoStreamSamples, kWarpFifoStreamMaxSamples, &sampleCount, &overflowed);
+	printFifoBatch(kWarpDataReadyMMA8451Q, edgeMicroseconds, status, sampleCount, overflowed);
+	#endif
+	#if defined(WARP_BUILD_ENABLE_DEVL3GD20H) && defined(WARP_BUILD_ENABLE_L3GD20H_FIFO_STREAM)
+	status = drainFifoL3GD20H(fifoStreamSamples, kWarpFifoStreamMaxSamples, &sampleCount, &overflowed);
+	printFifoBatch(kWarpDataReadyL3GD20H, edgeMicroseconds, status, sampleCount, overflowed);
+	#endif
+	#if defined(WARP_BUILD_ENABLE_DEVBMX055) && defined(WARP_BUILD_ENABLE_BMX055_FIFO_STREAM)
+	printBMX055Batch();
+	#endif
+
+	warpDataReadyRelease();
+}
+#endif
+
+static void
+startDataReadyStream(uint16_t i2cPullupValue)
+{
+	#if defined(WARP_BUILD_ENABLE_DEVMMA8451Q) && defined(WARP_BUILD_ENABLE_MMA8451Q_FIFO_STREAM)
+	configureFifoMMA8451Q(kWarpMMA8451QFifoWatermark,
+				0x01,/* Normal read 8bit, 800Hz, normal, active mode */
+				i2cPullupValue
+				);
+	#elif defined(WARP_BUILD_ENABLE_DEVMMA8451Q)
+	configureSensorMMA8451Q(0x00,/* Payload: Disable FIFO */
+				0x01,/* Normal read 8bit, 800Hz, normal, active mode */
+				i2cPullupValue
+				);
+	configureDataReadyMMA8451Q(0x01, i2cPullupValue);
+	warpDataReadyAddSensor(kWarpDataReadyMMA8451Q, &dataReadySourceMMA8451Q);
+	#endif
+	#ifdef WARP_BUILD_ENABLE_DEVL3GD20H
+	configureSensorL3GD20H(	0b11111111,/* ODR 800Hz, Cut-off 100Hz, see table 21, normal mode, x,y,z enable */
+				0b00100000,
+				0b00000000,/* normal mode, disable FIFO, disable high pass filter */
+				i2cPullupValue
+				);
+	#ifdef WARP_BUILD_ENABLE_L3GD20H_FIFO_STREAM
+	configureFifoL3GD20H(kWarpL3GD20HFifoModeStream, kWarpL3GD20HFifoWatermark, i2cPullupValue);
+	#else
+	configureDataReadyL3GD20H(i2cPullupValue);
+	warpDataReadyAddSensor(kWarpDataReadyL3GD20H, &dataReadySourceL3GD20H);
+	#endif
+	#endif
+	#ifdef WARP_BUILD_ENABLE_DEVBMX055
+	configureSensorBMX055accel(0b00000011,/* Payload:+-2g range */
+				0b10000000,/* Payload:unfiltered data, shadowing enabled */
+				i2cPullupValue
+				);
+	configureSensorBMX055gyro(0b00000100,/* +- 125degrees/s */
+				0b00000000,/* ODR 2000 Hz, unfiltered */
+				0b00000000,/* normal mode */
+				0b10000000,/* unfiltered data, shadowing enabled */
+				i2cPullupValue
+				);
+	#ifdef WARP_BUILD_ENABLE_BMX055_FIFO_STREAM
+	configureFifoBMX055(kWarpBMX055FifoWatermark, i2cPullupValue);
+	#else
+	configureDataReadyBMX055accel(i2cPullupValue);
+	warpDataReadyAddSensor(kWarpDataReadyBMX055accel, &dataReadySourceBMX055accel);
+	configureDataReadyBMX055gyro(i2cPullupValue);
+	warpDataReadyAddSensor(kWarpDataReadyBMX055gyro, &dataReadySourceBMX055gyro);
+	#endif
+	#endif
+
+	#ifdef WARP_BUILD_ENABLE_FIFO_STREAM
+	warpSchedulerAddTask(&fifoStreamTask, fifoStreamTaskRun);
+	warpDataReadyWatch(&fifoStreamTask, kWarpFifoStreamEventWatermark);
+	#endif
+
+	warpSchedulerAddTask(&dataReadyStreamTask, dataReadyStreamTaskRun);
+	warpDataReadyInit(&dataReadyStreamTask, kWarpDataReadyStreamEventSamples);
+}
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1149,6 +1904,9 @@ main(void)
 	 *	we might have SWD disabled at time of blockage.
 	 */
 	SEGGER_RTT_ConfigUpBuffer(0, NULL, NULL, 0, SEGGER_RTT_MODE_NO_BLOCK_TRIM);
+#ifdef WARP_BUILD_ENABLE_TELEMETRY
+	warpTelemetryInit();
+#endif
 
 
 	SEGGER_RTT_WriteString(0, "\n\n\n\rBooting Warp, in 3... ");
@@ -1231,6 +1989,15 @@ main(void)
 
 
 
+	/*
+	 *	Move the OSA's LPTMR onto the 32.768 kHz clock the RTC now runs from,
+	 *	for a microsecond-resolution timebase, and let OSA_TimeDelay() sleep
+	 *	now that the power manager is set up (see warp-kl03-ksdk1.1-time.c).
+	 */
+	warpTimeInit();
+
+
+
 	/*
 	 *	Switch CPU to Very Low Power Run (VLPR) mode
 	 */
@@ -1254,23 +2021,6 @@ main(void)
 
 
 
-	/*
-	 *	Toggle LED3 (kWarpPinSI4705_nRST)
-	 */
-	GPIO_DRV_SetPinOutput(kWarpPinSI4705_nRST);
-	OSA_TimeDelay(200);
-	GPIO_DRV_ClearPinOutput(kWarpPinSI4705_nRST);
-	OSA_TimeDelay(200);
-	GPIO_DRV_SetPinOutput(kWarpPinSI4705_nRST);
-	OSA_TimeDelay(200);
-	GPIO_DRV_ClearPinOutput(kWarpPinSI4705_nRST);
-	OSA_TimeDelay(200);
-	GPIO_DRV_SetPinOutput(kWarpPinSI4705_nRST);
-	OSA_TimeDelay(200);
-	GPIO_DRV_ClearPinOutput(kWarpPinSI4705_nRST);
-
-
-
 	/*
 	 *	Initialize all the sensors
 	 */
@@ -1396,367 +2146,49 @@ main(void)
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	devSSD1331init();		//initialise OLED module
-	int time_count = 0;		
-	int t1;
-	int t2;
-	int t3;
-	int reset_latch;
-	int average_time;
-	int time_array[16] = {0};	//there will be 15 time bins between 0ms and 300ms (20ms each), and one time bin for reaction times over 300ms
-	
-	//variables for INA219 current measurement
-	uint16_t readSensorRegisterValueLSB;
-	uint16_t readSensorRegisterValueMSB;
-	int16_t	readSensorRegisterValueCombined;
-	int16_t	currentMeasurement;
-	
-	int n = 100;	//number of current measurements to make
-	int averageCurrent = 0;
-	while (1)
-	{
-		
-		int time_bin_indicator[16] = {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1};	//this array is used to indicate which time bin the latest result falls in (by changing to 0)
-		int current_array[16] = {0};			//this array stores the number of times the current falls in a specified range
-		
-		enableI2Cpins(menuI2cPullupValue);
-		
-		//gather three readings of reaction time by flashing a white screen and measuring how long it takes to press the button after
-		SEGGER_RTT_printf(0, "\r\tPrepare for flash\n");
-		devSSD1331_countdown();		//call the 3, 2, 1 countdown fcn in devSSD1331.c
-		OSA_TimeDelay(1500);		//delay times before flashes vary so that reaction time is better tested
-		
-		devSSD1331_flash(10);		//call the flash fcn in devSSD1331.c, and flash for 10ms
-		t1 = measure_time();		//call the fcn outside the main loop which measures time
-		SEGGER_RTT_printf(0, "\r\tMeasured time 1 = %d ms\n", t1);
-		OSA_TimeDelay(2500);
-		
-		devSSD1331_flash(10);
-		t2 = measure_time();
-		SEGGER_RTT_printf(0, "\r\tMeasured time 1 = %d ms\n", t2);
-		OSA_TimeDelay(1700);
-		
-		devSSD1331_flash(10);
-		t3 = measure_time();
-		SEGGER_RTT_printf(0, "\r\tMeasured time 1 = %d ms\n", t3);
-		
-		//find an average of the three reaction times
-		average_time = (t1 + t2 + t3)/3;
-		
-		OSA_TimeDelay(200);
-		
-		SEGGER_RTT_printf(0, "\r\tAverage time = %d ms\n", average_time);
-		
-		//depending on what time bin (range) the result falls in, increment the frequency in the corresponding time_array bin and set the corresponding time_bin_indicator to 0
-		switch(average_time)
-		{
-				case 0 ... 19:
-				{
-					time_bin_indicator[0] = 0;
-					time_array[0] ++;
-					SEGGER_RTT_printf(0, "\r\t0 - 19 = %d\n", time_array[0]);
-					break;
-				}
-
-				case 20 ... 39:
-				{
-					time_bin_indicator[1] = 0;
-					time_array[1] ++;
-					SEGGER_RTT_printf(0, "\r\t20 - 39 = %d\n", time_array[1]);
-					break;
-				}
-				
-				case 40 ... 59:
-				{
-					time_bin_indicator[2] = 0;
-					time_array[2] ++;
-					SEGGER_RTT_printf(0, "\r\t40 - 59 = %d\n", time_array[2]);
-					break;
-				}
-
-				case 60 ... 79:
-				{
-					time_bin_indicator[3] = 0;
-					time_array[3] ++;
-					SEGGER_RTT_printf(0, "\r\t60 - 79 = %d\n", time_array[3]);
-					break;
-				}
-
-				case 80 ... 99:
-				{
-					time_bin_indicator[4] = 0;
-					time_array[4] ++;
-					SEGGER_RTT_printf(0, "\r\t80 - 99 = %d\n", time_array[4]);
-					break;
-				}
-				
-				case 100 ... 119:
-				{
-					time_bin_indicator[5] = 0;
-					time_array[5] ++;
-					SEGGER_RTT_printf(0, "\r\t100 - 119 = %d\n", time_array[5]);
-					break;
-				}
-
-				case 120 ... 139:
-				{
-					time_bin_indicator[6] = 0;
-					time_array[6] ++;
-					SEGGER_RTT_printf(0, "\r\t120 - 139 = %d\n", time_array[6]);
-					break;
-				}
-				
-				case 140 ... 159:
-				{
-					time_bin_indicator[7] = 0;
-					time_array[7] ++;
-					SEGGER_RTT_printf(0, "\r\t140 - 159 = %d\n", time_array[7]);
-					break;
-				}
-
-				case 160 ... 179:
-				{
-					time_bin_indicator[8] = 0;
-					time_array[8] ++;
-					SEGGER_RTT_printf(0, "\r\t160 - 179 = %d\n", time_array[8]);
-					break;
-				}
-
-				case 180 ... 199:
-				{
-					time_bin_indicator[9] = 0;
-					time_array[9] ++;
-					SEGGER_RTT_printf(0, "\r\t180 - 199 = %d\n", time_array[9]);
-					break;
-				}
-				
-				case 200 ... 219:
-				{
-					time_bin_indicator[10] = 0;
-					time_array[10] ++;
-					SEGGER_RTT_printf(0, "\r\t200 - 219 = %d\n", time_array[10]);
-					break;
-				}
-
-				case 220 ... 239:
-				{
-					time_bin_indicator[11] = 0;
-					time_array[11] ++;
-					SEGGER_RTT_printf(0, "\r\t220 - 239 = %d\n", time_array[11]);
-					break;
-				}
-				
-				case 240 ... 259:
-				{
-					time_bin_indicator[12] = 0;
-					time_array[12] ++;
-					SEGGER_RTT_printf(0, "\r\t240 - 259 = %d\n", time_array[12]);
-					break;
-				}
-
-				case 260 ... 279:
-				{
-					time_bin_indicator[13] = 0;
-					time_array[13] ++;
-					SEGGER_RTT_printf(0, "\r\t260 - 279 = %d\n", time_array[13]);
-					break;
-				}
-
-				case 280 ... 299:
-				{
-					time_bin_indicator[14] = 0;
-					time_array[14] ++;
-					SEGGER_RTT_printf(0, "\r\t280 - 299 = %d\n", time_array[14]);
-					break;
-				}
-				
-				case 300 ... 3000:
-				{
-					time_bin_indicator[15] = 0;
-					time_array[15] ++;
-					SEGGER_RTT_printf(0, "\r\t300 plus = %d\n", time_array[15]);
-					break;
-				}
-	
-				default:
-				{
-					SEGGER_RTT_printf(0, "\r\tThis shouldn't happen\n");
-					break;
-				}
-		}
-		
-		//print frequency count for all bins
-		SEGGER_RTT_printf(0, "\r\n0-19 = %d, 20-39 = %d, 40-59 = %d, 60-79 = %d, 80-99 = %d, 100-119 = %d, 120-139 = %d, 140-159 = %d, 160-179 = %d, 180-199 %d, 200-219 = %d, 220-239 = %d, 240-259 = %d, 260-279 = %d, 280-299 = %d, 300 plus = %d\n\n", time_array[0], time_array[1], time_array[2], time_array[3], time_array[4], time_array[5], time_array[6], time_array[7], time_array[8], time_array[9], time_array[10], time_array[11], time_array[12], time_array[13], time_array[14], time_array[15]);
-	
-		
-		devSSD1331_axes();	//call the function which plots the axes on the OLED screen
-		devSSD1331_bars(time_array, time_bin_indicator, 16);	//plot the bars onto the axes
-		
-		OSA_TimeDelay(200);
-		
-		int k = 0;
-		int currentSum = 0;
-		//collect n measurements of the current through the OLED
-		while(k < n)
-		{
-			//code to measure the amount of current consumed by the OLED
-			writeSensorRegisterINA219(0x01,0x00,1);		//need to write to the register that you want to access
-			readSensorRegisterINA219(2);			//only parameter is number of bytes to read as the address is determined by previous line
-			readSensorRegisterValueMSB = deviceINA219State.i2cBuffer[0];
-			readSensorRegisterValueLSB = deviceINA219State.i2cBuffer[1];
-			readSensorRegisterValueCombined = ((readSensorRegisterValueMSB & 0xFF) << 8) | (readSensorRegisterValueLSB & 0xFF);	//combine the two bytes to a 16 bit value
-			currentMeasurement = (readSensorRegisterValueCombined*10)/0.1; 	//I = Vshunt/Rshunt = registerValue*10uVresolution/0.1ohmShunt
-			SEGGER_RTT_printf(0,"\r%d\n", currentMeasurement);	//print current measurement to screen
-			
-			//add measurement to the sum measurement so an average can be found later
-			currentSum += currentMeasurement;
-			
-			//depending on what time bin (range) the result falls in, increment the frequency in the corresponding time_array bin and set the corresponding time_bin_indicator to 0
-			switch(currentMeasurement)
-			{
-					case 0 ... 999:
-					{
-						current_array[0] ++;
-						break;
-					}
-
-					case 1000 ... 1999:
-					{
-						current_array[1] ++;
-						break;
-					}
-
-					case 2000 ... 2999:
-					{
-						current_array[2] ++;
-						break;
-					}
-
-					case 3000 ... 3999:
-					{
-						current_array[3] ++;
-						break;
-					}
-
-					case 4000 ... 4999:
-					{
-						current_array[4] ++;
-						break;
-					}
-
-					case 5000 ... 5999:
-					{
-						current_array[5] ++;
-						break;
-					}
-
-					case 6000 ... 6999:
-					{
-						current_array[6] ++;
-						break;
-					}
-
-					case 7000 ... 7999:
-					{
-						current_array[7] ++;
-						break;
-					}
-
-					case 8000 ... 8999:
-					{
-						current_array[8] ++;
-						break;
-					}
-
-					case 9000 ... 9999:
-					{
-						current_array[9] ++;
-						break;
-					}
-
-					case 10000 ... 10999:
-					{
-						current_array[10] ++;
-						break;
-					}
-
-					case 11000 ... 11999:
-					{
-						current_array[11] ++;
-						break;
-					}
-
-					case 12000 ... 12999:
-					{
-						current_array[12] ++;
-						break;
-					}
-
-					case 13000 ... 13999:
-					{
-						current_array[13] ++;
-						break;
-					}
+#ifdef WARP_BUILD_ENABLE_DEVIS25WP128
+	/*
+	 *	The flash uses the SPI bus as devSSD1331init() left it.
+	 */
+	initIS25WP128(&deviceIS25WP128State);
+#endif
+#ifdef WARP_BUILD_ENABLE_SSD1331_BENCHMARK
+	devSSD1331_benchmark();
+#endif
+#ifdef WARP_BUILD_ENABLE_CSV_BENCHMARK
+	warpCsvBenchmark();
+#endif
+#ifdef WARP_BUILD_ENABLE_FIXEDPOINT_BENCHMARK
+	warpFixedPointBenchmark();
+#endif
+	/*
+	 *	Configuration and calibration are written once; each current
+	 *	measurement is then a single read of the Current register.
+	 */
+	enableI2Cpins(menuI2cPullupValue);
+	configureSensorINA219(kWarpINA219Averaging1);
 
-					case 14000 ... 14999:
-					{
-						current_array[14] ++;
-						break;
-					}
+	/*
+	 *	The reaction timer's TPM0 runs from the HIRC, which only runs in
+	 *	RUN, so leave VLPR before the first round.
+	 */
+	warpSetLowPowerMode(kWarpPowerModeRUN, 0 /* sleep seconds : irrelevant here */);
 
-					case 15000 ... 15999:
-					{
-						current_array[15] ++;
-						break;
-					}
+	warpSchedulerAddTask(&gameTask, gameTaskRun);
+	warpSchedulerAddTask(&currentTask, currentTaskRun);
+	warpSchedulerAddTask(&displayTask, displayTaskRun);
+	warpButtonsInit(&gameTask, kWarpGameEventButtons);
+#ifdef WARP_BUILD_ENABLE_DATAREADY_STREAM
+	startDataReadyStream(menuI2cPullupValue);
+#endif
+	warpTaskSignal(&gameTask, kWarpGameEventNewRound);
+	warpSchedulerRun();
+	/*
+	 *	Notreached
+	 */
 
-					default:
-					{
-						//assume all other values outside the above range are outliers
-						break;
-					}
-			}
-			
-			k = k + 1;
-		}
-		
-		//calculate and display the average current
-		averageCurrent = currentSum/n;
-		SEGGER_RTT_printf(0,"\r\taverage current = %d\n", averageCurrent);	//print average current measurement to screen
-		
-		reset_latch = 0;
-		
-		//this while loop holds the position in code until the on board button is pressed
-		while (GPIO_DRV_ReadPinInput(kWarpPinTPS82740_VSEL3) != 0)
-		{	
-			//if the off board button, then the on board button is pressed simultaneously, the data history will be cleared
-			if(GPIO_DRV_ReadPinInput(kWarpPinTPS82740_VSEL1) == 0 && reset_latch == 0)
-			{
-				if(GPIO_DRV_ReadPinInput(kWarpPinTPS82740_VSEL3) == 0)
-				{
-					reset_latch = 1;
-					for(int x = 0; x < 16; x ++)
-    					{
-						time_array[x] = 0;
-						/*Reset each time array entry to 0*/
-    					}
-					SEGGER_RTT_printf(0, "\r\tCleared history\n");
-				}
-			}
-		}
-		
-		int current_bin_indicator[16] = {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1}; 	//create array of 1s to pass into the bar plotting function so that they are all white
-		
-		//clear the screen and return to the start of the loop to repeat the test
-		SEGGER_RTT_printf(0, "\r\tEscape graphing\n");
-		devSSD1331_clearscreen();
-		devSSD1331_current_axes();	//call the function which plots the current axes on the OLED screen
-		devSSD1331_bars(current_array, current_bin_indicator, 16);	//plot the bars onto the axes
-		
-		//this while loop holds the position in code until the on board button is pressed
-		while (GPIO_DRV_ReadPinInput(kWarpPinTPS82740_VSEL3) != 0)
-		{	
-			//hold position in code
-		}
+	while (1)
+	{
 
 		
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3155,7 +3587,7 @@ printAllSensors(bool printHeadersAndCalibration, bool hexModeFlag, int menuDelay
 
 	if (printHeadersAndCalibration)
 	{
-		SEGGER_RTT_WriteString(0, "Measurement number, RTC->TSR, RTC->TPR,");
+		SEGGER_RTT_WriteString(0, "Measurement number, Start time (us),");
 		OSA_TimeDelay(gWarpMenuPrintDelayMilliseconds);
 
 		#ifdef WARP_BUILD_ENABLE_DEVAMG8834
@@ -3202,46 +3634,103 @@ printAllSensors(bool printHeadersAndCalibration, bool hexModeFlag, int menuDelay
 		SEGGER_RTT_WriteString(0, " HDC1000 Temp, HDC1000 Hum,");
 		OSA_TimeDelay(gWarpMenuPrintDelayMilliseconds);
 		#endif
-		SEGGER_RTT_WriteString(0, " RTC->TSR, RTC->TPR, # Config Errors");
-		OSA_TimeDelay(gWarpMenuPrintDelayMilliseconds);
-		SEGGER_RTT_WriteString(0, "\n\n");
+		SEGGER_RTT_WriteString(0, " End time (us), # Config Errors");
 		OSA_TimeDelay(gWarpMenuPrintDelayMilliseconds);
 	}
 
 
-	while(1)
+	/*
+	 *	Each sensor is read at its own output data rate, as configured
+	 *	above, or as close to it as the I2C bus allows. A row is printed
+	 *	for each round of the sampler, and the fields of sensors that were
+	 *	not due in it are left empty. Each row ends with every sensor's
+	 *	count of missed samples, so falling behind shows in the log.
+	 */
+	WarpSamplerSensor	sensors[] =
 	{
-		#ifdef WARP_BUILD_ENABLE_SEGGER_RTT_PRINTF
-		SEGGER_RTT_printf(0, "%u, %d, %d,", readingCount, RTC->TSR, RTC->TPR);
-		#endif
-
 		#ifdef WARP_BUILD_ENABLE_DEVAMG8834
-		printSensorDataAMG8834(hexModeFlag);
+		{"AMG8834",	1 /* Hz */,	65,	NULL,				printSensorDataAMG8834},
 		#endif
 		#ifdef WARP_BUILD_ENABLE_DEVMMA8451Q
-		printSensorDataMMA8451Q(hexModeFlag);
+		{"MMA8451Q",	800 /* Hz */,	3,	queueSensorSampleMMA8451Q,	printSensorSampleMMA8451Q},
 		#endif
 		#ifdef WARP_BUILD_ENABLE_DEVMAG3110
-		printSensorDataMAG3110(hexModeFlag);
+		{"MAG3110",	80 /* Hz */,	4,	queueSensorSampleMAG3110,	printSensorSampleMAG3110},
 		#endif
 		#ifdef WARP_BUILD_ENABLE_DEVL3GD20H
-		printSensorDataL3GD20H(hexModeFlag);
+		{"L3GD20H",	800 /* Hz */,	4,	queueSensorSampleL3GD20H,	printSensorSampleL3GD20H},
 		#endif
 		#ifdef WARP_BUILD_ENABLE_DEVBME680
-		printSensorDataBME680(hexModeFlag);
+		{"BME680",	1 /* Hz */,	3,	NULL,				printSensorDataBME680},
 		#endif
 		#ifdef WARP_BUILD_ENABLE_DEVBMX055
-		printSensorDataBMX055accel(hexModeFlag);
-		printSensorDataBMX055mag(hexModeFlag);
-		printSensorDataBMX055gyro(hexModeFlag);
+		{"BMX055acc",	2000 /* Hz */,	4,	queueSensorSampleBMX055accel,	printSensorSampleBMX055accel},
+		{"BMX055mag",	10 /* Hz */,	4,	queueSensorSampleBMX055mag,	printSensorSampleBMX055mag},
+		{"BMX055gyro",	2000 /* Hz */,	3,	queueSensorSampleBMX055gyro,	printSensorSampleBMX055gyro},
 		#endif
 		#ifdef WARP_BUILD_ENABLE_DEVCCS811
-		printSensorDataCCS811(hexModeFlag);
+		{"CCS811",	4 /* Hz */,	3,	NULL,				printSensorDataCCS811},
 		#endif
 		#ifdef WARP_BUILD_ENABLE_DEVHDC1000
-		printSensorDataHDC1000(hexModeFlag);
+		{"HDC1000",	1 /* Hz */,	2,	NULL,				printSensorDataHDC1000},
 		#endif
-		
+	};
+
+	warpSamplerInit(sensors, sizeof(sensors) / sizeof(sensors[0]), menuDelayBetweenEachRun > 0 ? menuDelayBetweenEachRun : 0);
+
+	if (printHeadersAndCalibration)
+	{
+		for (size_t i = 0; i < sizeof(sensors) / sizeof(sensors[0]); i++)
+		{
+			#ifdef WARP_BUILD_ENABLE_SEGGER_RTT_PRINTF
+			SEGGER_RTT_printf(0, ", %s missed (%d of %d Hz)", sensors[i].name, sensors[i].sampledRateHz, sensors[i].rateHz);
+			OSA_TimeDelay(gWarpMenuPrintDelayMilliseconds);
+			#endif
+		}
+		SEGGER_RTT_WriteString(0, "\n\n");
+		OSA_TimeDelay(gWarpMenuPrintDelayMilliseconds);
+	}
+
+	while(1)
+	{
+		/*
+		 *	Submits the round's queued reads as one burst: the I2C interrupt
+		 *	runs them back-to-back while we format and print, and each
+		 *	printSensorSample...() waits only for its own transaction.
+		 */
+		warpSamplerNextRound();
+
+		/*
+		 *	The drivers append their fields to the row (see
+		 *	warp-kl03-ksdk1.1-csv.c), which goes out in one write.
+		 */
+		#ifdef WARP_BUILD_ENABLE_SEGGER_RTT_PRINTF
+		warpCsvUnsigned(readingCount);
+		warpCsvUnsigned((uint32_t)warpTimeNowUs());
+		#endif
+
+		for (size_t i = 0; i < sizeof(sensors) / sizeof(sensors[0]); i++)
+		{
+			if (!sensors[i].due)
+			{
+				for (int j = 0; j < sensors[i].columns; j++)
+				{
+					warpCsvEmpty();
+				}
+				continue;
+			}
+
+			/*
+			 *	The synchronous drivers use blocking KSDK transfers, which
+			 *	fail while the queue owns the bus.
+			 */
+			if (sensors[i].queueSample == NULL)
+			{
+				warpI2cWaitIdle();
+			}
+			sensors[i].printSample(hexModeFlag);
+		}
+
 		/*
 		#ifdef WARP_BUILD_ENABLE_DEVINA219
 		printSensorDataINA219(hexModeFlag);
@@ -3249,13 +3738,14 @@ printAllSensors(bool printHeadersAndCalibration, bool hexModeFlag, int menuDelay
 		*/
 
 		#ifdef WARP_BUILD_ENABLE_SEGGER_RTT_PRINTF
-		SEGGER_RTT_printf(0, " %d, %d, %d\n", RTC->TSR, RTC->TPR, numberOfConfigErrors);
-		#endif
-
-		if (menuDelayBetweenEachRun > 0)
+		warpCsvUnsigned((uint32_t)warpTimeNowUs());
+		warpCsvInt(numberOfConfigErrors);
+		for (size_t i = 0; i < sizeof(sensors) / sizeof(sensors[0]); i++)
 		{
-			OSA_TimeDelay(menuDelayBetweenEachRun);
+			warpCsvUnsigned(sensors[i].missedSamples);
 		}
+		#endif
+		warpCsvEndRow();
 
 		readingCount++;
 	}
@@ -4236,11 +4726,9 @@ activateAllLowPowerSensorModes(bool verbose)
 	/*
 	 *	SI4705: Send a POWER_DOWN command (byte 0x17). See AN332 page 124 and page 132.
 	 *
-	 *	For now, simply hold its reset line low.
+	 *	Its reset line (PTB7) is now the sensors' data-ready input, so it
+	 *	can no longer be held low here.
 	 */
-#ifdef WARP_BUILD_ENABLE_DEVSI4705
-	GPIO_DRV_ClearPinOutput(kWarpPinSI4705_nRST);
-#endif
 
 
 
@@ -0,0 +1,203 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "fsl_device_registers.h"
+#include "fsl_interrupt_manager.h"
+#include "fsl_port_hal.h"
+#include "fsl_gpio_driver.h"
+
+#include "gpio_pins.h"
+#include "warp.h"
+
+
+/*
+ *	Interrupt-driven button input. The on board button (PTB5, IRQ_12)
+ *	interrupts on both edges; each edge is timestamped from the timebase
+ *	and debounced in PORTB_IRQHandler(), and accepted presses and releases
+ *	are queued as WarpButtonEvents for a subscriber task. Between presses
+ *	nothing polls, so the core can sleep (in VLPS, from which the PORT
+ *	interrupt wakes it).
+ *
+ *	PTA5 (the off board button) has no interrupt function on the KL03, so
+ *	it cannot raise events itself: we read it when an on board press is
+ *	accepted, and report that press as a chord if it is held. While the
+ *	reaction timer runs, TPM0 captures its edges instead.
+ */
+enum
+{
+	kWarpButtonsOnboardPin			= 5,
+	kWarpButtonsDebounceMicroseconds	= 20000,
+	kWarpButtonsEventRingLength		= 8,
+};
+
+typedef enum
+{
+	kWarpButtonsServiceEventRecheck		= kWarpTaskEventFirstUser << 0,
+} WarpButtonsServiceEvent;
+
+static WarpButtonEvent		eventRing[kWarpButtonsEventRingLength];
+static volatile uint8_t		eventRingHead;
+static volatile uint8_t		eventRingTail;
+static volatile uint32_t	eventRingOverruns;
+
+static WarpTask *		subscriberTask;
+static uint32_t			subscriberEvents;
+static WarpTask			serviceTask;
+
+static volatile bool		onboardPressed;
+static volatile uint64_t	lastChangeMicroseconds;
+static volatile uint64_t	lastEdgeMicroseconds;
+
+
+static bool
+onboardPinPressed(void)
+{
+	return GPIO_DRV_ReadPinInput(kWarpPinTPS82740_VSEL3) == 0;
+}
+
+/*
+ *	Call with interrupts masked.
+ */
+static void
+acceptChange(bool pressed, uint64_t timeMicroseconds)
+{
+	WarpButtonEvent *	event;
+
+	onboardPressed		= pressed;
+	lastChangeMicroseconds	= timeMicroseconds;
+
+	if ((uint8_t)(eventRingHead - eventRingTail) == kWarpButtonsEventRingLength)
+	{
+		eventRingOverruns++;
+		return;
+	}
+
+	event = &eventRing[eventRingHead & (kWarpButtonsEventRingLength - 1)];
+	event->button		= kWarpButtonOnboard;
+	event->timeMicroseconds	= timeMicroseconds;
+	if (!pressed)
+	{
+		event->type = kWarpButtonEventRelease;
+	}
+	else if (GPIO_DRV_ReadPinInput(kWarpPinTPS82740_VSEL1) == 0)
+	{
+		event->type = kWarpButtonEventChord;
+	}
+	else
+	{
+		event->type = kWarpButtonEventPress;
+	}
+	eventRingHead++;
+
+	warpTaskSignal(subscriberTask, subscriberEvents);
+}
+
+/*
+ *	The first edge that changes the state is accepted at once, with its
+ *	timestamp; edges in the following 20 ms are contact bounce and are
+ *	ignored. Since the last of those may leave the pin in the other state
+ *	(a tap shorter than the debounce window), serviceTaskRun() looks at the
+ *	pin again once the window has passed.
+ */
+void
+PORTB_IRQHandler(void)
+{
+	uint64_t	now;
+
+	/*
+	 *	PORTB also carries the sensors' data-ready line.
+	 */
+	if (PORT_HAL_IsPinIntPending(PORTB_BASE, GPIO_EXTRACT_PIN(kWarpPinSensorDataReady)))
+	{
+		warpDataReadyPinInterrupt();
+	}
+
+	if (!PORT_HAL_IsPinIntPending(PORTB_BASE, kWarpButtonsOnboardPin))
+	{
+		return;
+	}
+
+	PORT_HAL_ClearPinIntFlag(PORTB_BASE, kWarpButtonsOnboardPin);
+	now = warpTimeNowUs();
+	lastEdgeMicroseconds = now;
+
+	if (now - lastChangeMicroseconds < kWarpButtonsDebounceMicroseconds)
+	{
+		warpTaskSignal(&serviceTask, kWarpButtonsServiceEventRecheck);
+		return;
+	}
+
+	if (onboardPinPressed() != onboardPressed)
+	{
+		acceptChange(!onboardPressed, now);
+	}
+}
+
+static void
+serviceTaskRun(WarpTask *  task, uint32_t events)
+{
+	uint64_t	settledMicroseconds;
+	uint64_t	now = warpTimeNowUs();
+
+	INT_SYS_DisableIRQGlobal();
+	settledMicroseconds = lastChangeMicroseconds + kWarpButtonsDebounceMicroseconds;
+	INT_SYS_EnableIRQGlobal();
+
+	if ((events & kWarpButtonsServiceEventRecheck) && (now < settledMicroseconds))
+	{
+		warpTaskStartTimer(task, (settledMicroseconds - now + 999) / 1000);
+		return;
+	}
+
+	INT_SYS_DisableIRQGlobal();
+	if (onboardPinPressed() != onboardPressed)
+	{
+		acceptChange(!onboardPressed, lastEdgeMicroseconds);
+	}
+	INT_SYS_EnableIRQGlobal();
+}
+
+/*
+ *	Start the button service. subscriberEventFlags are raised on subscriber
+ *	whenever events are queued; take them with warpButtonsTakeEvent().
+ */
+void
+warpButtonsInit(WarpTask *  subscriber, uint32_t subscriberEventFlags)
+{
+	subscriberTask		= subscriber;
+	subscriberEvents	= subscriberEventFlags;
+	warpSchedulerAddTask(&serviceTask, serviceTaskRun);
+
+	INT_SYS_DisableIRQGlobal();
+	onboardPressed		= onboardPinPressed();
+	lastChangeMicroseconds	= warpTimeNowUs();
+	INT_SYS_EnableIRQGlobal();
+
+	PORT_HAL_ClearPinIntFlag(PORTB_BASE, kWarpButtonsOnboardPin);
+	PORT_HAL_SetPinIntMode(PORTB_BASE, kWarpButtonsOnboardPin, kPortIntEitherEdge);
+	INT_SYS_EnableIRQ(PORTB_IRQn);
+}
+
+bool
+warpButtonsTakeEvent(WarpButtonEvent *  event)
+{
+	if (eventRingTail == eventRingHead)
+	{
+		return false;
+	}
+
+	*event = eventRing[eventRingTail & (kWarpButtonsEventRingLength - 1)];
+	eventRingTail++;
+
+	return true;
+}
+
+/*
+ *	Events dropped because the subscriber did not take them in time.
+ */
+uint32_t
+warpButtonsEventOverruns(void)
+{
+	return eventRingOverruns;
+}
@@ -0,0 +1,275 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "fsl_device_registers.h"
+
+#include "SEGGER_RTT.h"
+#include "warp.h"
+
+
+/*
+ *	CSV rows for printAllSensors(). SEGGER_RTT_printf() parses its format
+ *	string and converts each number a digit at a time, with a division per
+ *	digit, which the Cortex-M0+ (no divide instruction) does in software;
+ *	and each call is a separate write to the up-buffer. Here the drivers
+ *	append their fields to a row in RAM instead, as " value,", and
+ *	warpCsvEndRow() writes the row with one SEGGER_RTT_Write(). Numbers are
+ *	converted two digits at a time, from a table, dividing by 100 with a
+ *	multiply by its reciprocal.
+ *
+ *	A row longer than kWarpCsvRowBytes (e.g., with the AMG8834's 64 pixels)
+ *	goes out in more than one write. Call from task context only.
+ */
+enum
+{
+	kWarpCsvRowBytes		= 128,
+	kWarpCsvMaxFieldBytes		= 24,
+	kWarpCsvBenchmarkRows		= 8,
+	kWarpCsvBenchmarkFields		= 16,
+};
+
+static const char	digitPairs[200] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const char	hexDigits[16] = "0123456789abcdef";
+
+static char		row[kWarpCsvRowBytes];
+static size_t		rowBytes;
+static bool		rowStarted;
+
+
+/*
+ *	value / 100 without a division: (value * 5243) >> 19 is exact below
+ *	43699 and needs only a 32-bit multiply, which covers most sensor
+ *	readings; above that, (value * 1374389535) >> 37 is exact for all
+ *	32-bit values.
+ */
+static uint32_t
+divideBy100(uint32_t value)
+{
+	if (value < 43699)
+	{
+		return (value * 5243) >> 19;
+	}
+
+	return ((uint64_t)value * 1374389535u) >> 37;
+}
+
+/*
+ *	Write value's decimal digits backwards, ending just before end, and
+ *	return where they start.
+ */
+static char *
+formatUnsigned(char *  end, uint32_t value)
+{
+	while (value >= 100)
+	{
+		uint32_t	quotient = divideBy100(value);
+		uint32_t	pair = 2 * (value - quotient * 100);
+
+		*--end	= digitPairs[pair + 1];
+		*--end	= digitPairs[pair];
+		value	= quotient;
+	}
+
+	if (value >= 10)
+	{
+		*--end = digitPairs[2*value + 1];
+		*--end = digitPairs[2*value];
+	}
+	else
+	{
+		*--end = '0' + value;
+	}
+
+	return end;
+}
+
+void
+warpCsvFlush(void)
+{
+	if (rowBytes > 0)
+	{
+		SEGGER_RTT_Write(0, row, rowBytes);
+		rowBytes = 0;
+	}
+}
+
+/*
+ *	Make room for a field of up to kWarpCsvMaxFieldBytes, and start it with
+ *	its separating blank (but not the row's first).
+ */
+static void
+startField(void)
+{
+	if (rowBytes + kWarpCsvMaxFieldBytes > kWarpCsvRowBytes)
+	{
+		warpCsvFlush();
+	}
+
+	if (rowStarted)
+	{
+		row[rowBytes++] = ' ';
+	}
+	rowStarted = true;
+}
+
+static void
+appendDigits(uint32_t value)
+{
+	char		digits[10];
+	char *		end = &digits[sizeof(digits)];
+	char *		start = formatUnsigned(end, value);
+
+	while (start < end)
+	{
+		row[rowBytes++] = *start++;
+	}
+}
+
+/*
+ *	" value," as SEGGER_RTT_printf()'s " %d,".
+ */
+void
+warpCsvInt(int32_t value)
+{
+	startField();
+	if (value < 0)
+	{
+		row[rowBytes++] = '-';
+		appendDigits(-(uint32_t)value);
+	}
+	else
+	{
+		appendDigits(value);
+	}
+	row[rowBytes++] = ',';
+}
+
+/*
+ *	" value," as " %u,".
+ */
+void
+warpCsvUnsigned(uint32_t value)
+{
+	startField();
+	appendDigits(value);
+	row[rowBytes++] = ',';
+}
+
+/*
+ *	The low byteCount bytes of value, most significant first, as
+ *	" 0x%02x 0x%02x ...,": e.g., warpCsvHex((msb << 8) | lsb, 2).
+ */
+void
+warpCsvHex(uint32_t value, uint8_t byteCount)
+{
+	startField();
+	for (int i = byteCount - 1; i >= 0; i--)
+	{
+		uint8_t		byte = value >> (8 * i);
+
+		row[rowBytes++] = '0';
+		row[rowBytes++] = 'x';
+		row[rowBytes++] = hexDigits[byte >> 4];
+		row[rowBytes++] = hexDigits[byte & 0x0F];
+		row[rowBytes++] = (i > 0) ? ' ' : ',';
+	}
+}
+
+/*
+ *	A field whose read failed.
+ */
+void
+warpCsvMissing(void)
+{
+	startField();
+	row[rowBytes++] = '-';
+	row[rowBytes++] = '-';
+	row[rowBytes++] = '-';
+	row[rowBytes++] = '-';
+	row[rowBytes++] = ',';
+}
+
+/*
+ *	A field of a sensor that was not sampled in this row.
+ */
+void
+warpCsvEmpty(void)
+{
+	startField();
+	row[rowBytes++] = ',';
+}
+
+/*
+ *	End the row in place of the last field's comma, and write it.
+ */
+void
+warpCsvEndRow(void)
+{
+	if ((rowBytes > 0) && (row[rowBytes - 1] == ','))
+	{
+		rowBytes--;
+	}
+	row[rowBytes++] = '\n';
+	rowStarted = false;
+	warpCsvFlush();
+}
+
+/*
+ *	Cycles per row of kWarpCsvBenchmarkFields typical readings, plus the
+ *	reading count, and start and end times as printAllSensors() writes
+ *	them, first with SEGGER_RTT_printf() per field as the drivers used to
+ *	and then through the row. Both write their rows to the terminal.
+ */
+void
+warpCsvBenchmark(void)
+{
+	static const int32_t	fields[kWarpCsvBenchmarkFields] =
+	{
+		0, -1, 7, 42, -123, 981, -1003, 2047, -4096, 8191, -16384, 32767, -40, 25, 101325, -250000,
+	};
+	uint32_t		printfCycles;
+	uint32_t		rowCycles;
+
+	warpCycleCounterStart();
+	for (uint32_t i = 0; i < kWarpCsvBenchmarkRows; i++)
+	{
+		SEGGER_RTT_printf(0, "%u, %u,", i, 1000000 + i);
+		for (int j = 0; j < kWarpCsvBenchmarkFields; j++)
+		{
+			SEGGER_RTT_printf(0, " %d,", fields[j]);
+		}
+		SEGGER_RTT_printf(0, " %u, %d\n", 1001000 + i, 0);
+	}
+	printfCycles = warpCycleCounterRead();
+
+	warpCycleCounterStart();
+	for (uint32_t i = 0; i < kWarpCsvBenchmarkRows; i++)
+	{
+		warpCsvUnsigned(i);
+		warpCsvUnsigned(1000000 + i);
+		for (int j = 0; j < kWarpCsvBenchmarkFields; j++)
+		{
+			warpCsvInt(fields[j]);
+		}
+		warpCsvUnsigned(1001000 + i);
+		warpCsvInt(0);
+		warpCsvEndRow();
+	}
+	rowCycles = warpCycleCounterRead();
+	warpCycleCounterStop();
+
+	SEGGER_RTT_printf(0, "\r\n\tCSV benchmark (core clock %u Hz, %d fields per row)\n", SystemCoreClock, kWarpCsvBenchmarkFields + 4);
+	SEGGER_RTT_printf(0, "\r\t%u cycles per row with SEGGER_RTT_printf(), %u through warpCsv\n", printfCycles / kWarpCsvBenchmarkRows, rowCycles / kWarpCsvBenchmarkRows);
+}
@@ -0,0 +1,75 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fsl_device_registers.h"
+
+#include "warp.h"
+
+
+/*
+ *	The Cortex-M0+ has no DWT cycle counter, so we extend the 24-bit
+ *	SysTick down-counter (clocked from the core clock) with a software
+ *	count of reloads kept in SysTick_Handler(). The core clock stops in
+ *	every sleep mode, so while the counter runs warpTimeSleep() spins
+ *	instead of sleeping, and delays inside a measurement are counted.
+ */
+enum
+{
+	kWarpCycleCounterReload	= 0x00FFFFFF,
+};
+
+static volatile uint32_t	cycleCounterReloads;
+
+
+void
+SysTick_Handler(void)
+{
+	cycleCounterReloads++;
+}
+
+void
+warpCycleCounterStart(void)
+{
+	SysTick->CTRL		= 0;
+	SysTick->LOAD		= kWarpCycleCounterReload;
+	SysTick->VAL		= 0;
+	cycleCounterReloads	= 0;
+	SysTick->CTRL		= SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+
+void
+warpCycleCounterStop(void)
+{
+	SysTick->CTRL = 0;
+}
+
+/*
+ *	True between warpCycleCounterStart() and warpCycleCounterStop().
+ */
+bool
+warpCycleCounterRunning(void)
+{
+	return (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) != 0;
+}
+
+/*
+ *	Core clock cycles since warpCycleCounterStart(). Wraps after 2^32 cycles
+ *	(~89 s at 48 MHz), which is ample for the benchmarks it is used for.
+ */
+uint32_t
+warpCycleCounterRead(void)
+{
+	uint32_t	reloads;
+	uint32_t	current;
+
+	/*
+	 *	Re-read if the SysTick interrupt fired between the two reads.
+	 */
+	do
+	{
+		reloads = cycleCounterReloads;
+		current = SysTick->VAL;
+	} while (reloads != cycleCounterReloads);
+
+	return reloads * (kWarpCycleCounterReload + 1) + (kWarpCycleCounterReload - current);
+}
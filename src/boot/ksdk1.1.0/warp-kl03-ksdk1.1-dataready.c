@@ -0,0 +1,241 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "fsl_device_registers.h"
+#include "fsl_interrupt_manager.h"
+#include "fsl_port_hal.h"
+#include "fsl_gpio_driver.h"
+
+#include "gpio_pins.h"
+#include "warp.h"
+
+
+/*
+ *	Data-ready driven sampling. Each sensor's data-ready output (see the
+ *	drivers' configureDataReady...() routines) is open drain and active low,
+ *	and all of them are wired together onto kWarpPinSensorDataReady, since
+ *	the KL03 has no interrupt-capable pins to spare for one each. When the
+ *	line goes low, the PORT interrupt timestamps the edge and masks the pin,
+ *	and serviceTaskRun() reads every registered sensor's status and data in
+ *	one burst on the I2C queue. Sensors whose status shows a new sample have
+ *	it decoded, in the completion callback, straight into the next record
+ *	of the shared sample ring with the edge's timestamp; reading the data
+ *	also releases their data-ready output. Once the last read completes we
+ *	unmask the pin: if a sensor pulled the line low again meanwhile, the
+ *	level-sensitive interrupt fires at once and that sample's timestamp is
+ *	late by at most one burst.
+ *
+ *	The reads are submitted from a task rather than from the interrupt so
+ *	that they never start while a blocking KSDK transfer owns the bus.
+ *
+ *	A sensor that batches samples in its own FIFO (e.g., the MMA8451Q with
+ *	configureFifoMMA8451Q()) needs a variable-length drain instead. For
+ *	that, warpDataReadyWatch() hands each edge to a task, which drains the
+ *	FIFO and then calls warpDataReadyRelease(); the pin stays masked until
+ *	it has, and until the reads above have completed.
+ */
+enum
+{
+	kWarpDataReadyPin			= GPIO_EXTRACT_PIN(kWarpPinSensorDataReady),
+	kWarpDataReadyRingLength		= 16,
+	kWarpDataReadyMaxRegisterBytes		= 9,
+};
+
+typedef enum
+{
+	kWarpDataReadyServiceEventRead		= kWarpTaskEventFirstUser << 0,
+} WarpDataReadyServiceEvent;
+
+static const WarpDataReadySource *	sources[kWarpDataReadySensorCount];
+static WarpI2cTransaction		transactions[kWarpDataReadySensorCount];
+static uint8_t				registerValues[kWarpDataReadySensorCount][kWarpDataReadyMaxRegisterBytes];
+
+static WarpSampleRecord			records[kWarpDataReadyRingLength];
+static WarpSampleRing			ring;
+static volatile uint32_t		overruns[kWarpDataReadySensorCount];
+
+static volatile uint32_t		edgeMicroseconds;
+static volatile uint8_t			readsOutstanding;
+
+static WarpTask *			subscriberTask;
+static uint32_t				subscriberEvents;
+static WarpTask *			watchTask;
+static uint32_t				watchEvents;
+static WarpTask				serviceTask;
+
+
+/*
+ *	Called from PORTB_IRQHandler() when the data-ready pin's flag is set.
+ *	The pin stays masked until the burst it starts has completed.
+ */
+void
+warpDataReadyPinInterrupt(void)
+{
+	PORT_HAL_SetPinIntMode(PORTB_BASE, kWarpDataReadyPin, kPortIntDisabled);
+	PORT_HAL_ClearPinIntFlag(PORTB_BASE, kWarpDataReadyPin);
+	edgeMicroseconds = (uint32_t)warpTimeNowUs();
+	warpTaskSignal(&serviceTask, kWarpDataReadyServiceEventRead);
+}
+
+/*
+ *	One of the round's reads or its watcher is done; the last unmasks the pin.
+ */
+void
+warpDataReadyRelease(void)
+{
+	INT_SYS_DisableIRQGlobal();
+	if (--readsOutstanding == 0)
+	{
+		PORT_HAL_SetPinIntMode(PORTB_BASE, kWarpDataReadyPin, kPortIntLogicZero);
+	}
+	INT_SYS_EnableIRQGlobal();
+}
+
+/*
+ *	I2C completion callback, in interrupt context.
+ */
+static void
+readDone(WarpI2cTransaction *  transaction)
+{
+	size_t			sensor = transaction - transactions;
+	WarpSampleRecord *	record;
+
+	if (transaction->status == kWarpStatusOK)
+	{
+		record = warpSampleRingReserve(&ring);
+		if (record == NULL)
+		{
+			overruns[sensor]++;
+		}
+		else if (sources[sensor]->decode(registerValues[sensor], record->fields))
+		{
+			record->timeMicroseconds	= edgeMicroseconds;
+			record->source			= sensor;
+			record->fieldCount		= 3;
+			warpSampleRingPublish(&ring);
+			warpTaskSignal(subscriberTask, subscriberEvents);
+		}
+	}
+
+	warpDataReadyRelease();
+}
+
+static void
+serviceTaskRun(WarpTask *  task, uint32_t events)
+{
+	uint8_t	count = (watchTask != NULL) ? 1 : 0;
+
+	for (size_t i = 0; i < kWarpDataReadySensorCount; i++)
+	{
+		if (sources[i] != NULL)
+		{
+			count++;
+		}
+	}
+
+	/*
+	 *	Set before the first submission, as its callback may run before
+	 *	we submit the next.
+	 */
+	readsOutstanding = count;
+
+	for (size_t i = 0; i < kWarpDataReadySensorCount; i++)
+	{
+		if (sources[i] == NULL)
+		{
+			continue;
+		}
+
+		transactions[i].i2cAddress	= sources[i]->deviceState->i2cAddress;
+		transactions[i].deviceRegister	= sources[i]->deviceRegister;
+		transactions[i].direction	= kWarpI2cDirectionRead;
+		transactions[i].buffer		= registerValues[i];
+		transactions[i].numberOfBytes	= sources[i]->numberOfBytes;
+		transactions[i].callback	= readDone;
+		warpI2cSubmit(&transactions[i]);
+	}
+
+	if (watchTask != NULL)
+	{
+		warpTaskSignal(watchTask, watchEvents);
+	}
+}
+
+/*
+ *	Register a sensor whose data-ready output has been set up with its
+ *	driver's configureDataReady...(). Call before warpDataReadyInit().
+ */
+void
+warpDataReadyAddSensor(WarpDataReadySensor sensor, const WarpDataReadySource *  source)
+{
+	if ((sensor >= kWarpDataReadySensorCount) || (source->numberOfBytes > kWarpDataReadyMaxRegisterBytes))
+	{
+		return;
+	}
+
+	sources[sensor] = source;
+}
+
+/*
+ *	Raise events on task at each data-ready edge, for a sensor whose
+ *	samples it reads itself. It must call warpDataReadyRelease() once it
+ *	has, to unmask the pin. Call before warpDataReadyInit().
+ */
+void
+warpDataReadyWatch(WarpTask *  task, uint32_t events)
+{
+	watchTask	= task;
+	watchEvents	= events;
+}
+
+/*
+ *	Of the most recent data-ready edge, from warpTimeNowUs().
+ */
+uint32_t
+warpDataReadyEdgeMicroseconds(void)
+{
+	return edgeMicroseconds;
+}
+
+/*
+ *	Start acquisition. subscriberEventFlags are raised on subscriber
+ *	whenever samples are published on warpDataReadySamples(), which it is
+ *	the only consumer of. Requires enableI2Cpins().
+ */
+void
+warpDataReadyInit(WarpTask *  subscriber, uint32_t subscriberEventFlags)
+{
+	subscriberTask		= subscriber;
+	subscriberEvents	= subscriberEventFlags;
+	warpSampleRingInit(&ring, records, kWarpDataReadyRingLength);
+	warpSchedulerAddTask(&serviceTask, serviceTaskRun);
+
+	/*
+	 *	Outputs that were asserted before we enabled them stay asserted
+	 *	until read, so the level-sensitive interrupt picks them up at once.
+	 */
+	PORT_HAL_ClearPinIntFlag(PORTB_BASE, kWarpDataReadyPin);
+	PORT_HAL_SetPinIntMode(PORTB_BASE, kWarpDataReadyPin, kPortIntLogicZero);
+	INT_SYS_EnableIRQ(PORTB_IRQn);
+}
+
+/*
+ *	The ring the sensors' samples are published on, in the order they
+ *	arrived, each with its WarpDataReadySensor as its source.
+ */
+WarpSampleRing *
+warpDataReadySamples(void)
+{
+	return &ring;
+}
+
+/*
+ *	New samples of sensor dropped because the subscriber did not release
+ *	the ring's records in time. The ring counts them all.
+ */
+uint32_t
+warpDataReadyOverruns(WarpDataReadySensor sensor)
+{
+	return overruns[sensor];
+}
@@ -0,0 +1,124 @@
+#include <stdint.h>
+
+#include "fsl_device_registers.h"
+
+#include "SEGGER_RTT.h"
+#include "warp.h"
+
+
+enum
+{
+	kWarpFixedPointBenchmarkConversions	= 64,
+};
+
+
+/*
+ *	Each conversion is (raw * multiplier) >> shift, rounded to nearest.
+ *	The multipliers are chosen so that the product of a 16-bit register
+ *	value and the multiplier always fits in 32 bits, which keeps every
+ *	conversion to a single MULS on the Cortex-M0+.
+ */
+typedef struct
+{
+	int16_t		multiplier;
+	uint8_t		shift;
+} WarpFixedPointScaleFactor;
+
+static const WarpFixedPointScaleFactor	scaleFactors[kWarpFixedPointScaleMax] =
+{
+	/*
+	 *	INA219: shunt voltage LSB is 10 uV; across the 0.1 ohm shunt that
+	 *	is 100 uA. Bus voltage (after dropping the 3 status bits) is 4 mV.
+	 *	With the calibration written by configureSensorINA219(), the
+	 *	Current register is also 100 uA per LSB.
+	 */
+	[kWarpFixedPointScaleINA219ShuntMicrovolts]	= {10, 0},
+	[kWarpFixedPointScaleINA219ShuntMicroamps]	= {100, 0},
+	[kWarpFixedPointScaleINA219BusMillivolts]	= {4, 0},
+	[kWarpFixedPointScaleINA219CurrentMicroamps]	= {100, 0},
+
+	/*
+	 *	AMG8834: pixels are 0.25 C and the thermistor 0.0625 C per LSB;
+	 *	both convert to degrees C in Q8.8.
+	 */
+	[kWarpFixedPointScaleAMG8834PixelQ8]		= {64, 0},
+	[kWarpFixedPointScaleAMG8834ThermistorQ8]	= {16, 0},
+
+	/*
+	 *	MMA8451Q in the +/-2 g range: 14 bits, 4096 counts per g.
+	 */
+	[kWarpFixedPointScaleMMA8451QMilliG]		= {125, 9},
+
+	/*
+	 *	BMX055 accelerometer in the +/-2 g range: 12 bits, 1024 counts per
+	 *	g (the datasheet's 0.98 mg per LSB).
+	 */
+	[kWarpFixedPointScaleBMX055accelMilliG]		= {125, 7},
+};
+
+
+int32_t
+warpFixedPointConvert(int32_t raw, WarpFixedPointScale scale)
+{
+	const WarpFixedPointScaleFactor *	factor = &scaleFactors[scale];
+	int32_t					product = raw * factor->multiplier;
+
+	if (factor->shift == 0)
+	{
+		return product;
+	}
+
+	return (product + (1 << (factor->shift - 1))) >> factor->shift;
+}
+
+/*
+ *	Sign-extend the low `bits` bits of a two's complement register value.
+ */
+int32_t
+warpFixedPointSignExtend(uint32_t raw, uint8_t bits)
+{
+	uint32_t	signBit = 1UL << (bits - 1);
+
+	raw &= (signBit << 1) - 1;
+
+	return (int32_t)(raw ^ signBit) - (int32_t)signBit;
+}
+
+/*
+ *	Cycles per INA219 current conversion, first as main() used to compute
+ *	it, (raw*10)/0.1 in soft-float double, then with warpFixedPointConvert().
+ *
+ *	This is the only floating-point code in the firmware, and the linker
+ *	drops it (--gc-sections) unless WARP_BUILD_ENABLE_FIXEDPOINT_BENCHMARK
+ *	calls it. So the flash the soft-float routines cost is the difference
+ *	in .text (arm-none-eabi-size) between builds with and without the
+ *	benchmark, less the benchmark's own code, which the map file lists.
+ */
+void
+warpFixedPointBenchmark(void)
+{
+	static const int16_t	raw[8] = {0, 1, 45, 451, 1203, 4096, -17, 32767};
+	volatile int32_t	sink;
+	uint32_t		floatCycles;
+	uint32_t		fixedCycles;
+
+	warpCycleCounterStart();
+	for (int i = 0; i < kWarpFixedPointBenchmarkConversions; i++)
+	{
+		sink = (raw[i & 7]*10)/0.1;
+	}
+	floatCycles = warpCycleCounterRead();
+
+	warpCycleCounterStart();
+	for (int i = 0; i < kWarpFixedPointBenchmarkConversions; i++)
+	{
+		sink = warpFixedPointConvert(raw[i & 7], kWarpFixedPointScaleINA219CurrentMicroamps);
+	}
+	fixedCycles = warpCycleCounterRead();
+	warpCycleCounterStop();
+	(void)sink;
+
+	SEGGER_RTT_printf(0, "\r\n\tFixed-point benchmark (core clock %u Hz)\n", SystemCoreClock);
+	SEGGER_RTT_printf(0, "\r\t%u cycles per conversion with soft-float, %u with warpFixedPointConvert()\n",
+		floatCycles / kWarpFixedPointBenchmarkConversions, fixedCycles / kWarpFixedPointBenchmarkConversions);
+}
@@ -0,0 +1,489 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "fsl_device_registers.h"
+#include "fsl_interrupt_manager.h"
+#include "fsl_os_abstraction.h"
+#include "fsl_i2c_hal.h"
+#include "fsl_i2c_master_driver.h"
+
+#include "warp.h"
+
+
+extern volatile uint32_t		gWarpI2cBaudRateKbps;
+extern volatile uint32_t		gWarpI2cTimeoutMilliseconds;
+extern volatile i2c_master_state_t	i2cMasterState;
+
+/*
+ *	fsl_i2c_shared_function.h is not on our include path.
+ */
+void	I2C_DRV_IRQHandler(uint32_t instance);
+
+
+/*
+ *	Transactions are queued as a singly-linked list of caller-owned
+ *	descriptors and run back-to-back by I2C0_IRQHandler(): each byte
+ *	interrupt advances the head transaction through the phases below, and
+ *	completing it starts the next one from the same interrupt.
+ *
+ *	The KSDK's own non-blocking I2C_DRV_MasterReceiveData() still waits on
+ *	a semaphore while it sends the address and register, so it cannot be
+ *	started from an interrupt; we therefore drive the bus through the HAL.
+ *	While the queue is non-empty we mark the KSDK master state busy, so
+ *	blocking KSDK transfers fail with kStatus_I2C_Busy instead of corrupting
+ *	the bus, and when it is empty we pass interrupts on to the KSDK handler.
+ *
+ *	Completion callbacks always run in I2C0_IRQHandler(): when warpI2cWait()
+ *	times out it does not fail the queue itself, but pends the I2C
+ *	interrupt with abortRequested set and lets the handler do it.
+ */
+enum
+{
+	/*
+	 *	A STOP takes about one bit time to complete on the bus (5 us at
+	 *	200 kb/s); at 48 MHz each poll of the busy flag is a few cycles.
+	 *	If the bus is still busy after this many polls (a slave holding
+	 *	SDA low), the next START loses arbitration and fails its
+	 *	transaction rather than hanging here.
+	 */
+	kWarpI2cBusIdlePolls	= 2000,
+};
+
+typedef enum
+{
+	kWarpI2cPhaseAddressWrite,
+	kWarpI2cPhaseRegister,
+	kWarpI2cPhaseWriteData,
+	kWarpI2cPhaseAddressRead,
+	kWarpI2cPhaseReadData,
+} WarpI2cPhase;
+
+static WarpI2cTransaction * volatile	queueHead;
+static WarpI2cTransaction * volatile	queueTail;
+static volatile WarpI2cPhase		phase;
+static volatile size_t			transferredBytes;
+static volatile bool			abortRequested;
+
+/*
+ *	Incremented on every completion, so that warpI2cWait() can apply its
+ *	timeout to each transaction ahead of the one it is waiting for.
+ */
+static volatile uint32_t		completions;
+
+
+/*
+ *	Bursts longer than a few bytes take longer than the default timeout:
+ *	allow for 9 bit times (8 data bits plus ACK) per byte on top of it,
+ *	rounded up.
+ */
+static uint32_t
+burstTimeoutMilliseconds(size_t numberOfBytes)
+{
+	return gWarpI2cTimeoutMilliseconds + (numberOfBytes * 9) / gWarpI2cBaudRateKbps + 1;
+}
+
+/*
+ *	Wait for the STOP that ended the previous transaction (ours or the
+ *	KSDK's) to finish on the bus, as a START issued while the module still
+ *	sees the bus busy is not sent.
+ */
+static void
+waitForBusIdle(void)
+{
+	for (uint32_t i = 0; (i < kWarpI2cBusIdlePolls) && I2C_HAL_GetStatusFlag(I2C0_BASE, kI2CBusBusy); i++)
+	{
+	}
+}
+
+static void
+startTransaction(WarpI2cTransaction *  transaction)
+{
+	i2c_device_t slave =
+	{
+		.address = transaction->i2cAddress,
+		.baudRate_kbps = gWarpI2cBaudRateKbps
+	};
+
+	i2cMasterState.i2cIdle = false;
+	I2C_DRV_MasterSetBaudRate(0 /* I2C peripheral instance */, &slave);
+
+	transferredBytes = 0;
+
+	waitForBusIdle();
+	I2C_HAL_ClearInt(I2C0_BASE);
+	I2C_HAL_SetIntCmd(I2C0_BASE, true);
+	I2C_HAL_SendStart(I2C0_BASE);
+	if (transaction->direction == kWarpI2cDirectionReadAtPointer)
+	{
+		phase = kWarpI2cPhaseAddressRead;
+		I2C_HAL_WriteByte(I2C0_BASE, (transaction->i2cAddress << 1) | 1U);
+	}
+	else
+	{
+		phase = kWarpI2cPhaseAddressWrite;
+		I2C_HAL_WriteByte(I2C0_BASE, transaction->i2cAddress << 1);
+	}
+}
+
+/*
+ *	Retire the head transaction and start the next one, if any (once the
+ *	STOP has gone out, see waitForBusIdle()), before running the callback,
+ *	so the bus is not left idle while it runs. Called from I2C0_IRQHandler().
+ */
+static void
+completeTransaction(WarpStatus status)
+{
+	WarpI2cTransaction *	transaction = queueHead;
+
+	if (I2C_HAL_IsMaster(I2C0_BASE))
+	{
+		I2C_HAL_SendStop(I2C0_BASE);
+	}
+
+	queueHead = transaction->next;
+	if (queueHead == NULL)
+	{
+		queueTail = NULL;
+		I2C_HAL_SetIntCmd(I2C0_BASE, false);
+		i2cMasterState.i2cIdle = true;
+	}
+	else
+	{
+		startTransaction(queueHead);
+	}
+
+	transaction->status = status;
+	transaction->done = true;
+	completions++;
+
+	if (transaction->callback != NULL)
+	{
+		transaction->callback(transaction);
+	}
+}
+
+/*
+ *	Fail every queued transaction and release the bus. The list is
+ *	detached first, so callbacks may submit afresh. Called from
+ *	I2C0_IRQHandler(), at warpI2cWait()'s request.
+ */
+static void
+abortTransactions(void)
+{
+	WarpI2cTransaction *	transaction = queueHead;
+
+	I2C_HAL_SetIntCmd(I2C0_BASE, false);
+	if (I2C_HAL_IsMaster(I2C0_BASE))
+	{
+		I2C_HAL_SendStop(I2C0_BASE);
+	}
+
+	queueHead = queueTail = NULL;
+	i2cMasterState.i2cIdle = true;
+
+	while (transaction != NULL)
+	{
+		WarpI2cTransaction *	next = transaction->next;
+
+		transaction->status = kWarpStatusDeviceCommunicationFailed;
+		transaction->done = true;
+		completions++;
+
+		if (transaction->callback != NULL)
+		{
+			transaction->callback(transaction);
+		}
+
+		transaction = next;
+	}
+}
+
+void
+I2C0_IRQHandler(void)
+{
+	WarpI2cTransaction *	transaction = queueHead;
+
+	if (abortRequested)
+	{
+		abortRequested = false;
+		abortTransactions();
+
+		return;
+	}
+
+	if (transaction == NULL)
+	{
+		I2C_DRV_IRQHandler(0 /* I2C peripheral instance */);
+
+		return;
+	}
+
+	I2C_HAL_ClearInt(I2C0_BASE);
+
+	if (I2C_HAL_GetStatusFlag(I2C0_BASE, kI2CArbitrationLost))
+	{
+		I2C_HAL_ClearArbitrationLost(I2C0_BASE);
+		completeTransaction(kWarpStatusDeviceCommunicationFailed);
+
+		return;
+	}
+
+	/*
+	 *	In the transmit phases, the interrupt follows the ACK/NAK of the
+	 *	byte we last wrote.
+	 */
+	if ((phase != kWarpI2cPhaseReadData) && I2C_HAL_GetStatusFlag(I2C0_BASE, kI2CReceivedNak))
+	{
+		completeTransaction(kWarpStatusDeviceCommunicationFailed);
+
+		return;
+	}
+
+	switch (phase)
+	{
+		case kWarpI2cPhaseAddressWrite:
+		{
+			phase = kWarpI2cPhaseRegister;
+			I2C_HAL_WriteByte(I2C0_BASE, transaction->deviceRegister);
+
+			break;
+		}
+
+		case kWarpI2cPhaseRegister:
+		{
+			if (transaction->direction == kWarpI2cDirectionRead)
+			{
+				phase = kWarpI2cPhaseAddressRead;
+				I2C_HAL_SendStart(I2C0_BASE);
+				I2C_HAL_WriteByte(I2C0_BASE, (transaction->i2cAddress << 1) | 1U);
+			}
+			else if (transaction->numberOfBytes == 0)
+			{
+				completeTransaction(kWarpStatusOK);
+			}
+			else
+			{
+				phase = kWarpI2cPhaseWriteData;
+				I2C_HAL_WriteByte(I2C0_BASE, transaction->buffer[0]);
+			}
+
+			break;
+		}
+
+		case kWarpI2cPhaseWriteData:
+		{
+			if (++transferredBytes == transaction->numberOfBytes)
+			{
+				completeTransaction(kWarpStatusOK);
+			}
+			else
+			{
+				I2C_HAL_WriteByte(I2C0_BASE, transaction->buffer[transferredBytes]);
+			}
+
+			break;
+		}
+
+		case kWarpI2cPhaseAddressRead:
+		{
+			/*
+			 *	NAK the final byte. The dummy read clocks in the first.
+			 */
+			phase = kWarpI2cPhaseReadData;
+			I2C_HAL_SetDirMode(I2C0_BASE, kI2CReceive);
+			if (transaction->numberOfBytes == 1)
+			{
+				I2C_HAL_SendNak(I2C0_BASE);
+			}
+			else
+			{
+				I2C_HAL_SendAck(I2C0_BASE);
+			}
+			I2C_HAL_ReadByte(I2C0_BASE);
+
+			break;
+		}
+
+		case kWarpI2cPhaseReadData:
+		{
+			size_t	remainingBytes = transaction->numberOfBytes - transferredBytes;
+
+			if (remainingBytes == 1)
+			{
+				/*
+				 *	Send the STOP before reading the data register, which
+				 *	would otherwise clock in another byte.
+				 */
+				I2C_HAL_SendStop(I2C0_BASE);
+				transaction->buffer[transferredBytes++] = I2C_HAL_ReadByte(I2C0_BASE);
+				completeTransaction(kWarpStatusOK);
+			}
+			else
+			{
+				if (remainingBytes == 2)
+				{
+					I2C_HAL_SendNak(I2C0_BASE);
+				}
+				transaction->buffer[transferredBytes++] = I2C_HAL_ReadByte(I2C0_BASE);
+			}
+
+			break;
+		}
+	}
+}
+
+/*
+ *	Queue a transaction. The descriptor and its buffer must stay valid, and
+ *	must not be touched, until transaction->done is set (immediately, if it
+ *	is rejected); its callback (if not NULL) then runs in I2C0_IRQHandler(),
+ *	whether the transaction completed or failed (including when warpI2cWait()
+ *	timed out), and may submit further transactions. A rejected transaction
+ *	has no callback. Requires enableI2Cpins().
+ */
+WarpStatus
+warpI2cSubmit(WarpI2cTransaction *  transaction)
+{
+	if ((transaction->direction != kWarpI2cDirectionWrite) && (transaction->numberOfBytes == 0))
+	{
+		transaction->status = kWarpStatusBadDeviceCommand;
+		transaction->done = true;
+
+		return kWarpStatusBadDeviceCommand;
+	}
+
+	transaction->done = false;
+	transaction->status = kWarpStatusOK;
+	transaction->next = NULL;
+
+	INT_SYS_DisableIRQGlobal();
+	if (queueHead == NULL)
+	{
+		queueHead = queueTail = transaction;
+		startTransaction(transaction);
+	}
+	else
+	{
+		queueTail->next = transaction;
+		queueTail = transaction;
+	}
+	INT_SYS_EnableIRQGlobal();
+
+	return kWarpStatusOK;
+}
+
+/*
+ *	Wait for a submitted transaction to complete and return its status.
+ *	If the queue makes no progress for longer than its head transaction's
+ *	timeout, everything still queued is failed and the bus released, from
+ *	the I2C interrupt.
+ */
+WarpStatus
+warpI2cWait(WarpI2cTransaction *  transaction)
+{
+	uint32_t	lastCompletions = completions;
+	uint32_t	lastProgressMilliseconds = warpTimeNowMs();
+
+	while (!transaction->done)
+	{
+		WarpI2cTransaction *	head = queueHead;
+
+		if (completions != lastCompletions)
+		{
+			lastCompletions = completions;
+			lastProgressMilliseconds = warpTimeNowMs();
+		}
+		else if ((head != NULL) &&
+			((warpTimeNowMs() - lastProgressMilliseconds) > burstTimeoutMilliseconds(head->numberOfBytes)))
+		{
+			if (!abortRequested)
+			{
+				abortRequested = true;
+				NVIC_SetPendingIRQ(I2C0_IRQn);
+			}
+		}
+	}
+
+	return transaction->status;
+}
+
+/*
+ *	Wait until every submitted transaction has completed.
+ */
+WarpStatus
+warpI2cWaitIdle(void)
+{
+	WarpI2cTransaction *	tail = queueTail;
+
+	if (tail == NULL)
+	{
+		return kWarpStatusOK;
+	}
+
+	return warpI2cWait(tail);
+}
+
+/*
+ *	True while transactions are queued or on the bus, i.e., while the I2C
+ *	module needs its clock (see OSA_TimeDelay()).
+ */
+bool
+warpI2cBusy(void)
+{
+	return queueHead != NULL;
+}
+
+/*
+ *	Read numberOfBytes consecutive registers starting at deviceRegister into a
+ *	caller-owned buffer, as a single bus transaction (register address write,
+ *	repeated start, read). Devices that need a flag to auto-increment the
+ *	register address (e.g., the L3GD20H) must include it in deviceRegister.
+ */
+WarpStatus
+warpI2cReadBurst(uint8_t i2cAddress, uint8_t deviceRegister, uint8_t *  buffer, size_t numberOfBytes)
+{
+	WarpI2cTransaction	transaction =
+	{
+		.i2cAddress	= i2cAddress,
+		.deviceRegister	= deviceRegister,
+		.direction	= kWarpI2cDirectionRead,
+		.buffer		= buffer,
+		.numberOfBytes	= numberOfBytes,
+		.callback	= NULL,
+	};
+	WarpStatus		status;
+
+	status = warpI2cSubmit(&transaction);
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+
+	return warpI2cWait(&transaction);
+}
+
+/*
+ *	Write numberOfBytes from a caller-owned buffer to consecutive registers
+ *	starting at deviceRegister, as a single bus transaction.
+ */
+WarpStatus
+warpI2cWriteBurst(uint8_t i2cAddress, uint8_t deviceRegister, const uint8_t *  buffer, size_t numberOfBytes)
+{
+	WarpI2cTransaction	transaction =
+	{
+		.i2cAddress	= i2cAddress,
+		.deviceRegister	= deviceRegister,
+		.direction	= kWarpI2cDirectionWrite,
+		.buffer		= (uint8_t *)buffer,
+		.numberOfBytes	= numberOfBytes,
+		.callback	= NULL,
+	};
+	WarpStatus		status;
+
+	status = warpI2cSubmit(&transaction);
+	if (status != kWarpStatusOK)
+	{
+		return status;
+	}
+
+	return warpI2cWait(&transaction);
+}
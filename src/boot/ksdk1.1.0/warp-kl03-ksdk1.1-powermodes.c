@@ -102,6 +102,12 @@ update_clock_mode(uint8_t cmConfigMode)
 
 
 
+/*
+ *	For WAIT, VLPW and VLPS, a sleepSeconds of zero means the caller has
+ *	armed its own wake-up source (e.g., the LPTMR in OSA_TimeDelay()): we
+ *	then leave the RTC alarm and GPIO wake-ups alone and return in the
+ *	clock configuration we were called in.
+ */
 WarpStatus
 warpSetLowPowerMode(WarpPowerMode powerMode, uint32_t sleepSeconds)
 {
@@ -118,8 +124,11 @@ warpSetLowPowerMode(WarpPowerMode powerMode, uint32_t sleepSeconds)
 				return kWarpStatusPowerTransitionErrorVlpr2Wait;
 			}
 
-			gpioDisableWakeUp();
-			setSleepRtcAlarm(sleepSeconds);
+			if (sleepSeconds != 0)
+			{
+				gpioDisableWakeUp();
+				setSleepRtcAlarm(sleepSeconds);
+			}
 			status = POWER_SYS_SetMode(powerMode, kPowerManagerPolicyAgreement);
 
 
@@ -128,7 +137,10 @@ warpSetLowPowerMode(WarpPowerMode powerMode, uint32_t sleepSeconds)
 			 */
 
 			// for now, always go to VLPR upon completion of prior mode
-			CLOCK_SYS_UpdateConfiguration(CLOCK_CONFIG_INDEX_FOR_VLPR, kClockManagerPolicyForcible);
+			if (sleepSeconds != 0)
+			{
+				CLOCK_SYS_UpdateConfiguration(CLOCK_CONFIG_INDEX_FOR_VLPR, kClockManagerPolicyForcible);
+			}
 			
 
 			if (status != kPowerManagerSuccess)
@@ -194,12 +206,15 @@ warpSetLowPowerMode(WarpPowerMode powerMode, uint32_t sleepSeconds)
 				return kWarpStatusPowerTransitionErrorRun2Vlpw;
 			}
 
-			gpioDisableWakeUp();
-			setSleepRtcAlarm(sleepSeconds);
+			if (sleepSeconds != 0)
+			{
+				gpioDisableWakeUp();
+				setSleepRtcAlarm(sleepSeconds);
+			}
 
 			status = POWER_SYS_SetMode(powerMode, kPowerManagerPolicyAgreement);
 
-			if (POWER_SYS_GetCurrentMode() == kPowerManagerRun)
+			if ((sleepSeconds != 0) && (POWER_SYS_GetCurrentMode() == kPowerManagerRun))
 			{
 				// for now, always go to VLPR upon completion of prior mode
 				CLOCK_SYS_UpdateConfiguration(CLOCK_CONFIG_INDEX_FOR_VLPR, kClockManagerPolicyForcible);
@@ -215,8 +230,11 @@ warpSetLowPowerMode(WarpPowerMode powerMode, uint32_t sleepSeconds)
 
 		case kWarpPowerModeVLPS:
 		{
-			gpioDisableWakeUp();
-			setSleepRtcAlarm(sleepSeconds);
+			if (sleepSeconds != 0)
+			{
+				gpioDisableWakeUp();
+				setSleepRtcAlarm(sleepSeconds);
+			}
 
 			status = POWER_SYS_SetMode(powerMode, kPowerManagerPolicyAgreement);
 
@@ -224,7 +242,7 @@ warpSetLowPowerMode(WarpPowerMode powerMode, uint32_t sleepSeconds)
 			 *	After returning from RTC handler...
 			 */
 
-			if (POWER_SYS_GetCurrentMode() == kPowerManagerRun)
+			if ((sleepSeconds != 0) && (POWER_SYS_GetCurrentMode() == kPowerManagerRun))
 			{
 				// for now, always go to VLPR upon completion of prior mode
 				CLOCK_SYS_UpdateConfiguration(CLOCK_CONFIG_INDEX_FOR_VLPR, kClockManagerPolicyForcible);
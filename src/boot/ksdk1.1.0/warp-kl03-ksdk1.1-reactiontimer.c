@@ -0,0 +1,232 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fsl_device_registers.h"
+#include "fsl_interrupt_manager.h"
+#include "fsl_clock_manager.h"
+#include "fsl_port_hal.h"
+#include "fsl_tpm_hal.h"
+
+#include "warp.h"
+
+
+/*
+ *	Reaction timing with TPM0 input capture on PTA5 (ALT2 is TPM0_CH1),
+ *	where the off-board button pulls the pin low.
+ *
+ *	TPM0 runs from the 48 MHz HIRC (so only in RUN, where the HIRC is on)
+ *	divided by 32, i.e., 1.5 ticks per microsecond. The 16-bit counter
+ *	overflows every 43.7 ms and we count overflows in TPM0_IRQHandler() to
+ *	extend it to 32 bits. The capture itself is in hardware, so the result
+ *	does not depend on how quickly the core wakes from WAIT.
+ */
+enum
+{
+	kWarpReactionTimerChannel		= 1,
+	kWarpReactionTimerPin			= 5,
+	kWarpReactionTimerCounterBits		= 16,
+	kWarpReactionTimerCounterHalfRange	= 1 << (kWarpReactionTimerCounterBits - 1),
+};
+
+static volatile uint32_t	overflows;
+static volatile uint32_t	capturedTicks;
+static volatile bool		captured;
+static volatile bool		running;
+
+
+/*
+ *	Combine the software overflow count with a 16-bit counter (or capture)
+ *	value. If an overflow is pending but not yet counted, it belongs before
+ *	the counter value only if the value is small, i.e., the counter has
+ *	wrapped since; a large value was latched just before the wrap.
+ */
+uint32_t
+warpReactionTimerElapsedTicks(uint32_t overflowCount, bool overflowPending, uint16_t counter)
+{
+	if (overflowPending && (counter < kWarpReactionTimerCounterHalfRange))
+	{
+		overflowCount++;
+	}
+
+	return (overflowCount << kWarpReactionTimerCounterBits) + counter;
+}
+
+/*
+ *	ticks * 2 / 3, rounded down, without overflowing for any 32-bit count.
+ */
+uint32_t
+warpReactionTimerTicksToMicroseconds(uint32_t ticks)
+{
+	return ticks - (ticks / 3) - ((ticks % 3) != 0);
+}
+
+static void
+stopTimer(void)
+{
+	TPM_HAL_SetClockMode(TPM0_BASE, kTpmClockSourceNoneClk);
+	TPM_HAL_DisableChnInt(TPM0_BASE, kWarpReactionTimerChannel);
+	TPM_HAL_DisableTimerOverflowInt(TPM0_BASE);
+	INT_SYS_DisableIRQ(TPM0_IRQn);
+	PORT_HAL_SetMuxMode(PORTA_BASE, kWarpReactionTimerPin, kPortMuxAsGpio);
+	running = false;
+}
+
+void
+TPM0_IRQHandler(void)
+{
+	if (TPM_HAL_GetChnStatus(TPM0_BASE, kWarpReactionTimerChannel))
+	{
+		capturedTicks = warpReactionTimerElapsedTicks(	overflows,
+								TPM_HAL_GetTimerOverflowStatus(TPM0_BASE),
+								TPM_HAL_GetChnCountVal(TPM0_BASE, kWarpReactionTimerChannel));
+		captured = true;
+		stopTimer();
+		TPM_HAL_ClearChnInt(TPM0_BASE, kWarpReactionTimerChannel);
+	}
+
+	if (TPM_HAL_GetTimerOverflowStatus(TPM0_BASE))
+	{
+		overflows++;
+		TPM_HAL_ClearTimerOverflowFlag(TPM0_BASE);
+	}
+}
+
+/*
+ *	Start counting from zero and arm capture of the next falling edge on
+ *	PTA5. Call at the instant the stimulus is shown. Requires RUN mode.
+ */
+WarpStatus
+warpReactionTimerStart(void)
+{
+	if (CLOCK_SYS_GetCurrentConfiguration() != CLOCK_CONFIG_INDEX_FOR_RUN)
+	{
+		return kWarpStatusBadPowerModeSpecified;
+	}
+
+	CLOCK_SYS_SetTpmSrc(0, kClockTpmSrcIrc48M);
+	CLOCK_SYS_EnableTpmClock(0);
+
+	TPM_HAL_SetClockMode(TPM0_BASE, kTpmClockSourceNoneClk);
+	TPM_HAL_SetCpwms(TPM0_BASE, 0);
+	TPM_HAL_SetClockDiv(TPM0_BASE, kTpmDividedBy32);
+	TPM_HAL_SetMod(TPM0_BASE, 0xFFFF);
+
+	/*
+	 *	Keep counting while the core is in WAIT.
+	 */
+	TPM_HAL_SetWaitMode(TPM0_BASE, false);
+
+	TPM_HAL_SetChnMsnbaElsnbaVal(TPM0_BASE, kWarpReactionTimerChannel, kTpmFallingEdge << BP_TPM_CnSC_ELSA);
+	TPM_HAL_ClearChnInt(TPM0_BASE, kWarpReactionTimerChannel);
+	TPM_HAL_ClearTimerOverflowFlag(TPM0_BASE);
+	PORT_HAL_SetMuxMode(PORTA_BASE, kWarpReactionTimerPin, kPortMuxAlt2);
+
+	overflows = 0;
+	captured = false;
+	running = true;
+
+	TPM_HAL_EnableChnInt(TPM0_BASE, kWarpReactionTimerChannel);
+	TPM_HAL_EnableTimerOverflowInt(TPM0_BASE);
+	INT_SYS_EnableIRQ(TPM0_IRQn);
+
+	TPM_HAL_ClearCounter(TPM0_BASE);
+	TPM_HAL_SetClockMode(TPM0_BASE, kTpmClockSourceModuleClk);
+
+	return kWarpStatusOK;
+}
+
+/*
+ *	True between warpReactionTimerStart() and the capture or timeout, while
+ *	TPM0 needs the HIRC.
+ */
+bool
+warpReactionTimerRunning(void)
+{
+	return running;
+}
+
+/*
+ *	Call with interrupts masked.
+ */
+static WarpStatus
+checkCapture(uint32_t timeoutTicks)
+{
+	if (captured)
+	{
+		return kWarpStatusOK;
+	}
+
+	if (!running)
+	{
+		return kWarpStatusDeviceNotInitialized;
+	}
+
+	if (warpReactionTimerElapsedTicks(	overflows,
+						TPM_HAL_GetTimerOverflowStatus(TPM0_BASE),
+						TPM_HAL_GetCounterVal(TPM0_BASE)) >= timeoutTicks)
+	{
+		stopTimer();
+		return kWarpStatusTimeout;
+	}
+
+	return kWarpStatusPending;
+}
+
+/*
+ *	Sleep in WAIT until the button edge is captured or timeoutMicroseconds
+ *	have passed since warpReactionTimerStart(). The overflow interrupt
+ *	wakes us at least every 43.7 ms to check the timeout.
+ */
+WarpStatus
+warpReactionTimerWait(uint32_t timeoutMicroseconds, uint32_t *  reactionMicroseconds)
+{
+	uint32_t	timeoutTicks = timeoutMicroseconds + (timeoutMicroseconds >> 1);
+	WarpStatus	status;
+
+	/*
+	 *	WAIT, not STOP: the TPM needs the HIRC, which stops in deep sleep.
+	 */
+	SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+	/*
+	 *	Check and sleep with interrupts masked, so a capture between the
+	 *	check and the WFI still wakes us; the handler runs once they are
+	 *	unmasked again.
+	 */
+	INT_SYS_DisableIRQGlobal();
+	while ((status = checkCapture(timeoutTicks)) == kWarpStatusPending)
+	{
+		__WFI();
+		INT_SYS_EnableIRQGlobal();
+		INT_SYS_DisableIRQGlobal();
+	}
+	INT_SYS_EnableIRQGlobal();
+
+	if (status == kWarpStatusOK)
+	{
+		*reactionMicroseconds = warpReactionTimerTicksToMicroseconds(capturedTicks);
+	}
+
+	return status;
+}
+
+/*
+ *	As warpReactionTimerWait(), but returns kWarpStatusPending instead of
+ *	sleeping, for callers that must not block (e.g., scheduler tasks).
+ */
+WarpStatus
+warpReactionTimerPoll(uint32_t timeoutMicroseconds, uint32_t *  reactionMicroseconds)
+{
+	WarpStatus	status;
+
+	INT_SYS_DisableIRQGlobal();
+	status = checkCapture(timeoutMicroseconds + (timeoutMicroseconds >> 1));
+	INT_SYS_EnableIRQGlobal();
+
+	if (status == kWarpStatusOK)
+	{
+		*reactionMicroseconds = warpReactionTimerTicksToMicroseconds(capturedTicks);
+	}
+
+	return status;
+}
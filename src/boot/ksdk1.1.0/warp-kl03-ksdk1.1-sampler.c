@@ -0,0 +1,298 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "fsl_device_registers.h"
+#include "fsl_interrupt_manager.h"
+
+#include "warp.h"
+
+
+/*
+ *	Multi-rate sensor sampling. Each sensor is registered with its output
+ *	data rate, and sample n of a sensor falls due at
+ *
+ *		startTicks + n * ticksPerSecond / rateHz
+ *
+ *	on the timebase, so that the long-run rate is exact even where the
+ *	period is not a whole number of ticks (800 Hz is 40.96 ticks). Pending
+ *	samples are kept on a hashed timer wheel of kWarpSamplerWheelSlots
+ *	slots of 2^kWarpSamplerSlotTicksShift ticks (~1 ms) each, hashed by due
+ *	time, so each tick only looks at the sensors that may be due in it.
+ *	Sensors due more than a revolution ahead stay in their slot until their
+ *	revolution comes round.
+ *
+ *	warpSamplerNextRound() sleeps until at least one sample is due, marks
+ *	every sensor due by then, and submits their reads back-to-back on the
+ *	I2C queue, which runs them as one burst. If we fall more than a period
+ *	behind, the samples we missed are counted and skipped rather than read
+ *	late: the device only holds its latest sample anyway.
+ *
+ *	The sensors' output data rates can add up to more reads than the I2C
+ *	bus can carry (the BMX055 accelerometer and gyro alone run at 2 kHz),
+ *	which would only show up as missed samples. So warpSamplerInit() caps
+ *	the rates to share kWarpSamplerBusPercent of the bus between them,
+ *	counting kWarpSamplerReadBits for each read (address and register
+ *	byte, repeated start, and up to eight data bytes).
+ */
+enum
+{
+	kWarpSamplerWheelSlots		= 16,
+	kWarpSamplerSlotTicksShift	= 5,
+	kWarpSamplerSlotTicks		= 1 << kWarpSamplerSlotTicksShift,
+	kWarpSamplerReadBits		= 100,
+	kWarpSamplerBusPercent		= 50,
+};
+
+extern volatile uint32_t	gWarpI2cBaudRateKbps;
+
+static WarpSamplerSensor *	wheel[kWarpSamplerWheelSlots];
+static uint64_t			wheelSlotStart;
+static uint64_t			startTicks;
+static WarpSamplerSensor *	sensorTable;
+static size_t			sensorCount;
+
+
+static uint64_t
+sampleDueTicks(WarpSamplerSensor *  sensor, uint64_t sampleIndex)
+{
+	return startTicks + (sampleIndex * sensor->periodTicksNumerator) / sensor->periodTicksDenominator;
+}
+
+static void
+wheelInsert(WarpSamplerSensor *  sensor)
+{
+	size_t	slot = (sensor->dueTicks >> kWarpSamplerSlotTicksShift) & (kWarpSamplerWheelSlots - 1);
+
+	sensor->next	= wheel[slot];
+	wheel[slot]	= sensor;
+}
+
+/*
+ *	Move on to the first sample after now, counting any we skip over.
+ */
+static void
+scheduleNextSample(WarpSamplerSensor *  sensor, uint64_t now)
+{
+	uint64_t	sampleIndex = sensor->sampleIndex + 1;
+
+	if (sampleDueTicks(sensor, sampleIndex) <= now)
+	{
+		uint64_t	catchUpIndex = ((now - startTicks) * sensor->periodTicksDenominator) / sensor->periodTicksNumerator + 1;
+
+		sensor->missedSamples	+= catchUpIndex - sampleIndex;
+		sampleIndex		= catchUpIndex;
+	}
+
+	sensor->sampleIndex	= sampleIndex;
+	sensor->dueTicks	= sampleDueTicks(sensor, sampleIndex);
+}
+
+/*
+ *	Turn the wheel up to now, marking the sensors that fell due on the way.
+ *	A slot is only left behind once it lies wholly in the past, so a
+ *	sample rescheduled into the current slot is still seen next time.
+ */
+static bool
+collectDueSensors(uint64_t now)
+{
+	bool	anyDue = false;
+
+	while (1)
+	{
+		size_t			slot = (wheelSlotStart >> kWarpSamplerSlotTicksShift) & (kWarpSamplerWheelSlots - 1);
+		WarpSamplerSensor *	list = wheel[slot];
+
+		wheel[slot] = NULL;
+		while (list != NULL)
+		{
+			WarpSamplerSensor *	sensor = list;
+
+			list = sensor->next;
+			if (sensor->dueTicks <= now)
+			{
+				sensor->due	= true;
+				anyDue		= true;
+				scheduleNextSample(sensor, now);
+			}
+			wheelInsert(sensor);
+		}
+
+		if (wheelSlotStart + kWarpSamplerSlotTicks > now)
+		{
+			break;
+		}
+		wheelSlotStart += kWarpSamplerSlotTicks;
+	}
+
+	return anyDue;
+}
+
+/*
+ *	The earliest due time on the wheel. Slots are searched from the current
+ *	one onwards and the search stops at the first slot that holds a sample
+ *	due in this revolution.
+ */
+static uint64_t
+nextDueTicks(void)
+{
+	uint64_t	earliest = UINT64_MAX;
+
+	for (size_t i = 0; i < kWarpSamplerWheelSlots; i++)
+	{
+		uint64_t	slotStart = wheelSlotStart + i * kWarpSamplerSlotTicks;
+		size_t		slot = (slotStart >> kWarpSamplerSlotTicksShift) & (kWarpSamplerWheelSlots - 1);
+
+		for (WarpSamplerSensor * sensor = wheel[slot]; sensor != NULL; sensor = sensor->next)
+		{
+			if (sensor->dueTicks < earliest)
+			{
+				earliest = sensor->dueTicks;
+			}
+		}
+
+		if (earliest < slotStart + kWarpSamplerSlotTicks)
+		{
+			break;
+		}
+	}
+
+	return earliest;
+}
+
+/*
+ *	The highest rate at which the sensors' reads fit in the bus budget:
+ *	sensors slower than it keep their rate, and the rest share what is left
+ *	equally.
+ */
+static uint32_t
+busRateCap(WarpSamplerSensor *  sensors, size_t count)
+{
+	uint32_t	budget = (gWarpI2cBaudRateKbps * 1000 / kWarpSamplerReadBits) * kWarpSamplerBusPercent / 100;
+	uint32_t	total = 0;
+	uint32_t	cap;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		total += sensors[i].rateHz;
+	}
+	if (count == 0 || total <= budget)
+	{
+		return UINT16_MAX;
+	}
+
+	cap = budget / count;
+	for (;;)
+	{
+		uint32_t	slowReads = 0;
+		uint32_t	fastSensors = 0;
+		uint32_t	newCap;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (sensors[i].rateHz <= cap)
+			{
+				slowReads += sensors[i].rateHz;
+			}
+			else
+			{
+				fastSensors++;
+			}
+		}
+
+		/*
+		 *	The slow sensors leave the fast ones more than their share,
+		 *	which may in turn make more of them slow.
+		 */
+		newCap = (budget - slowReads) / fastSensors;
+		if (newCap <= cap)
+		{
+			break;
+		}
+		cap = newCap;
+	}
+
+	return (cap == 0) ? 1 : cap;
+}
+
+/*
+ *	Register sensors (the table is kept, and its order is the order their
+ *	reads are submitted in) and start their schedules, with every sensor's
+ *	first sample due now. Rates are capped so the bus keeps up (see above),
+ *	and if minimumPeriodMilliseconds is non-zero, no sensor is sampled more
+ *	often than that.
+ */
+void
+warpSamplerInit(WarpSamplerSensor *  sensors, size_t count, uint32_t minimumPeriodMilliseconds)
+{
+	uint32_t	ticksPerSecond = warpTimeTicksPerSecond();
+	uint32_t	cap = busRateCap(sensors, count);
+
+	for (size_t i = 0; i < kWarpSamplerWheelSlots; i++)
+	{
+		wheel[i] = NULL;
+	}
+
+	sensorTable	= sensors;
+	sensorCount	= count;
+	startTicks	= warpTimeNowTicks();
+	wheelSlotStart	= startTicks & ~((uint64_t)kWarpSamplerSlotTicks - 1);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		WarpSamplerSensor *	sensor = &sensors[i];
+
+		sensor->sampledRateHz = (sensor->rateHz < cap) ? sensor->rateHz : cap;
+		if (minimumPeriodMilliseconds * sensor->sampledRateHz > 1000)
+		{
+			sensor->sampledRateHz		= 1000 / minimumPeriodMilliseconds;
+			sensor->periodTicksNumerator	= minimumPeriodMilliseconds * ticksPerSecond;
+			sensor->periodTicksDenominator	= 1000;
+		}
+		else
+		{
+			sensor->periodTicksNumerator	= ticksPerSecond;
+			sensor->periodTicksDenominator	= sensor->sampledRateHz;
+		}
+
+		sensor->due		= false;
+		sensor->sampleIndex	= 0;
+		sensor->dueTicks	= startTicks;
+		sensor->missedSamples	= 0;
+		wheelInsert(sensor);
+	}
+}
+
+/*
+ *	Sleep until the next sample is due, then mark the due sensors (their
+ *	due flag stays set until the next call) and submit their reads. Reads
+ *	of sensors without a queueSample routine are left to printSample.
+ */
+void
+warpSamplerNextRound(void)
+{
+	for (size_t i = 0; i < sensorCount; i++)
+	{
+		sensorTable[i].due = false;
+	}
+
+	while (!collectDueSensors(warpTimeNowTicks()))
+	{
+		uint64_t	deadline = nextDueTicks();
+
+		INT_SYS_DisableIRQGlobal();
+		if (warpTimeNowTicks() < deadline)
+		{
+			warpTimeSleep(deadline);
+		}
+		INT_SYS_EnableIRQGlobal();
+	}
+
+	for (size_t i = 0; i < sensorCount; i++)
+	{
+		if (sensorTable[i].due && (sensorTable[i].queueSample != NULL))
+		{
+			sensorTable[i].queueSample();
+		}
+	}
+}
@@ -0,0 +1,107 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "fsl_device_registers.h"
+
+#include "warp.h"
+
+
+/*
+ *	Single-producer, single-consumer ring of WarpSampleRecords, between
+ *	acquisition (typically an interrupt, e.g. an I2C completion callback)
+ *	and an output stage in task context (RTT, telemetry, a flash log).
+ *
+ *	Neither side copies a record: the producer reserves the next free
+ *	record, fills it in place, and publishes it; the consumer peeks at the
+ *	oldest published record, uses it where it lies, and releases it. Only
+ *	the producer writes head and only the consumer writes tail, so neither
+ *	needs to mask interrupts. On the single-core KL03 the barriers only
+ *	have to stop the compiler moving the record's accesses across the
+ *	index updates; __DMB() does that and costs one instruction.
+ *
+ *	When the ring is full the new sample is dropped and counted, rather
+ *	than overwriting the oldest, which the consumer may still be reading.
+ */
+
+
+/*
+ *	length must be a power of two, at most 128, as the indices run freely
+ *	through 0-255.
+ */
+void
+warpSampleRingInit(WarpSampleRing *  ring, WarpSampleRecord *  records, uint8_t length)
+{
+	ring->records	= records;
+	ring->length	= length;
+	ring->head	= 0;
+	ring->tail	= 0;
+	ring->overruns	= 0;
+}
+
+/*
+ *	Producer: the record to fill next, or NULL (counting an overrun) if
+ *	the ring is full. It is not visible to the consumer until published,
+ *	so a producer that finds it has nothing to publish can just not.
+ */
+WarpSampleRecord *
+warpSampleRingReserve(WarpSampleRing *  ring)
+{
+	uint8_t		head = ring->head;
+
+	if ((uint8_t)(head - ring->tail) == ring->length)
+	{
+		ring->overruns++;
+
+		return NULL;
+	}
+
+	return &ring->records[head & (ring->length - 1)];
+}
+
+/*
+ *	Producer: hand the reserved record over to the consumer.
+ */
+void
+warpSampleRingPublish(WarpSampleRing *  ring)
+{
+	__DMB();
+	ring->head++;
+}
+
+/*
+ *	Consumer: the oldest published record, or NULL if there is none. It
+ *	stays valid until released.
+ */
+const WarpSampleRecord *
+warpSampleRingPeek(WarpSampleRing *  ring)
+{
+	uint8_t		tail = ring->tail;
+
+	if (tail == ring->head)
+	{
+		return NULL;
+	}
+	__DMB();
+
+	return &ring->records[tail & (ring->length - 1)];
+}
+
+/*
+ *	Consumer: done with the record from warpSampleRingPeek().
+ */
+void
+warpSampleRingRelease(WarpSampleRing *  ring)
+{
+	__DMB();
+	ring->tail++;
+}
+
+/*
+ *	Samples dropped because the ring was full.
+ */
+uint32_t
+warpSampleRingOverruns(WarpSampleRing *  ring)
+{
+	return ring->overruns;
+}
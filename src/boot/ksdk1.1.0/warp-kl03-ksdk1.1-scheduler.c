@@ -0,0 +1,172 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "fsl_device_registers.h"
+#include "fsl_interrupt_manager.h"
+
+#include "warp.h"
+
+
+/*
+ *	A run-to-completion cooperative scheduler. Each task is a function that
+ *	is called with the event flags raised for it since its last run (by
+ *	other tasks, by interrupt handlers through warpTaskSignal(), or by its
+ *	one-shot timer) and that returns without blocking, keeping whatever
+ *	state it needs between runs in its WarpTask. Tasks run round-robin in
+ *	the order they were added. When no task has events pending, the core
+ *	sleeps (see warpTimeSleep()) until the earliest timer or an interrupt,
+ *	in VLPS only if no I2C transfer, SSD1331 transfer or reaction timing is
+ *	in flight, as those need clocks that VLPS stops.
+ */
+static WarpTask *	taskListHead;
+static WarpTask *	taskListTail;
+
+
+void
+warpSchedulerAddTask(WarpTask *  task, WarpTaskFunction run)
+{
+	task->run		= run;
+	task->events		= 0;
+	task->timerArmed	= false;
+	task->state		= 0;
+	task->next		= NULL;
+
+	if (taskListHead == NULL)
+	{
+		taskListHead = task;
+	}
+	else
+	{
+		taskListTail->next = task;
+	}
+	taskListTail = task;
+}
+
+/*
+ *	Raise events for a task. Safe to call from interrupt handlers.
+ */
+void
+warpTaskSignal(WarpTask *  task, uint32_t events)
+{
+	INT_SYS_DisableIRQGlobal();
+	task->events |= events;
+	INT_SYS_EnableIRQGlobal();
+}
+
+/*
+ *	(Re)start the task's one-shot timer, which raises kWarpTaskEventTimer.
+ */
+void
+warpTaskStartTimer(WarpTask *  task, uint32_t milliseconds)
+{
+	task->timerDeadline	= warpTimeNowTicks() + warpTimeMillisecondsToTicks(milliseconds);
+	task->timerArmed	= true;
+}
+
+void
+warpTaskStopTimer(WarpTask *  task)
+{
+	task->timerArmed = false;
+}
+
+static uint32_t
+takeEvents(WarpTask *  task)
+{
+	uint32_t	events;
+
+	INT_SYS_DisableIRQGlobal();
+	events = task->events;
+	task->events = 0;
+	INT_SYS_EnableIRQGlobal();
+
+	return events;
+}
+
+/*
+ *	Expire due timers and return the earliest deadline still pending.
+ */
+static uint64_t
+serviceTimers(void)
+{
+	uint64_t	now = warpTimeNowTicks();
+	uint64_t	earliest = UINT64_MAX;
+
+	for (WarpTask * task = taskListHead; task != NULL; task = task->next)
+	{
+		if (!task->timerArmed)
+		{
+			continue;
+		}
+
+		if (now >= task->timerDeadline)
+		{
+			task->timerArmed = false;
+			warpTaskSignal(task, kWarpTaskEventTimer);
+		}
+		else if (task->timerDeadline < earliest)
+		{
+			earliest = task->timerDeadline;
+		}
+	}
+
+	return earliest;
+}
+
+/*
+ *	Call with interrupts masked.
+ */
+static bool
+eventsPending(void)
+{
+	for (WarpTask * task = taskListHead; task != NULL; task = task->next)
+	{
+		if (task->events != 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ *	Does not return.
+ */
+void
+warpSchedulerRun(void)
+{
+	while (1)
+	{
+		uint64_t	earliestDeadline = serviceTimers();
+		bool		ranTask = false;
+
+		for (WarpTask * task = taskListHead; task != NULL; task = task->next)
+		{
+			uint32_t	events = takeEvents(task);
+
+			if (events != 0)
+			{
+				task->run(task, events);
+				ranTask = true;
+			}
+		}
+
+		if (ranTask)
+		{
+			continue;
+		}
+
+		/*
+		 *	Only sleep if nothing was signalled since we looked; an interrupt
+		 *	after this check still wakes us, as interrupts stay masked until
+		 *	after the sleep.
+		 */
+		INT_SYS_DisableIRQGlobal();
+		if (!eventsPending())
+		{
+			warpTimeSleep(earliestDeadline);
+		}
+		INT_SYS_EnableIRQGlobal();
+	}
+}
@@ -0,0 +1,216 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "fsl_device_registers.h"
+
+#include "SEGGER_RTT.h"
+#include "warp.h"
+
+
+/*
+ *	Binary telemetry. Rather than formatting every value as text into the
+ *	terminal's up-buffer, streams write each record as one frame (see
+ *	WarpTelemetryFrameLayout) to their own RTT up-channel, which the host
+ *	reads with JLinkRTTLogger and tools/telemetrydecode turns into CSV.
+ *
+ *	The channel is in SEGGER_RTT_MODE_NO_BLOCK_SKIP mode, so a frame that
+ *	does not fit is dropped whole rather than truncated. Every frame
+ *	attempted takes the next sequence number, so the decoder sees drops as
+ *	gaps. Time deltas are from the last frame that was written, so drops do
+ *	not disturb the time of later frames; a time frame goes out first, when
+ *	the delta would not fit in 16 bits, and at least every 256 frames.
+ *
+ *	warpLog() (see warp.h) puts tokenized text records on the same channel.
+ *
+ *	Call from task context only.
+ */
+enum
+{
+	kWarpTelemetryBufferBytes		= 128,
+	kWarpTelemetryMaxDeltaMicroseconds	= 0xFFFF,
+};
+
+static uint8_t		channelBuffer[kWarpTelemetryBufferBytes];
+static uint8_t		sequence;
+static bool		timeBaseWritten;
+static uint32_t		lastWrittenMicroseconds;
+static uint32_t		droppedFrames;
+
+
+/*
+ *	CRC-16/CCITT-FALSE (polynomial 0x1021; start with crc = 0xFFFF), a
+ *	nibble at a time: a 16-entry table rather than 256 keeps it small.
+ */
+uint16_t
+warpTelemetryCrc16(uint16_t crc, const uint8_t *  bytes, size_t count)
+{
+	static const uint16_t	nibbleTable[16] =
+	{
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+		0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+	};
+
+	for (size_t i = 0; i < count; i++)
+	{
+		crc = (crc << 4) ^ nibbleTable[((crc >> 12) ^ (bytes[i] >> 4)) & 0x0F];
+		crc = (crc << 4) ^ nibbleTable[((crc >> 12) ^ bytes[i]) & 0x0F];
+	}
+
+	return crc;
+}
+
+static bool
+writeFrame(WarpTelemetryRecordType type, uint16_t deltaMicroseconds, const uint8_t *  payload, uint8_t payloadBytes)
+{
+	uint8_t		frame[kWarpTelemetryMaxFrameBytes];
+	size_t		frameBytes = kWarpTelemetryHeaderBytes + payloadBytes;
+	uint16_t	crc;
+
+	frame[0] = kWarpTelemetrySyncByte;
+	frame[1] = type;
+	frame[2] = sequence++;
+	frame[3] = payloadBytes;
+	frame[4] = deltaMicroseconds & 0xFF;
+	frame[5] = deltaMicroseconds >> 8;
+	for (size_t i = 0; i < payloadBytes; i++)
+	{
+		frame[kWarpTelemetryHeaderBytes + i] = payload[i];
+	}
+
+	/*
+	 *	Over everything after the sync byte.
+	 */
+	crc = warpTelemetryCrc16(0xFFFF, &frame[1], frameBytes - 1);
+	frame[frameBytes++] = crc & 0xFF;
+	frame[frameBytes++] = crc >> 8;
+
+	if (SEGGER_RTT_Write(kWarpTelemetryRttChannel, frame, frameBytes) != frameBytes)
+	{
+		droppedFrames++;
+
+		return false;
+	}
+
+	return true;
+}
+
+static bool
+writeTimeFrame(uint32_t timeMicroseconds)
+{
+	uint8_t		payload[4];
+
+	payload[0] = timeMicroseconds & 0xFF;
+	payload[1] = (timeMicroseconds >> 8) & 0xFF;
+	payload[2] = (timeMicroseconds >> 16) & 0xFF;
+	payload[3] = timeMicroseconds >> 24;
+
+	if (!writeFrame(kWarpTelemetryRecordTime, 0, payload, sizeof(payload)))
+	{
+		return false;
+	}
+
+	timeBaseWritten		= true;
+	lastWrittenMicroseconds	= timeMicroseconds;
+
+	return true;
+}
+
+void
+warpTelemetryInit(void)
+{
+	SEGGER_RTT_ConfigUpBuffer(kWarpTelemetryRttChannel, "Telemetry", channelBuffer, sizeof(channelBuffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+}
+
+/*
+ *	Write a frame timed at timeMicroseconds, preceded by a time frame if
+ *	its delta needs one.
+ */
+static bool
+writeTimedFrame(WarpTelemetryRecordType type, uint32_t timeMicroseconds, const uint8_t *  payload, uint8_t payloadBytes)
+{
+	uint32_t	deltaMicroseconds;
+
+	deltaMicroseconds = timeMicroseconds - lastWrittenMicroseconds;
+	if (!timeBaseWritten || (deltaMicroseconds > kWarpTelemetryMaxDeltaMicroseconds) || (sequence == 0))
+	{
+		if (!writeTimeFrame(timeMicroseconds))
+		{
+			droppedFrames++;
+			sequence++;
+
+			return false;
+		}
+		deltaMicroseconds = 0;
+	}
+
+	if (!writeFrame(type, deltaMicroseconds, payload, payloadBytes))
+	{
+		return false;
+	}
+
+	lastWrittenMicroseconds = timeMicroseconds;
+
+	return true;
+}
+
+/*
+ *	Write one record of up to kWarpTelemetryMaxFields fields, timed at
+ *	timeMicroseconds (e.g., from warpTimeNowUs(); times must not go
+ *	backwards). Returns false if it was dropped.
+ */
+bool
+warpTelemetryWrite(WarpTelemetryRecordType type, uint32_t timeMicroseconds, const int16_t *  fields, uint8_t fieldCount)
+{
+	uint8_t		payload[kWarpTelemetryMaxPayloadBytes];
+
+	if (fieldCount > kWarpTelemetryMaxFields)
+	{
+		fieldCount = kWarpTelemetryMaxFields;
+	}
+
+	for (uint8_t i = 0; i < fieldCount; i++)
+	{
+		payload[2*i]		= (uint16_t)fields[i] & 0xFF;
+		payload[2*i + 1]	= (uint16_t)fields[i] >> 8;
+	}
+
+	return writeTimedFrame(type, timeMicroseconds, payload, 2 * fieldCount);
+}
+
+/*
+ *	The back end of warpLog(): token is the format string's address in
+ *	.warplog, which starts at zero, so its low 16 bits are all of it.
+ */
+bool
+warpTelemetryWriteLog(uint32_t token, uint32_t timeMicroseconds, const uint32_t *  arguments, uint8_t argumentCount)
+{
+	uint8_t		payload[kWarpTelemetryMaxPayloadBytes];
+
+	if (argumentCount > kWarpTelemetryMaxLogArguments)
+	{
+		argumentCount = kWarpTelemetryMaxLogArguments;
+	}
+
+	payload[0] = token & 0xFF;
+	payload[1] = (token >> 8) & 0xFF;
+	for (uint8_t i = 0; i < argumentCount; i++)
+	{
+		payload[2 + 4*i]	= arguments[i] & 0xFF;
+		payload[2 + 4*i + 1]	= (arguments[i] >> 8) & 0xFF;
+		payload[2 + 4*i + 2]	= (arguments[i] >> 16) & 0xFF;
+		payload[2 + 4*i + 3]	= arguments[i] >> 24;
+	}
+
+	return writeTimedFrame(kWarpTelemetryRecordLog, timeMicroseconds, payload, 2 + 4 * argumentCount);
+}
+
+/*
+ *	Frames that did not fit in the channel buffer, counting records whose
+ *	time frame did not fit as dropped too.
+ */
+uint32_t
+warpTelemetryDroppedFrames(void)
+{
+	return droppedFrames;
+}
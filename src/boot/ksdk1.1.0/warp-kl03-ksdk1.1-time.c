@@ -0,0 +1,396 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fsl_device_registers.h"
+#include "fsl_interrupt_manager.h"
+#include "fsl_clock_manager.h"
+#include "fsl_lptmr_hal.h"
+#include "fsl_os_abstraction.h"
+#include "fsl_power_manager.h"
+
+#include "warp.h"
+#include "devSSD1331.h"
+
+
+/*
+ *	A monotonic 64-bit timebase. The KSDK's bare-metal OSA runs the LPTMR
+ *	from the 1 kHz LPO and returns its raw 16-bit count, so OSA_TimeGetMsec()
+ *	wraps every 65.5 s and has 1 ms resolution. We instead clock the LPTMR
+ *	from ERCLK32K (the same 32.768 kHz clock as the RTC, so it needs no
+ *	further calibration), giving 30.5 us ticks, and extend its count in
+ *	software: the counter resets on each compare match and LPTMR0_IRQHandler()
+ *	adds the elapsed period to counterBase. The LPTMR keeps counting in all
+ *	of the low-power modes we use.
+ *
+ *	The compare normally sits at the top of the 16-bit range (a match every
+ *	2 s). OSA_TimeDelay() moves it to the end of the delay and sleeps until
+ *	the match, and warpTimeSetAlarm() moves it to an alarm's deadline, where
+ *	LPTMR0_IRQHandler() calls the alarm's function. If ERCLK32K turns out
+ *	not to be running, we fall back to the LPO, i.e., the OSA's own 1 ms
+ *	ticks.
+ */
+enum
+{
+	kWarpTimeCounterPeriod		= 1 << 16,
+	kWarpTimeClockCheckReads	= 20000,
+
+	/*
+	 *	The first increment after (re-)enabling the LPTMR takes one or two
+	 *	extra clock cycles to synchronize. We count one of them, so a
+	 *	restart never moves the time forward and loses at most one tick.
+	 */
+	kWarpTimeRestartTicks		= 1,
+};
+
+/*
+ *	Tick conversions as (ticks * multiplier) >> shift. For ERCLK32K,
+ *	1e6 / 32768 = 15625 / 512 and 1000 / 32768 = 125 / 4096. The
+ *	initial values match the LPO configuration OSA_Init() leaves behind,
+ *	so the functions below work before warpTimeInit() too.
+ */
+typedef struct
+{
+	uint16_t	multiplier;
+	uint8_t		shift;
+} WarpTimeTickScale;
+
+static WarpTimeTickScale	microsecondScale	= {1000, 0};
+static WarpTimeTickScale	millisecondScale	= {1, 0};
+static uint32_t			ticksPerSecond		= 1000;
+static bool			initialized;
+
+/*
+ *	Only changed with interrupts masked or from LPTMR0_IRQHandler().
+ */
+static uint64_t			counterBase;
+static uint32_t			counterPeriod		= kWarpTimeCounterPeriod;
+static uint64_t			wakeDeadline;
+
+/*
+ *	The one pending alarm, or NULL.
+ */
+static uint64_t			alarmDeadline;
+static WarpTimeAlarmFunction	alarmFunction;
+
+
+static void	armWakeUp(uint64_t deadline);
+
+void
+LPTMR0_IRQHandler(void)
+{
+	if (LPTMR_HAL_IsIntPending(LPTMR0_BASE))
+	{
+		counterBase += counterPeriod;
+
+		/*
+		 *	A delay's wake-up match: go back to the long period. With the
+		 *	flag still set we may change the compare value on the fly.
+		 */
+		if (counterPeriod != kWarpTimeCounterPeriod)
+		{
+			counterPeriod = kWarpTimeCounterPeriod;
+			LPTMR_HAL_SetCompareValue(LPTMR0_BASE, counterPeriod - 1);
+		}
+
+		LPTMR_HAL_ClearIntFlag(LPTMR0_BASE);
+
+		/*
+		 *	The alarm's function may set the next alarm, so clear it first.
+		 *	An alarm that is not yet due may have been passed over for an
+		 *	earlier wake-up: move the compare back to it.
+		 */
+		if (alarmFunction != NULL)
+		{
+			if (counterBase >= alarmDeadline)
+			{
+				WarpTimeAlarmFunction	function = alarmFunction;
+
+				alarmFunction = NULL;
+				function();
+			}
+			else if (alarmDeadline - counterBase < kWarpTimeCounterPeriod)
+			{
+				armWakeUp(alarmDeadline);
+			}
+		}
+	}
+}
+
+static void
+startCounter(clock_lptmr_src_t source)
+{
+	LPTMR_HAL_Disable(LPTMR0_BASE);
+	LPTMR_HAL_SetTimerModeMode(LPTMR0_BASE, kLptmrTimerModeTimeCounter);
+	LPTMR_HAL_SetFreeRunningCmd(LPTMR0_BASE, false);
+	LPTMR_HAL_SetPrescalerCmd(LPTMR0_BASE, false);
+	LPTMR_HAL_SetPrescalerClockSourceMode(LPTMR0_BASE, source);
+	LPTMR_HAL_SetCompareValue(LPTMR0_BASE, kWarpTimeCounterPeriod - 1);
+	LPTMR_HAL_SetIntCmd(LPTMR0_BASE, true);
+	LPTMR_HAL_Enable(LPTMR0_BASE);
+}
+
+/*
+ *	Switch the LPTMR (set up by OSA_Init(), which must be called first)
+ *	over to ERCLK32K, check that it is counting, and enable the compare
+ *	interrupt. Time restarts from zero. Call after POWER_SYS_Init(): from
+ *	here on, OSA_TimeDelay() sleeps.
+ */
+void
+warpTimeInit(void)
+{
+	bool	counting = false;
+
+	CLOCK_SYS_EnableLptimerClock(0);
+	INT_SYS_DisableIRQ(LPTMR0_IRQn);
+
+	startCounter(kClockLptmrSrcEr32kClk);
+	for (int i = 0; i < kWarpTimeClockCheckReads; i++)
+	{
+		if (LPTMR_HAL_GetCounterValue(LPTMR0_BASE) != 0)
+		{
+			counting = true;
+			break;
+		}
+	}
+
+	if (counting)
+	{
+		microsecondScale.multiplier	= 15625;
+		microsecondScale.shift		= 9;
+		millisecondScale.multiplier	= 125;
+		millisecondScale.shift		= 12;
+		ticksPerSecond			= 32768;
+	}
+	else
+	{
+		startCounter(kClockLptmrSrcLpoClk);
+	}
+
+	counterBase	= 0;
+	counterPeriod	= kWarpTimeCounterPeriod;
+	initialized	= true;
+	LPTMR_HAL_ClearIntFlag(LPTMR0_BASE);
+	INT_SYS_EnableIRQ(LPTMR0_IRQn);
+}
+
+/*
+ *	Call with interrupts masked. A match that has happened but whose
+ *	interrupt has not yet been taken still counts, unless the counter value
+ *	we read is the one from just before it.
+ */
+static uint64_t
+readTicks(void)
+{
+	uint32_t	counter = LPTMR_HAL_GetCounterValue(LPTMR0_BASE);
+
+	if (!initialized)
+	{
+		return counter;
+	}
+
+	if (LPTMR_HAL_IsIntPending(LPTMR0_BASE) && (counter != counterPeriod - 1))
+	{
+		return counterBase + counterPeriod + counter;
+	}
+
+	return counterBase + counter;
+}
+
+/*
+ *	Call with interrupts masked. Stopping the LPTMR is the only way to move
+ *	the compare while the counter is running, and it zeroes the counter, so
+ *	fold the count into counterBase first. We stop just after an increment,
+ *	so the part-tick we lose is as small as we can make it.
+ */
+static void
+armWakeUp(uint64_t deadline)
+{
+	uint32_t	counter = LPTMR_HAL_GetCounterValue(LPTMR0_BASE);
+	uint64_t	now;
+
+	while (LPTMR_HAL_GetCounterValue(LPTMR0_BASE) == counter)
+	{
+	}
+
+	now = readTicks();
+	LPTMR_HAL_Disable(LPTMR0_BASE);
+	counterBase	= now + kWarpTimeRestartTicks;
+	counterPeriod	= (deadline > counterBase) ? (deadline - counterBase) : 1;
+	wakeDeadline	= deadline;
+	LPTMR_HAL_SetCompareValue(LPTMR0_BASE, counterPeriod - 1);
+	LPTMR_HAL_Enable(LPTMR0_BASE);
+}
+
+/*
+ *	WAIT keeps every peripheral clock running. VLPS stops the bus clock and
+ *	the HIRC, so only use it when no I2C transfer, SSD1331 SPI transfer or
+ *	reaction timing is in flight. The LPTMR's clock runs in both.
+ */
+static WarpPowerMode
+delaySleepMode(void)
+{
+	if (!warpI2cBusy() && !devSSD1331busy() && !warpReactionTimerRunning())
+	{
+		return kWarpPowerModeVLPS;
+	}
+
+	if (POWER_SYS_GetCurrentMode() == kPowerManagerVlpr)
+	{
+		return kWarpPowerModeVLPW;
+	}
+
+	return kWarpPowerModeWAIT;
+}
+
+/*
+ *	Ticks since warpTimeInit().
+ */
+uint64_t
+warpTimeNowTicks(void)
+{
+	uint64_t	ticks;
+
+	INT_SYS_DisableIRQGlobal();
+	ticks = readTicks();
+	INT_SYS_EnableIRQGlobal();
+
+	return ticks;
+}
+
+uint32_t
+warpTimeTicksPerSecond(void)
+{
+	return ticksPerSecond;
+}
+
+uint64_t
+warpTimeNowUs(void)
+{
+	return (warpTimeNowTicks() * microsecondScale.multiplier) >> microsecondScale.shift;
+}
+
+/*
+ *	Milliseconds, wrapping after 49.7 days.
+ */
+uint32_t
+warpTimeNowMs(void)
+{
+	return (warpTimeNowTicks() * millisecondScale.multiplier) >> millisecondScale.shift;
+}
+
+/*
+ *	These replace the KSDK bare-metal OSA's versions (we link with
+ *	-z muldefs, and our objects come before libksdk_platform.a), so the
+ *	KSDK drivers' timeouts use this timebase too. The OSA's time_diff()
+ *	assumes a 16-bit range but only matters when the count wraps, which is
+ *	now after 49.7 days rather than 65.5 s.
+ */
+uint32_t
+OSA_TimeGetMsec(void)
+{
+	return warpTimeNowMs();
+}
+
+/*
+ *	Sleep once, until deadline (in ticks) or the next interrupt, whichever
+ *	is first: arm the LPTMR compare for the deadline and sleep through
+ *	warpSetLowPowerMode(). Call with interrupts masked (and unmask them
+ *	afterwards to take the wake-up), so that an interrupt arriving after the
+ *	caller's last check still wakes us. Returns at once if less than a
+ *	millisecond remains, before warpTimeInit(), or while the cycle counter
+ *	is running (it stops in every sleep mode), so that callers spin.
+ */
+void
+warpTimeSleep(uint64_t deadline)
+{
+	uint64_t	now = readTicks();
+
+	if (!initialized || warpCycleCounterRunning() || (now >= deadline) || (deadline - now <= ticksPerSecond / 1000))
+	{
+		return;
+	}
+
+	/*
+	 *	Wake for a pending alarm too, if it is earlier.
+	 */
+	if ((alarmFunction != NULL) && (alarmDeadline < deadline))
+	{
+		deadline = (alarmDeadline > now) ? alarmDeadline : now + 1;
+	}
+
+	/*
+	 *	Beyond one counter period, the periodic match wakes us in time to
+	 *	arm the real one.
+	 */
+	if ((deadline - now < kWarpTimeCounterPeriod) &&
+		((counterPeriod == kWarpTimeCounterPeriod) || (wakeDeadline != deadline)))
+	{
+		armWakeUp(deadline);
+	}
+
+	warpSetLowPowerMode(delaySleepMode(), 0 /* sleep seconds : woken by the LPTMR */);
+}
+
+/*
+ *	Call function from LPTMR0_IRQHandler() once deadline (in ticks) has
+ *	passed, replacing any alarm already set. Interrupt-driven work uses this
+ *	to wait without blocking; the core may sleep meanwhile, even in VLPS,
+ *	as the LPTMR keeps counting. May be called from an interrupt handler.
+ */
+WarpStatus
+warpTimeSetAlarm(uint64_t deadline, WarpTimeAlarmFunction function)
+{
+	if (!initialized)
+	{
+		return kWarpStatusDeviceNotInitialized;
+	}
+
+	INT_SYS_DisableIRQGlobal();
+	alarmDeadline	= deadline;
+	alarmFunction	= function;
+	if (deadline < counterBase + counterPeriod)
+	{
+		armWakeUp(deadline);
+	}
+	INT_SYS_EnableIRQGlobal();
+
+	return kWarpStatusOK;
+}
+
+/*
+ *	Rounded up, so a delay is never short.
+ */
+uint64_t
+warpTimeMillisecondsToTicks(uint32_t milliseconds)
+{
+	return ((uint64_t)milliseconds * ticksPerSecond + 999) / 1000;
+}
+
+/*
+ *	Sleep, rather than spin, for delay milliseconds. Any interrupt other
+ *	than our own wakes us early and we go back to sleep. The last
+ *	millisecond (and everything before warpTimeInit()) is spun.
+ */
+void
+OSA_TimeDelay(uint32_t delay)
+{
+	uint64_t	deadline = warpTimeNowTicks() + warpTimeMillisecondsToTicks(delay);
+
+	while (1)
+	{
+		bool	expired;
+
+		INT_SYS_DisableIRQGlobal();
+		expired = (readTicks() >= deadline);
+		if (!expired)
+		{
+			warpTimeSleep(deadline);
+		}
+		INT_SYS_EnableIRQGlobal();
+
+		if (expired)
+		{
+			break;
+		}
+	}
+}
@@ -108,6 +108,12 @@ typedef enum
 	kWarpStatusErrorPowerSysSetmode,
 	kWarpStatusBadPowerModeSpecified,
 
+	/*
+	 *	Timing
+	 */
+	kWarpStatusTimeout,
+	kWarpStatusPending,
+
 
 	/*
 	 *	Always keep this as the last item.
@@ -167,8 +173,12 @@ typedef enum
 typedef enum
 {
 	kWarpSizesI2cBufferBytes		= 4,
-	kWarpSizesSpiBufferBytes		= 3,
+	kWarpSizesSpiBufferBytes		= 5,
 	kWarpSizesBME680CalibrationValuesCount	= 41,
+	kWarpSizesAMG8834Pixels			= 64,
+	kWarpSizesAMG8834FrameBytes		= 128,
+	kWarpSizesMMA8451QFifoSamples		= 32,
+	kWarpSizesL3GD20HFifoSamples		= 32,
 } WarpSizes;
 
 typedef struct
@@ -180,16 +190,261 @@ typedef struct
 	WarpStatus		deviceStatus;
 } WarpI2CDeviceState;
 
+typedef enum
+{
+	kWarpI2cDirectionWrite		= 0,
+	kWarpI2cDirectionRead		= 1,
+
+	/*
+	 *	Read without first writing deviceRegister, for devices (e.g., the
+	 *	INA219) that keep their register pointer between reads.
+	 */
+	kWarpI2cDirectionReadAtPointer	= 2,
+} WarpI2cDirection;
+
+/*
+ *	Descriptor for one register read or write on the asynchronous I2C
+ *	queue (see warpI2cSubmit()). The caller owns it and its buffer.
+ */
+typedef struct WarpI2cTransaction
+{
+	uint8_t				i2cAddress;
+	uint8_t				deviceRegister;
+	WarpI2cDirection		direction;
+	uint8_t *			buffer;
+	size_t				numberOfBytes;
+	void				(* callback)(struct WarpI2cTransaction *  transaction);
+
+	/*
+	 *	Set by the queue.
+	 */
+	volatile bool			done;
+	volatile WarpStatus		status;
+	struct WarpI2cTransaction *	next;
+} WarpI2cTransaction;
+
+/*
+ *	A task for the cooperative scheduler (see warpSchedulerRun()). The task
+ *	function gets the events raised since its last run and must return
+ *	without blocking. Bits from kWarpTaskEventFirstUser up are the task's
+ *	own to define.
+ */
+typedef enum
+{
+	kWarpTaskEventTimer		= 1 << 0,
+	kWarpTaskEventFirstUser		= 1 << 1,
+} WarpTaskEvent;
+
+typedef struct WarpTask
+{
+	void				(* run)(struct WarpTask *  task, uint32_t events);
+
+	/*
+	 *	For the task's own state machine.
+	 */
+	uint8_t				state;
+
+	/*
+	 *	Set by the scheduler.
+	 */
+	volatile uint32_t		events;
+	uint64_t			timerDeadline;
+	bool				timerArmed;
+	struct WarpTask *		next;
+} WarpTask;
+
+typedef void (* WarpTaskFunction)(WarpTask *  task, uint32_t events);
+
+typedef void (* WarpTimeAlarmFunction)(void);
+
+typedef enum
+{
+	kWarpButtonOnboard		= 0,
+	kWarpButtonOffboard		= 1,
+} WarpButton;
+
+typedef enum
+{
+	kWarpButtonEventPress		= 0,
+	kWarpButtonEventRelease		= 1,
+
+	/*
+	 *	On board button pressed while the off board one is held.
+	 */
+	kWarpButtonEventChord		= 2,
+} WarpButtonEventType;
+
+typedef struct
+{
+	WarpButton			button;
+	WarpButtonEventType		type;
+	uint64_t			timeMicroseconds;
+} WarpButtonEvent;
+
+/*
+ *	A sensor on the multi-rate sampler (see warpSamplerNextRound()).
+ *	rateHz is the output data rate the sensor is configured for, and must
+ *	not be zero. queueSample submits a read on the I2C queue; leave it NULL
+ *	for sensors whose printSample reads synchronously. columns is the
+ *	number of fields printSample prints.
+ */
+typedef struct WarpSamplerSensor
+{
+	const char *			name;
+	uint16_t			rateHz;
+	uint8_t				columns;
+	WarpStatus			(* queueSample)(void);
+	void				(* printSample)(bool hexModeFlag);
+
+	/*
+	 *	Set by the sampler. sampledRateHz is rateHz, lowered if need be so
+	 *	that the I2C bus keeps up (see warpSamplerInit()). due marks the
+	 *	sensors sampled in the current round; missedSamples counts samples
+	 *	skipped because we fell behind.
+	 */
+	uint16_t			sampledRateHz;
+	bool				due;
+	uint32_t			missedSamples;
+	uint64_t			sampleIndex;
+	uint64_t			dueTicks;
+	uint32_t			periodTicksNumerator;
+	uint32_t			periodTicksDenominator;
+	struct WarpSamplerSensor *	next;
+} WarpSamplerSensor;
+
+/*
+ *	Sensors whose data-ready outputs drive kWarpPinSensorDataReady (see
+ *	warpDataReadyAddSensor()).
+ */
+typedef enum
+{
+	kWarpDataReadyMMA8451Q		= 0,
+	kWarpDataReadyL3GD20H		= 1,
+	kWarpDataReadyBMX055accel	= 2,
+	kWarpDataReadyBMX055gyro	= 3,
+	kWarpDataReadySensorCount,
+} WarpDataReadySensor;
+
+/*
+ *	What to read when a sensor may have new data: numberOfBytes registers
+ *	from deviceRegister, covering its X/Y/Z output and its data-ready
+ *	status. decode returns whether the status shows a new sample and, if
+ *	so, its raw axes.
+ */
+typedef struct
+{
+	volatile WarpI2CDeviceState *	deviceState;
+	uint8_t				deviceRegister;
+	uint8_t				numberOfBytes;
+	bool				(* decode)(const uint8_t *  registerValues, int16_t *  axes);
+} WarpDataReadySource;
+
+typedef enum
+{
+	kWarpSampleRecordMaxFields		= 3,
+} WarpSampleRecordLayout;
+
+/*
+ *	One sample in a WarpSampleRing (see warp-kl03-ksdk1.1-samplering.c).
+ *	Fixed size, 12 bytes, so that a ring of them fits the KL03's RAM.
+ */
+typedef struct
+{
+	/*
+	 *	From warpTimeNowUs() (for the data-ready sensors, of the data-ready
+	 *	edge); wraps after 71 minutes.
+	 */
+	uint32_t			timeMicroseconds;
+	uint8_t				source;		/*	e.g., a WarpDataReadySensor	*/
+	uint8_t				fieldCount;
+	int16_t				fields[kWarpSampleRecordMaxFields];
+} WarpSampleRecord;
+
+typedef struct
+{
+	WarpSampleRecord *		records;
+	uint8_t				length;
+	volatile uint8_t		head;
+	volatile uint8_t		tail;
+	volatile uint32_t		overruns;
+} WarpSampleRing;
+
+/*
+ *	Binary telemetry frames (see warp-kl03-ksdk1.1-telemetry.c), all
+ *	multi-byte values little endian:
+ *
+ *		sync, type, sequence, payload bytes, time delta (2), payload, CRC (2)
+ */
+typedef enum
+{
+	kWarpTelemetrySyncByte			= 0xA5,
+	kWarpTelemetryRttChannel		= 1,
+	kWarpTelemetryHeaderBytes		= 6,
+	kWarpTelemetryCrcBytes			= 2,
+	kWarpTelemetryMaxFields			= 9,
+	kWarpTelemetryMaxLogArguments		= 16,
+	kWarpTelemetryMaxPayloadBytes		= 2 + 4 * kWarpTelemetryMaxLogArguments,
+	kWarpTelemetryMaxFrameBytes		= kWarpTelemetryHeaderBytes + kWarpTelemetryMaxPayloadBytes + kWarpTelemetryCrcBytes,
+} WarpTelemetryFrameLayout;
+
+/*
+ *	Frame types. A time frame carries the absolute time (us, 32 bits) and
+ *	restarts the deltas; a log frame carries a warpLog() token (16 bits)
+ *	and its arguments (32 bits each); the others carry packed int16_t
+ *	fields.
+ */
+typedef enum
+{
+	kWarpTelemetryRecordTime		= 0x00,
+	kWarpTelemetryRecordINA219Current	= 0x01,
+	kWarpTelemetryRecordLog			= 0x02,
+
+	/*
+	 *	The BMX055 FIFO stream's samples: raw accel X, Y, Z, gyro X, Y, Z
+	 *	and mag X, Y, Z.
+	 */
+	kWarpTelemetryRecordBMX055NineAxis	= 0x03,
+
+	/*
+	 *	Plus a WarpDataReadySensor: raw X, Y, Z.
+	 */
+	kWarpTelemetryRecordDataReadyFirst	= 0x10,
+} WarpTelemetryRecordType;
+
+/*
+ *	Tokenized logging: like SEGGER_RTT_printf(0, format, ...) with up to
+ *	kWarpTelemetryMaxLogArguments integer arguments, but the format string
+ *	goes into the non-loaded .warplog section (see MKL03Z32xxx4_flash.ld)
+ *	and only its address there, as a token, and the raw arguments go out
+ *	on the telemetry channel. tools/telemetrydecode formats the text on
+ *	the host, from the strings in the ELF. format must be a literal.
+ */
+#define	warpLog(format, ...)											\
+	do														\
+	{														\
+		static const char	warpLogFormat[] __attribute__((section(".warplog"), used)) = format;		\
+		const uint32_t		warpLogArguments[] = {0, ##__VA_ARGS__};					\
+															\
+		warpTelemetryWriteLog((uint32_t)warpLogFormat, (uint32_t)warpTimeNowUs(), &warpLogArguments[1],	\
+			sizeof(warpLogArguments)/sizeof(warpLogArguments[0]) - 1);					\
+	} while (0)
+
 typedef enum
 {
 	kWarpSensorConfigurationRegisterMMA8451QF_SETUP			= 0x09,
 	kWarpSensorConfigurationRegisterMMA8451QCTRL_REG1		= 0x2A,
+	kWarpSensorConfigurationRegisterMMA8451QCTRL_REG3		= 0x2C,
+	kWarpSensorConfigurationRegisterMMA8451QCTRL_REG4		= 0x2D,
+	kWarpSensorConfigurationRegisterMMA8451QCTRL_REG5		= 0x2E,
 
 	kWarpSensorConfigurationRegisterMAG3110CTRL_REG1		= 0x10,
 	kWarpSensorConfigurationRegisterMAG3110CTRL_REG2		= 0x11,
 
 	kWarpSensorConfigurationRegisterHDC1000Configuration		= 0x02,
 
+	kWarpSensorConfigurationRegisterINA219Configuration		= 0x00,
+	kWarpSensorConfigurationRegisterINA219Calibration		= 0x05,
+
 	kWarpSensorConfigurationRegisterAMG8834PCTL			= 0x00,
 	kWarpSensorConfigurationRegisterAMG8834RST			= 0x01,
 	kWarpSensorConfigurationRegisterAMG8834FPSC			= 0x02,
@@ -202,16 +457,29 @@ typedef enum
 	kWarpSensorConfigurationRegisterBMX055accelPMU_LPW		= 0x11,
 	kWarpSensorConfigurationRegisterBMX055accelPMU_LOW_POWER	= 0x12,
 	kWarpSensorConfigurationRegisterBMX055accelACCD_HBW		= 0x13,
+	kWarpSensorConfigurationRegisterBMX055accelINT_EN_1		= 0x17,
+	kWarpSensorConfigurationRegisterBMX055accelINT_MAP_1		= 0x1A,
+	kWarpSensorConfigurationRegisterBMX055accelINT_OUT_CTRL		= 0x20,
+	kWarpSensorConfigurationRegisterBMX055accelFIFO_CONFIG_1	= 0x3E,
 	kWarpSensorConfigurationRegisterBMX055magPowerCtrl		= 0x4B,
 	kWarpSensorConfigurationRegisterBMX055magOpMode			= 0x4C,
 	kWarpSensorConfigurationRegisterBMX055gyroRANGE			= 0x0F,
 	kWarpSensorConfigurationRegisterBMX055gyroBW			= 0x10,
 	kWarpSensorConfigurationRegisterBMX055gyroLPM1			= 0x11,
 	kWarpSensorConfigurationRegisterBMX055gyroRATE_HBW		= 0x13,
+	kWarpSensorConfigurationRegisterBMX055gyroINT_EN_0		= 0x15,
+	kWarpSensorConfigurationRegisterBMX055gyroINT_EN_1		= 0x16,
+	kWarpSensorConfigurationRegisterBMX055gyroINT_MAP_1		= 0x18,
+	kWarpSensorConfigurationRegisterBMX055gyroFIFO_WM_INT		= 0x1E,
+	kWarpSensorConfigurationRegisterBMX055gyroFIFO_CONFIG_0		= 0x3D,
+	kWarpSensorConfigurationRegisterBMX055gyroFIFO_CONFIG_1		= 0x3E,
 
 	kWarpSensorConfigurationRegisterL3GD20HCTRL1			= 0x20,
 	kWarpSensorConfigurationRegisterL3GD20HCTRL2			= 0x21,
+	kWarpSensorConfigurationRegisterL3GD20HCTRL3			= 0x22,
 	kWarpSensorConfigurationRegisterL3GD20HCTRL5			= 0x24,
+	kWarpSensorConfigurationRegisterL3GD20HFIFO_CTRL		= 0x2E,
+	kWarpSensorConfigurationRegisterL3GD20HLOW_ODR			= 0x39,
 
 	kWarpSensorConfigurationRegisterBME680Reset			= 0xE0,
 	kWarpSensorConfigurationRegisterBME680Config			= 0x75,
@@ -228,6 +496,7 @@ typedef enum
 
 typedef enum
 {
+	kWarpSensorOutputRegisterMMA8451QSTATUS				= 0x00,
 	kWarpSensorOutputRegisterMMA8451QOUT_X_MSB			= 0x01,
 	kWarpSensorOutputRegisterMMA8451QOUT_X_LSB			= 0x02,
 	kWarpSensorOutputRegisterMMA8451QOUT_Y_MSB			= 0x03,
@@ -261,12 +530,17 @@ typedef enum
 	kWarpSensorOutputRegisterBMX055accelACCD_Z_LSB			= 0x06,
 	kWarpSensorOutputRegisterBMX055accelACCD_Z_MSB			= 0x07,
 	kWarpSensorOutputRegisterBMX055accelACCD_TEMP			= 0x08,
+	kWarpSensorOutputRegisterBMX055accelFIFO_STATUS			= 0x0E,
+	kWarpSensorOutputRegisterBMX055accelFIFO_DATA			= 0x3F,
 	kWarpSensorOutputRegisterBMX055gyroRATE_X_LSB			= 0x02,
 	kWarpSensorOutputRegisterBMX055gyroRATE_X_MSB			= 0x03,
 	kWarpSensorOutputRegisterBMX055gyroRATE_Y_LSB			= 0x04,
 	kWarpSensorOutputRegisterBMX055gyroRATE_Y_MSB			= 0x05,
 	kWarpSensorOutputRegisterBMX055gyroRATE_Z_LSB			= 0x06,
 	kWarpSensorOutputRegisterBMX055gyroRATE_Z_MSB			= 0x07,
+	kWarpSensorOutputRegisterBMX055gyroINT_STATUS_1			= 0x0A,
+	kWarpSensorOutputRegisterBMX055gyroFIFO_STATUS			= 0x0E,
+	kWarpSensorOutputRegisterBMX055gyroFIFO_DATA			= 0x3F,
 	kWarpSensorOutputRegisterBMX055magX_LSB				= 0x42,
 	kWarpSensorOutputRegisterBMX055magX_MSB				= 0x43,
 	kWarpSensorOutputRegisterBMX055magY_LSB				= 0x44,
@@ -277,12 +551,14 @@ typedef enum
 	kWarpSensorOutputRegisterBMX055magRHALL_MSB			= 0x49,
 
 	kWarpSensorOutputRegisterL3GD20HOUT_TEMP			= 0x26,
+	kWarpSensorOutputRegisterL3GD20HSTATUS				= 0x27,
 	kWarpSensorOutputRegisterL3GD20HOUT_X_L				= 0x28,
 	kWarpSensorOutputRegisterL3GD20HOUT_X_H				= 0x29,
 	kWarpSensorOutputRegisterL3GD20HOUT_Y_L				= 0x2A,
 	kWarpSensorOutputRegisterL3GD20HOUT_Y_H				= 0x2B,
 	kWarpSensorOutputRegisterL3GD20HOUT_Z_L				= 0x2C,
 	kWarpSensorOutputRegisterL3GD20HOUT_Z_H				= 0x2D,
+	kWarpSensorOutputRegisterL3GD20HFIFO_SRC			= 0x2F,
 
 	kWarpSensorOutputRegisterBME680press_msb			= 0x1F,
 	kWarpSensorOutputRegisterBME680press_lsb			= 0x20,
@@ -292,6 +568,11 @@ typedef enum
 	kWarpSensorOutputRegisterBME680temp_xlsb			= 0x24,
 	kWarpSensorOutputRegisterBME680hum_msb				= 0x25,
 	kWarpSensorOutputRegisterBME680hum_lsb				= 0x26,
+
+	kWarpSensorOutputRegisterINA219ShuntVoltage			= 0x01,
+	kWarpSensorOutputRegisterINA219BusVoltage			= 0x02,
+	kWarpSensorOutputRegisterINA219Power				= 0x03,
+	kWarpSensorOutputRegisterINA219Current				= 0x04,
 } WarpSensorOutputRegister;
 
 typedef struct
@@ -341,8 +622,94 @@ typedef struct
 	uint8_t		outputBuffer[kWarpThermalChamberMMA8451QOutputBufferSize];
 } WarpThermalChamberKL03MemoryFill;
 
+/*
+ *	The KL03 has no FPU, so conversions from register counts to physical
+ *	units are an integer multiply and shift (see
+ *	warp-kl03-ksdk1.1-fixedpoint.c).
+ */
+typedef enum
+{
+	kWarpFixedPointScaleINA219ShuntMicrovolts,
+	kWarpFixedPointScaleINA219ShuntMicroamps,
+	kWarpFixedPointScaleINA219BusMillivolts,
+	kWarpFixedPointScaleINA219CurrentMicroamps,
+	kWarpFixedPointScaleAMG8834PixelQ8,
+	kWarpFixedPointScaleAMG8834ThermistorQ8,
+	kWarpFixedPointScaleMMA8451QMilliG,
+	kWarpFixedPointScaleBMX055accelMilliG,
+
+	/*
+	 *	Always keep this as the last item.
+	 */
+	kWarpFixedPointScaleMax,
+} WarpFixedPointScale;
+
 WarpStatus	warpSetLowPowerMode(WarpPowerMode powerMode, uint32_t sleepSeconds);
 void		enableI2Cpins(uint16_t pullupValue);
 void		disableI2Cpins(void);
 void		enableSPIpins(void);
 void		disableSPIpins(void);
+void		warpCycleCounterStart(void);
+void		warpCycleCounterStop(void);
+bool		warpCycleCounterRunning(void);
+uint32_t	warpCycleCounterRead(void);
+int32_t		warpFixedPointConvert(int32_t raw, WarpFixedPointScale scale);
+int32_t		warpFixedPointSignExtend(uint32_t raw, uint8_t bits);
+void		warpFixedPointBenchmark(void);
+WarpStatus	warpReactionTimerStart(void);
+WarpStatus	warpReactionTimerWait(uint32_t timeoutMicroseconds, uint32_t *  reactionMicroseconds);
+WarpStatus	warpReactionTimerPoll(uint32_t timeoutMicroseconds, uint32_t *  reactionMicroseconds);
+uint32_t	warpReactionTimerElapsedTicks(uint32_t overflowCount, bool overflowPending, uint16_t counter);
+uint32_t	warpReactionTimerTicksToMicroseconds(uint32_t ticks);
+bool		warpReactionTimerRunning(void);
+void		warpTimeInit(void);
+uint64_t	warpTimeNowTicks(void);
+uint64_t	warpTimeNowUs(void);
+uint32_t	warpTimeNowMs(void);
+uint32_t	warpTimeTicksPerSecond(void);
+uint64_t	warpTimeMillisecondsToTicks(uint32_t milliseconds);
+void		warpTimeSleep(uint64_t deadline);
+WarpStatus	warpTimeSetAlarm(uint64_t deadline, WarpTimeAlarmFunction function);
+WarpStatus	warpI2cSubmit(WarpI2cTransaction *  transaction);
+WarpStatus	warpI2cWait(WarpI2cTransaction *  transaction);
+WarpStatus	warpI2cWaitIdle(void);
+bool		warpI2cBusy(void);
+void		warpSchedulerAddTask(WarpTask *  task, WarpTaskFunction run);
+void		warpSchedulerRun(void);
+void		warpTaskSignal(WarpTask *  task, uint32_t events);
+void		warpTaskStartTimer(WarpTask *  task, uint32_t milliseconds);
+void		warpTaskStopTimer(WarpTask *  task);
+void		warpButtonsInit(WarpTask *  subscriber, uint32_t subscriberEventFlags);
+bool		warpButtonsTakeEvent(WarpButtonEvent *  event);
+uint32_t	warpButtonsEventOverruns(void);
+void		warpSamplerInit(WarpSamplerSensor *  sensors, size_t count, uint32_t minimumPeriodMilliseconds);
+void		warpSamplerNextRound(void);
+void		warpDataReadyAddSensor(WarpDataReadySensor sensor, const WarpDataReadySource *  source);
+void		warpDataReadyInit(WarpTask *  subscriber, uint32_t subscriberEventFlags);
+void		warpDataReadyPinInterrupt(void);
+void		warpDataReadyWatch(WarpTask *  task, uint32_t events);
+void		warpDataReadyRelease(void);
+uint32_t	warpDataReadyEdgeMicroseconds(void);
+WarpSampleRing *	warpDataReadySamples(void);
+uint32_t	warpDataReadyOverruns(WarpDataReadySensor sensor);
+void		warpTelemetryInit(void);
+bool		warpTelemetryWrite(WarpTelemetryRecordType type, uint32_t timeMicroseconds, const int16_t *  fields, uint8_t fieldCount);
+bool		warpTelemetryWriteLog(uint32_t token, uint32_t timeMicroseconds, const uint32_t *  arguments, uint8_t argumentCount);
+uint32_t	warpTelemetryDroppedFrames(void);
+uint16_t	warpTelemetryCrc16(uint16_t crc, const uint8_t *  bytes, size_t count);
+void		warpSampleRingInit(WarpSampleRing *  ring, WarpSampleRecord *  records, uint8_t length);
+WarpSampleRecord *	warpSampleRingReserve(WarpSampleRing *  ring);
+void		warpSampleRingPublish(WarpSampleRing *  ring);
+const WarpSampleRecord *	warpSampleRingPeek(WarpSampleRing *  ring);
+void		warpSampleRingRelease(WarpSampleRing *  ring);
+uint32_t	warpSampleRingOverruns(WarpSampleRing *  ring);
+void		warpCsvInt(int32_t value);
+void		warpCsvUnsigned(uint32_t value);
+void		warpCsvHex(uint32_t value, uint8_t byteCount);
+void		warpCsvMissing(void);
+void		warpCsvEmpty(void);
+void		warpCsvEndRow(void);
+void		warpCsvFlush(void);
+void		warpCsvBenchmark(void);
+WarpStatus	warpI2cReadBurst(uint8_t i2cAddress, uint8_t deviceRegister, uint8_t *  buffer, size_t numberOfBytes);
+WarpStatus	warpI2cWriteBurst(uint8_t i2cAddress, uint8_t deviceRegister, const uint8_t *  buffer, size_t numberOfBytes);
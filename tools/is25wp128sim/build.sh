@@ -0,0 +1,14 @@
+#!/bin/sh
+
+	#	Builds the host-side IS25WP128 model against the firmware's devIS25WP128.c.
+	#	Run from this directory; produces ./is25wp128sim.
+
+	SDK=../sdk/ksdk1.1.0/platform
+	SRC=../../src/boot/ksdk1.1.0
+
+	cc -std=gnu99 -O2 -Wall -fshort-enums -DCPU_MKL03Z32VFK4			\
+		-Wno-int-to-pointer-cast -Wno-pointer-to-int-cast -Wno-unused-function	\
+		-I$SRC -I$SDK/utilities/inc -I$SDK/osa/inc -I$SDK/CMSIS/Include		\
+		-I$SDK/CMSIS/Include/device -I$SDK/startup/MKL03Z4 -I$SDK/hal/inc	\
+		-I$SDK/drivers/inc -I$SDK/system/inc					\
+		is25wp128sim.c $SRC/devIS25WP128.c -o is25wp128sim
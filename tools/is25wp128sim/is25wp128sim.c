@@ -0,0 +1,592 @@
+/*
+ *	Host-side model of the IS25WP128 SPI NOR flash for exercising
+ *	src/boot/ksdk1.1.0/devIS25WP128.c without a board.
+ *
+ *	The driver is compiled unmodified against the stubs below, which stand
+ *	in for the KSDK GPIO, SPI and OSA calls and the Warp routines it uses.
+ *	Bytes on the SPI bus drive a model of the part: 16 MB of array, the
+ *	write-enable latch, program and erase busy times, page wrap-around,
+ *	deep power-down and its release time. Uses of the part that the
+ *	datasheet forbids (commands while busy or powered down, programs
+ *	without write enable, transfers with /CS or the SPI pins off) are
+ *	counted as violations, and each scenario checks what the driver
+ *	returns and what ends up in the array.
+ *
+ *	See README.md in this directory.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "fsl_spi_master_driver.h"
+#include "fsl_gpio_driver.h"
+
+#include "gpio_pins.h"
+#include "warp.h"
+#include "devIS25WP128.h"
+
+
+enum
+{
+	kIs25wp128simDefaultBaudRateKbps	= 200,
+	kIs25wp128simTransferOverheadUs		= 20,
+
+	/*
+	 *	Typical (not maximum) program and erase times, for throughput.
+	 */
+	kIs25wp128simPageProgramUs		= 200,
+	kIs25wp128simSectorEraseUs		= 70000,
+	kIs25wp128simBlockEraseUs		= 150000,
+
+	kIs25wp128simBenchmarkBytes		= 64 * 1024,
+};
+
+typedef struct
+{
+	uint64_t	spiBytes;
+	uint64_t	csAssertions;
+	uint64_t	transfers;
+	uint64_t	pagePrograms;
+	uint64_t	sectorErases;
+	uint64_t	blockErases;
+	uint64_t	violations;
+} Is25wp128simCounters;
+
+
+static uint8_t			array[kWarpIS25WP128CapacityBytes];
+
+static bool			writeEnabled;
+static bool			poweredDown;
+static uint64_t			busyUntilUs;
+static uint64_t			readyAfterReleaseUs;
+
+static uint8_t			command;
+static bool			commandIgnored;
+static uint32_t			byteIndex;
+static uint32_t			address;
+static uint8_t			pageBuffer[kWarpIS25WP128PageBytes];
+static bool			pageBufferWritten[kWarpIS25WP128PageBytes];
+static bool			pageWrapped;
+
+static bool			csLow;
+static bool			spiPinsEnabled;
+static uint64_t			nowUs;
+static uint32_t			baudRateKbps = kIs25wp128simDefaultBaudRateKbps;
+static Is25wp128simCounters	counters;
+
+static const char *		scenarioName = "none";
+static uint64_t			scenarioStartUs;
+static int			failures;
+
+
+static void
+violation(const char *  what)
+{
+	counters.violations++;
+	fprintf(stderr, "is25wp128sim: %s: %s\n", scenarioName, what);
+}
+
+static bool
+busy(void)
+{
+	return nowUs < busyUntilUs;
+}
+
+/*
+ *	Start of a /CS assertion: the first byte is the command.
+ */
+static void
+commandByte(uint8_t byte)
+{
+	command		= byte;
+	commandIgnored	= false;
+	address		= 0;
+	pageWrapped	= false;
+	memset(pageBufferWritten, 0, sizeof(pageBufferWritten));
+
+	if (poweredDown)
+	{
+		if (command != kWarpIS25WP128CommandReleasePowerDown)
+		{
+			violation("command in deep power-down");
+			commandIgnored = true;
+		}
+
+		return;
+	}
+
+	if (nowUs < readyAfterReleaseUs)
+	{
+		violation("command within tRES1 of Release Power-Down");
+	}
+
+	if (busy() && (command != kWarpIS25WP128CommandReadStatus))
+	{
+		violation("command while a program or erase is in progress");
+		commandIgnored = true;
+	}
+}
+
+/*
+ *	Every byte after the first, returning what the part drives on MISO.
+ */
+static uint8_t
+argumentByte(uint8_t byte)
+{
+	uint32_t	dataIndex;
+
+	if (commandIgnored)
+	{
+		return 0xFF;
+	}
+
+	switch (command)
+	{
+		case kWarpIS25WP128CommandReadStatus:
+		{
+			return (busy() ? kWarpIS25WP128StatusWIP : 0) | (writeEnabled ? kWarpIS25WP128StatusWEL : 0);
+		}
+
+		case kWarpIS25WP128CommandReadJedecId:
+		{
+			static const uint8_t	jedecId[] = {kWarpIS25WP128ManufacturerId, kWarpIS25WP128MemoryType, kWarpIS25WP128CapacityId};
+
+			return (byteIndex <= 3) ? jedecId[byteIndex - 1] : 0x00;
+		}
+
+		case kWarpIS25WP128CommandFastRead:
+		case kWarpIS25WP128CommandPageProgram:
+		case kWarpIS25WP128CommandSectorErase:
+		case kWarpIS25WP128CommandBlockErase:
+		{
+			if (byteIndex <= 3)
+			{
+				address = (address << 8) | byte;
+
+				return 0xFF;
+			}
+			break;
+		}
+
+		default:
+		{
+			return 0xFF;
+		}
+	}
+
+	if (command == kWarpIS25WP128CommandFastRead)
+	{
+		/*
+		 *	One dummy byte, then the array from address on, wrapping at the end.
+		 */
+		if (byteIndex == 4)
+		{
+			return 0xFF;
+		}
+
+		return array[(address + byteIndex - 5) & (kWarpIS25WP128CapacityBytes - 1)];
+	}
+
+	if (command == kWarpIS25WP128CommandPageProgram)
+	{
+		/*
+		 *	Data past the end of the page wraps round to its start, the
+		 *	later byte replacing the earlier.
+		 */
+		dataIndex = (address + byteIndex - 4) & (kWarpIS25WP128PageBytes - 1);
+		if (pageBufferWritten[dataIndex] && !pageWrapped)
+		{
+			violation("page program data wrapped within the page");
+			pageWrapped = true;
+		}
+		pageBuffer[dataIndex]		= byte;
+		pageBufferWritten[dataIndex]	= true;
+	}
+
+	return 0xFF;
+}
+
+/*
+ *	/CS rising: writes, erases and power transitions take effect.
+ */
+static void
+endCommand(void)
+{
+	uint32_t	base;
+
+	if (commandIgnored || (byteIndex == 0))
+	{
+		return;
+	}
+
+	switch (command)
+	{
+		case kWarpIS25WP128CommandWriteEnable:
+		{
+			writeEnabled = true;
+			break;
+		}
+
+		case kWarpIS25WP128CommandDeepPowerDown:
+		{
+			poweredDown = true;
+			break;
+		}
+
+		case kWarpIS25WP128CommandReleasePowerDown:
+		{
+			poweredDown		= false;
+			readyAfterReleaseUs	= nowUs + kWarpIS25WP128ReleaseMicroseconds;
+			break;
+		}
+
+		case kWarpIS25WP128CommandPageProgram:
+		{
+			if (!writeEnabled)
+			{
+				violation("page program without write enable");
+				break;
+			}
+
+			/*
+			 *	Programming only clears bits.
+			 */
+			base = address & ~(uint32_t)(kWarpIS25WP128PageBytes - 1) & (kWarpIS25WP128CapacityBytes - 1);
+			for (int i = 0; i < kWarpIS25WP128PageBytes; i++)
+			{
+				if (pageBufferWritten[i])
+				{
+					array[base + i] &= pageBuffer[i];
+				}
+			}
+			counters.pagePrograms++;
+			writeEnabled	= false;
+			busyUntilUs	= nowUs + kIs25wp128simPageProgramUs;
+			break;
+		}
+
+		case kWarpIS25WP128CommandSectorErase:
+		case kWarpIS25WP128CommandBlockErase:
+		{
+			uint32_t	bytes = (command == kWarpIS25WP128CommandSectorErase) ? kWarpIS25WP128SectorBytes : kWarpIS25WP128BlockBytes;
+
+			if (byteIndex != 4)
+			{
+				violation("erase without exactly three address bytes");
+				break;
+			}
+			if (!writeEnabled)
+			{
+				violation("erase without write enable");
+				break;
+			}
+
+			base = address & ~(bytes - 1) & (kWarpIS25WP128CapacityBytes - 1);
+			memset(&array[base], 0xFF, bytes);
+			if (command == kWarpIS25WP128CommandSectorErase)
+			{
+				counters.sectorErases++;
+				busyUntilUs = nowUs + kIs25wp128simSectorEraseUs;
+			}
+			else
+			{
+				counters.blockErases++;
+				busyUntilUs = nowUs + kIs25wp128simBlockEraseUs;
+			}
+			writeEnabled = false;
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+}
+
+
+/*
+ *	Stand-ins for what devIS25WP128.c uses from the KSDK and the rest of Warp.
+ */
+volatile WarpSPIDeviceState	deviceIS25WP128State;
+volatile uint32_t		gWarpSpiBaudRateKbps = kIs25wp128simDefaultBaudRateKbps;
+
+void
+GPIO_DRV_SetPinOutput(uint32_t pinName)
+{
+	if ((pinName == kWarpPinIS25WP128_nCS) && csLow)
+	{
+		csLow = false;
+		endCommand();
+	}
+}
+
+void
+GPIO_DRV_ClearPinOutput(uint32_t pinName)
+{
+	if ((pinName == kWarpPinIS25WP128_nCS) && !csLow)
+	{
+		counters.csAssertions++;
+		csLow		= true;
+		byteIndex	= 0;
+	}
+}
+
+void
+OSA_TimeDelay(uint32_t delay)
+{
+	nowUs += (uint64_t)delay * 1000;
+}
+
+/*
+ *	Time moves on a microsecond per look, so that busy-waits end.
+ */
+uint64_t
+warpTimeNowUs(void)
+{
+	return nowUs++;
+}
+
+/*
+ *	The bus belongs to the SSD1331's setup: the driver must not remux its
+ *	pins (PTB0 is the SSD1331's reset) or reinitialize the SPI master.
+ */
+void
+enableSPIpins(void)
+{
+	violation("reconfigured the SPI pins");
+	spiPinsEnabled = true;
+}
+
+void
+disableSPIpins(void)
+{
+	violation("reconfigured the SPI pins");
+	spiPinsEnabled = false;
+}
+
+spi_status_t
+SPI_DRV_MasterTransferBlocking(uint32_t instance, const spi_master_user_config_t * restrict device,
+			const uint8_t * restrict sendBuffer, uint8_t * restrict receiveBuffer,
+			size_t transferByteCount, uint32_t timeout)
+{
+	uint64_t	busUs = (uint64_t)transferByteCount * 8 * 1000 / baudRateKbps;
+
+	if (!csLow)
+	{
+		violation("transfer with /CS deasserted");
+	}
+	if (!spiPinsEnabled)
+	{
+		violation("transfer with the SPI pins disabled");
+	}
+	if (busUs / 1000 > timeout)
+	{
+		violation("transfer longer than its timeout");
+	}
+
+	counters.transfers++;
+	for (size_t i = 0; i < transferByteCount; i++)
+	{
+		uint8_t		sent = (sendBuffer != NULL) ? sendBuffer[i] : 0x00;
+		uint8_t		received;
+
+		if (byteIndex == 0)
+		{
+			commandByte(sent);
+			received = 0xFF;
+		}
+		else
+		{
+			received = argumentByte(sent);
+		}
+		byteIndex++;
+
+		if (receiveBuffer != NULL)
+		{
+			receiveBuffer[i] = received;
+		}
+	}
+	counters.spiBytes += transferByteCount;
+	nowUs += busUs + kIs25wp128simTransferOverheadUs;
+
+	return kStatus_SPI_Success;
+}
+
+
+static void
+beginScenario(const char *  name)
+{
+	scenarioName	= name;
+	scenarioStartUs	= nowUs;
+	memset(&counters, 0, sizeof(counters));
+}
+
+static void
+check(bool condition, const char *  what)
+{
+	if (!condition)
+	{
+		fprintf(stderr, "is25wp128sim: %s: %s\n", scenarioName, what);
+		failures++;
+	}
+}
+
+/*
+ *	Every driver call must leave the part in deep power-down, idle, and
+ *	the SPI pins as it found them. payloadBytes are the bytes read, programmed or
+ *	erased, for the throughput column.
+ */
+static void
+endScenario(uint64_t payloadBytes)
+{
+	uint64_t	elapsedUs = nowUs - scenarioStartUs;
+
+	check(poweredDown, "left the part out of deep power-down");
+	check(!csLow, "left /CS asserted");
+	check(spiPinsEnabled, "left the SPI pins disabled");
+	check(counters.violations == 0, "violated the datasheet");
+
+	printf("%-18s %9llu %9llu %6llu %6llu %5llu %4llu %4llu %12llu %9llu\n", scenarioName,
+		(unsigned long long)payloadBytes, (unsigned long long)counters.spiBytes,
+		(unsigned long long)counters.csAssertions, (unsigned long long)counters.transfers,
+		(unsigned long long)counters.pagePrograms, (unsigned long long)counters.sectorErases,
+		(unsigned long long)counters.blockErases, (unsigned long long)elapsedUs,
+		(unsigned long long)(elapsedUs ? payloadBytes * 1000000 / elapsedUs : 0));
+}
+
+static void
+fillRandom(uint8_t *  buffer, size_t bytes)
+{
+	for (size_t i = 0; i < bytes; i++)
+	{
+		buffer[i] = rand();
+	}
+}
+
+int
+main(int argc, char *  argv[])
+{
+	static uint8_t	data[kIs25wp128simBenchmarkBytes];
+	static uint8_t	readBack[kIs25wp128simBenchmarkBytes];
+	uint8_t		manufacturerId;
+	uint16_t	deviceId;
+	uint8_t		status;
+	uint32_t	start;
+	uint32_t	bytes;
+
+	if (argc > 1)
+	{
+		baudRateKbps = atoi(argv[1]);
+		gWarpSpiBaudRateKbps = baudRateKbps;
+	}
+	srand(1);
+
+	/*
+	 *	Power-up state: unknown contents (here all programmed to zero, so
+	 *	that erases show), not powered down.
+	 */
+	memset(array, 0x00, sizeof(array));
+
+	/*
+	 *	As devSSD1331init() leaves the bus, before the driver is used.
+	 */
+	spiPinsEnabled = true;
+
+	printf("%-18s %9s %9s %6s %6s %5s %4s %4s %12s %9s\n", "scenario", "bytes", "spi", "/CS", "xfers", "pp", "se", "be", "us", "B/s");
+
+	beginScenario("init");
+	initIS25WP128(&deviceIS25WP128State);
+	endScenario(0);
+
+	beginScenario("jedec-id");
+	check(readJedecIdIS25WP128(&manufacturerId, &deviceId) == kWarpStatusOK, "readJedecIdIS25WP128 failed");
+	check((manufacturerId == kWarpIS25WP128ManufacturerId) && (deviceId == 0x7018), "wrong JEDEC ID");
+	check(readStatusIS25WP128(&status) == kWarpStatusOK, "readStatusIS25WP128 failed");
+	check(status == 0, "status not idle");
+	endScenario(0);
+
+	/*
+	 *	An unaligned range that starts and ends mid-sector and mid-page and
+	 *	spans a whole 64 KB block: one sector erase, one block erase, one
+	 *	sector erase. Outside those sectors the array must be untouched.
+	 */
+	beginScenario("erase-range");
+	start = 0x2F0F3;
+	bytes = 0x11000;
+	check(eraseIS25WP128(start, bytes) == kWarpStatusOK, "eraseIS25WP128 failed");
+	check((counters.sectorErases == 2) && (counters.blockErases == 1), "wrong mix of sector and block erases");
+	for (uint32_t i = 0x2E000; i < 0x42000; i++)
+	{
+		bool	erased = (i >= 0x2F000) && (i < 0x41000);
+
+		if (array[i] != (erased ? 0xFF : 0x00))
+		{
+			check(false, "erased the wrong sectors");
+			break;
+		}
+	}
+	endScenario(0x12000);
+
+	/*
+	 *	400 bytes from a page offset of 200: three page programs.
+	 */
+	beginScenario("program-pages");
+	fillRandom(data, 400);
+	check(programIS25WP128(0x2F0C8, data, 400) == kWarpStatusOK, "programIS25WP128 failed");
+	check(counters.pagePrograms == 3, "not split at page boundaries");
+	check(memcmp(&array[0x2F0C8], data, 400) == 0, "programmed the wrong data");
+	check((array[0x2F0C7] == 0xFF) && (array[0x2F0C8 + 400] == 0xFF), "programmed outside the range");
+	endScenario(400);
+
+	beginScenario("read-back");
+	memset(readBack, 0, 400);
+	check(readIS25WP128(0x2F0C8, readBack, 400) == kWarpStatusOK, "readIS25WP128 failed");
+	check(memcmp(readBack, data, 400) == 0, "read the wrong data");
+	check(counters.csAssertions == 3, "read not in one burst");
+	endScenario(400);
+
+	beginScenario("bounds");
+	check(readIS25WP128(kWarpIS25WP128CapacityBytes - 1, readBack, 2) == kWarpStatusBadDeviceCommand, "read past the end accepted");
+	check(programIS25WP128(kWarpIS25WP128CapacityBytes, data, 1) == kWarpStatusBadDeviceCommand, "program past the end accepted");
+	check(eraseSectorIS25WP128(kWarpIS25WP128CapacityBytes) == kWarpStatusBadDeviceCommand, "erase past the end accepted");
+	check(counters.spiBytes == 0, "out-of-range call touched the bus");
+	endScenario(0);
+
+	/*
+	 *	Throughput over an aligned 64 KB block.
+	 */
+	fillRandom(data, sizeof(data));
+
+	beginScenario("erase-64k");
+	check(eraseIS25WP128(0x100000, sizeof(data)) == kWarpStatusOK, "eraseIS25WP128 failed");
+	check((counters.sectorErases == 0) && (counters.blockErases == 1), "aligned block not block-erased");
+	endScenario(sizeof(data));
+
+	beginScenario("erase-64k-sectors");
+	for (uint32_t i = 0; i < sizeof(data); i += kWarpIS25WP128SectorBytes)
+	{
+		check(eraseSectorIS25WP128(0x100000 + i) == kWarpStatusOK, "eraseSectorIS25WP128 failed");
+	}
+	endScenario(sizeof(data));
+
+	beginScenario("program-64k");
+	check(programIS25WP128(0x100000, data, sizeof(data)) == kWarpStatusOK, "programIS25WP128 failed");
+	endScenario(sizeof(data));
+
+	beginScenario("read-64k");
+	check(readIS25WP128(0x100000, readBack, sizeof(readBack)) == kWarpStatusOK, "readIS25WP128 failed");
+	check(memcmp(readBack, data, sizeof(data)) == 0, "read the wrong data");
+	endScenario(sizeof(data));
+
+	if (failures > 0)
+	{
+		fprintf(stderr, "is25wp128sim: %d checks failed\n", failures);
+
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,14 @@
+#!/bin/sh
+
+	#	Builds the host-side SSD1331 model against the firmware's devSSD1331.c.
+	#	Run from this directory; produces ./ssd1331sim.
+
+	SDK=../sdk/ksdk1.1.0/platform
+	SRC=../../src/boot/ksdk1.1.0
+
+	cc -std=gnu99 -O2 -Wall -fshort-enums -DCPU_MKL03Z32VFK4			\
+		-Wno-int-to-pointer-cast -Wno-pointer-to-int-cast -Wno-unused-function	\
+		-I$SRC -I$SDK/utilities/inc -I$SDK/osa/inc -I$SDK/CMSIS/Include		\
+		-I$SDK/CMSIS/Include/device -I$SDK/startup/MKL03Z4 -I$SDK/hal/inc	\
+		-I$SDK/drivers/inc -I$SDK/system/inc					\
+		ssd1331sim.c $SRC/devSSD1331.c -o ssd1331sim
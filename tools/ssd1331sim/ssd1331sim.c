@@ -0,0 +1,704 @@
+/*
+ *	Host-side model of the SSD1331 OLED controller for exercising
+ *	src/boot/ksdk1.1.0/devSSD1331.c without a board.
+ *
+ *	The driver is compiled unmodified against the stubs below, which stand
+ *	in for the KSDK GPIO, SPI and OSA calls it makes. Bytes written over SPI
+ *	are interpreted according to the state of the DC line (commands or
+ *	display RAM data) and rendered into a 96x64 RGB565 frame buffer, which
+ *	is written out as PPM. SPI bytes, /CS assertions, transfers and modelled
+ *	time are counted per scenario. The model also keeps the controller's
+ *	busy time after each graphic acceleration command and reports any
+ *	command that arrives before it has passed. Each scenario has a budget of SPI bytes
+ *	and transfers, and its final frame can be compared against a golden
+ *	image; the exit status is nonzero if any scenario fails either.
+ *
+ *	See README.md in this directory.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "fsl_spi_master_driver.h"
+#include "fsl_gpio_driver.h"
+
+#include "warp.h"
+#include "devSSD1331.h"
+
+
+enum
+{
+	kSsd1331simColumns		= 96,
+	kSsd1331simRows			= 64,
+	kSsd1331simMaxParameters	= 10,
+	kSsd1331simSnapshotDelayMs	= 100,
+	kSsd1331simSpiBaudRateKbps	= 200,
+	kSsd1331simTransferOverheadUs	= 20,
+	kSsd1331simPinCSn		= GPIO_MAKE_PIN(HW_GPIOB, 13),
+	kSsd1331simPinDC		= GPIO_MAKE_PIN(HW_GPIOA, 12),
+};
+
+typedef struct
+{
+	uint64_t	spiBytes;
+	uint64_t	dataBytes;
+	uint64_t	csAssertions;
+	uint64_t	transfers;
+	uint64_t	delayMs;
+	uint64_t	queuedDelayUs;
+} Ssd1331simCounters;
+
+
+static uint16_t			frame[kSsd1331simRows][kSsd1331simColumns];
+static bool			fillEnabled = true;
+static uint8_t			windowColumnStart, windowColumnEnd = kSsd1331simColumns - 1;
+static uint8_t			windowRowStart, windowRowEnd = kSsd1331simRows - 1;
+static uint8_t			cursorColumn, cursorRow;
+static uint8_t			dataHighByte;
+static bool			dataHighByteValid;
+
+static uint8_t			command;
+static int			parametersExpected = -1;
+static int			parametersReceived;
+static uint8_t			parameters[kSsd1331simMaxParameters];
+
+static bool			csLow;
+static bool			dcHigh;
+static Ssd1331simCounters	counters;
+
+/*
+ *	Modelled time, which is also the driver's tick count (one tick per
+ *	microsecond), and when the last graphic acceleration command finishes.
+ */
+static uint64_t			nowUs;
+static uint64_t			busyUntilUs;
+
+static const char *		scenarioName = "none";
+static uint64_t			scenarioByteBudget;
+static uint64_t			scenarioTransferBudget;
+static int			snapshotCount;
+static const char *		outputDirectory = ".";
+static const char *		goldenDirectory;
+static int			failures;
+
+
+/*
+ *	Number of parameter bytes following each command byte.
+ */
+static int
+parameterCount(uint8_t commandByte)
+{
+	switch (commandByte)
+	{
+		case kSSD1331CommandDRAWLINE:
+		{
+			return 7;
+		}
+		case kSSD1331CommandDRAWRECT:
+		{
+			return 10;
+		}
+		case kSSD1331CommandCLEAR:
+		{
+			return 4;
+		}
+		case kSSD1331CommandSETCOLUMN:
+		case kSSD1331CommandSETROW:
+		{
+			return 2;
+		}
+		case kSSD1331CommandFILL:
+		case kSSD1331CommandCONTRASTA:
+		case kSSD1331CommandCONTRASTB:
+		case kSSD1331CommandCONTRASTC:
+		case kSSD1331CommandMASTERCURRENT:
+		case kSSD1331CommandSETREMAP:
+		case kSSD1331CommandSTARTLINE:
+		case kSSD1331CommandDISPLAYOFFSET:
+		case kSSD1331CommandSETMULTIPLEX:
+		case kSSD1331CommandSETMASTER:
+		case kSSD1331CommandPOWERMODE:
+		case kSSD1331CommandPRECHARGE:
+		case kSSD1331CommandCLOCKDIV:
+		case kSSD1331CommandPRECHARGEA:
+		case kSSD1331CommandPRECHARGEB:
+		case kSSD1331CommandPRECHARGEC:
+		case kSSD1331CommandPRECHARGELEVEL:
+		case kSSD1331CommandVCOMH:
+		{
+			return 1;
+		}
+		default:
+		{
+			return 0;
+		}
+	}
+}
+
+/*
+ *	Colour bytes of the drawing commands are 6 bits each; red and blue use
+ *	the upper five of them in 65k colour mode.
+ */
+static uint16_t
+drawingColour(uint8_t red, uint8_t green, uint8_t blue)
+{
+	return (((red >> 1) & 0x1F) << 11) | ((green & 0x3F) << 5) | ((blue >> 1) & 0x1F);
+}
+
+static void
+setPixel(int column, int row, uint16_t colour)
+{
+	if ((column >= 0) && (column < kSsd1331simColumns) && (row >= 0) && (row < kSsd1331simRows))
+	{
+		frame[row][column] = colour;
+	}
+}
+
+static void
+fillWindow(int columnStart, int rowStart, int columnEnd, int rowEnd, uint16_t colour)
+{
+	for (int row = rowStart; row <= rowEnd; row++)
+	{
+		for (int column = columnStart; column <= columnEnd; column++)
+		{
+			setPixel(column, row, colour);
+		}
+	}
+}
+
+static void
+drawLine(int column0, int row0, int column1, int row1, uint16_t colour)
+{
+	int	deltaColumn = abs(column1 - column0);
+	int	deltaRow = -abs(row1 - row0);
+	int	stepColumn = (column0 < column1) ? 1 : -1;
+	int	stepRow = (row0 < row1) ? 1 : -1;
+	int	error = deltaColumn + deltaRow;
+
+	for (;;)
+	{
+		setPixel(column0, row0, colour);
+		if ((column0 == column1) && (row0 == row1))
+		{
+			break;
+		}
+		if (2*error >= deltaRow)
+		{
+			error += deltaRow;
+			column0 += stepColumn;
+		}
+		if (2*error <= deltaColumn)
+		{
+			error += deltaColumn;
+			row0 += stepRow;
+		}
+	}
+}
+
+static void
+executeCommand(void)
+{
+	uint8_t *	p = parameters;
+
+	switch (command)
+	{
+		case kSSD1331CommandDRAWLINE:
+		{
+			drawLine(p[0], p[1], p[2], p[3], drawingColour(p[4], p[5], p[6]));
+			break;
+		}
+		case kSSD1331CommandDRAWRECT:
+		{
+			uint16_t	outline = drawingColour(p[4], p[5], p[6]);
+
+			if (fillEnabled)
+			{
+				fillWindow(p[0], p[1], p[2], p[3], drawingColour(p[7], p[8], p[9]));
+			}
+			drawLine(p[0], p[1], p[2], p[1], outline);
+			drawLine(p[0], p[3], p[2], p[3], outline);
+			drawLine(p[0], p[1], p[0], p[3], outline);
+			drawLine(p[2], p[1], p[2], p[3], outline);
+			break;
+		}
+		case kSSD1331CommandCLEAR:
+		{
+			fillWindow(p[0], p[1], p[2], p[3], 0x0000);
+			break;
+		}
+		case kSSD1331CommandFILL:
+		{
+			fillEnabled = p[0] & 0x01;
+			break;
+		}
+		case kSSD1331CommandSETCOLUMN:
+		{
+			windowColumnStart = cursorColumn = p[0];
+			windowColumnEnd = p[1];
+			dataHighByteValid = false;
+			break;
+		}
+		case kSSD1331CommandSETROW:
+		{
+			windowRowStart = cursorRow = p[0];
+			windowRowEnd = p[1];
+			dataHighByteValid = false;
+			break;
+		}
+		default:
+		{
+			/*
+			 *	Configuration commands do not change the image.
+			 */
+			break;
+		}
+	}
+}
+
+static void
+commandByte(uint8_t byte)
+{
+	if (parametersExpected < 0)
+	{
+		if (nowUs < busyUntilUs)
+		{
+			fprintf(stderr, "ssd1331sim: %s: command 0x%02X %llu us before the last drawing command finished\n",
+				scenarioName, byte, (unsigned long long)(busyUntilUs - nowUs));
+			failures++;
+		}
+		command = byte;
+		parametersExpected = parameterCount(byte);
+		parametersReceived = 0;
+	}
+	else
+	{
+		parameters[parametersReceived++] = byte;
+	}
+
+	if (parametersReceived == parametersExpected)
+	{
+		executeCommand();
+		parametersExpected = -1;
+
+		if (command == kSSD1331CommandDRAWLINE)
+		{
+			busyUntilUs = nowUs + kSSD1331DelaysHWLINE * 1000;
+		}
+		else if ((command == kSSD1331CommandDRAWRECT) || (command == kSSD1331CommandCLEAR))
+		{
+			busyUntilUs = nowUs + kSSD1331DelaysHWFILL * 1000;
+		}
+	}
+}
+
+/*
+ *	Display RAM data: RGB565, high byte first, written at the cursor, which
+ *	advances horizontally and wraps within the SETCOLUMN/SETROW window.
+ */
+static void
+dataByte(uint8_t byte)
+{
+	if (!dataHighByteValid)
+	{
+		dataHighByte = byte;
+		dataHighByteValid = true;
+		return;
+	}
+	dataHighByteValid = false;
+
+	setPixel(cursorColumn, cursorRow, (dataHighByte << 8) | byte);
+
+	if (cursorColumn++ >= windowColumnEnd)
+	{
+		cursorColumn = windowColumnStart;
+		if (cursorRow++ >= windowRowEnd)
+		{
+			cursorRow = windowRowStart;
+		}
+	}
+}
+
+static const char	ppmHeader[] = "P6\n96 64\n255\n";
+
+/*
+ *	The frame as PPM pixel data, RGB565 widened to 8 bits a component.
+ */
+static void
+encodeFrame(uint8_t *  rgb)
+{
+	for (int row = 0; row < kSsd1331simRows; row++)
+	{
+		for (int column = 0; column < kSsd1331simColumns; column++)
+		{
+			uint16_t	pixel = frame[row][column];
+
+			*rgb++ = ((pixel >> 11) & 0x1F) * 255 / 0x1F;
+			*rgb++ = ((pixel >> 5) & 0x3F) * 255 / 0x3F;
+			*rgb++ = (pixel & 0x1F) * 255 / 0x1F;
+		}
+	}
+}
+
+static void
+writePpm(const char *  name)
+{
+	uint8_t	rgb[kSsd1331simRows * kSsd1331simColumns * 3];
+	char	path[256];
+	FILE *	file;
+
+	snprintf(path, sizeof(path), "%s/%s.ppm", outputDirectory, name);
+	file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+
+	encodeFrame(rgb);
+	fputs(ppmHeader, file);
+	fwrite(rgb, 1, sizeof(rgb), file);
+	fclose(file);
+}
+
+/*
+ *	Compare the frame with <golden-directory>/<name>.ppm, as written by
+ *	writePpm(), and count the pixels that differ.
+ */
+static void
+compareGolden(const char *  name)
+{
+	uint8_t	rgb[kSsd1331simRows * kSsd1331simColumns * 3];
+	uint8_t	golden[sizeof(ppmHeader) - 1 + sizeof(rgb)];
+	char	path[256];
+	FILE *	file;
+	size_t	goldenBytes;
+	int	differingPixels = 0;
+
+	snprintf(path, sizeof(path), "%s/%s.ppm", goldenDirectory, name);
+	file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		perror(path);
+		failures++;
+
+		return;
+	}
+	goldenBytes = fread(golden, 1, sizeof(golden), file);
+	fclose(file);
+
+	if ((goldenBytes != sizeof(golden)) || (memcmp(golden, ppmHeader, sizeof(ppmHeader) - 1) != 0))
+	{
+		fprintf(stderr, "ssd1331sim: %s: not a 96x64 PPM\n", path);
+		failures++;
+
+		return;
+	}
+
+	encodeFrame(rgb);
+	for (size_t i = 0; i < sizeof(rgb); i += 3)
+	{
+		if (memcmp(&rgb[i], &golden[sizeof(ppmHeader) - 1 + i], 3) != 0)
+		{
+			differingPixels++;
+		}
+	}
+
+	if (differingPixels != 0)
+	{
+		fprintf(stderr, "ssd1331sim: %s: %d pixels differ from %s\n", name, differingPixels, path);
+		failures++;
+	}
+}
+
+
+/*
+ *	Stand-ins for what devSSD1331.c uses from the KSDK and the rest of Warp.
+ */
+uint32_t	SystemCoreClock = 48000000;
+
+void
+GPIO_DRV_SetPinOutput(uint32_t pinName)
+{
+	if (pinName == kSsd1331simPinCSn)
+	{
+		csLow = false;
+	}
+	else if (pinName == kSsd1331simPinDC)
+	{
+		dcHigh = true;
+	}
+}
+
+void
+GPIO_DRV_ClearPinOutput(uint32_t pinName)
+{
+	if (pinName == kSsd1331simPinCSn)
+	{
+		if (!csLow)
+		{
+			counters.csAssertions++;
+		}
+		csLow = true;
+	}
+	else if (pinName == kSsd1331simPinDC)
+	{
+		dcHigh = false;
+	}
+}
+
+void
+OSA_TimeDelay(uint32_t delay)
+{
+	char	name[64];
+
+	counters.delayMs += delay;
+	nowUs += (uint64_t)delay * 1000;
+
+	/*
+	 *	Long delays are where the firmware leaves something on screen for
+	 *	the user to see, so keep a picture of it.
+	 */
+	if (delay >= kSsd1331simSnapshotDelayMs)
+	{
+		snprintf(name, sizeof(name), "%s-%d", scenarioName, snapshotCount++);
+		writePpm(name);
+		if (goldenDirectory != NULL)
+		{
+			compareGolden(name);
+		}
+	}
+}
+
+void	SPI0_IRQHandler(void);
+
+spi_status_t
+SPI_DRV_MasterTransfer(uint32_t instance, const spi_master_user_config_t * restrict device,
+			const uint8_t * restrict sendBuffer, uint8_t * restrict receiveBuffer, size_t transferByteCount)
+{
+	if (!csLow)
+	{
+		fprintf(stderr, "ssd1331sim: %s: transfer with /CS deasserted\n", scenarioName);
+	}
+
+	counters.transfers++;
+	nowUs += kSsd1331simTransferOverheadUs;
+	for (size_t i = 0; i < transferByteCount; i++)
+	{
+		counters.spiBytes++;
+		nowUs += 8 * 1000 / kSsd1331simSpiBaudRateKbps;
+		if (dcHigh)
+		{
+			counters.dataBytes++;
+			dataByte(sendBuffer[i]);
+		}
+		else
+		{
+			commandByte(sendBuffer[i]);
+		}
+	}
+
+	/*
+	 *	The transfer completes at once: run the completion interrupt.
+	 */
+	SPI0_IRQHandler();
+
+	return kStatus_SPI_Success;
+}
+
+spi_status_t
+SPI_DRV_MasterGetTransferStatus(uint32_t instance, uint32_t * bytesTransferred)
+{
+	return kStatus_SPI_Success;
+}
+
+void
+SPI_DRV_IRQHandler(uint32_t instance)
+{
+}
+
+void
+enableSPIpins(void)
+{
+}
+
+void
+warpCycleCounterStart(void)
+{
+}
+
+void
+warpCycleCounterStop(void)
+{
+}
+
+uint32_t
+warpCycleCounterRead(void)
+{
+	return 0;
+}
+
+uint64_t
+warpTimeNowTicks(void)
+{
+	return nowUs;
+}
+
+uint64_t
+warpTimeMillisecondsToTicks(uint32_t milliseconds)
+{
+	return (uint64_t)milliseconds * 1000;
+}
+
+/*
+ *	Nothing else happens meanwhile: move time on to the deadline and run the
+ *	alarm as the LPTMR interrupt would.
+ */
+WarpStatus
+warpTimeSetAlarm(uint64_t deadline, WarpTimeAlarmFunction function)
+{
+	if (deadline > nowUs)
+	{
+		counters.queuedDelayUs += deadline - nowUs;
+		nowUs = deadline;
+	}
+	function();
+
+	return kWarpStatusOK;
+}
+
+WarpStatus
+warpReactionTimerStart(void)
+{
+	return kWarpStatusOK;
+}
+
+int
+SEGGER_RTT_printf(unsigned bufferIndex, const char *  sFormat, ...)
+{
+	return 0;
+}
+
+
+/*
+ *	byteBudget and transferBudget are the most SPI bytes and transfers the
+ *	scenario may take; set them to what the driver takes now, so that a
+ *	change that sends more fails until the budget is deliberately raised.
+ */
+static void
+beginScenario(const char *  name, uint64_t byteBudget, uint64_t transferBudget)
+{
+	scenarioName = name;
+	scenarioByteBudget = byteBudget;
+	scenarioTransferBudget = transferBudget;
+	snapshotCount = 0;
+	memset(&counters, 0, sizeof(counters));
+}
+
+/*
+ *	Modelled time is the SPI shift time at kSsd1331simSpiBaudRateKbps plus a
+ *	fixed per-transfer setup cost, and separately the OSA_TimeDelay() total.
+ */
+static void
+endScenario(void)
+{
+	uint64_t	spiUs = (counters.spiBytes * 8 * 1000) / kSsd1331simSpiBaudRateKbps
+				+ counters.transfers * kSsd1331simTransferOverheadUs;
+
+	devSSD1331fenceCommands();
+	writePpm(scenarioName);
+	printf("%-16s %8llu %8llu %8llu %8llu %10llu %10llu %10llu\n", scenarioName,
+		(unsigned long long)counters.spiBytes, (unsigned long long)counters.dataBytes,
+		(unsigned long long)counters.csAssertions, (unsigned long long)counters.transfers,
+		(unsigned long long)spiUs, (unsigned long long)counters.queuedDelayUs,
+		(unsigned long long)counters.delayMs * 1000);
+
+	if (counters.spiBytes > scenarioByteBudget)
+	{
+		fprintf(stderr, "ssd1331sim: %s: %llu SPI bytes, over the budget of %llu\n", scenarioName,
+			(unsigned long long)counters.spiBytes, (unsigned long long)scenarioByteBudget);
+		failures++;
+	}
+	if (counters.transfers > scenarioTransferBudget)
+	{
+		fprintf(stderr, "ssd1331sim: %s: %llu transfers, over the budget of %llu\n", scenarioName,
+			(unsigned long long)counters.transfers, (unsigned long long)scenarioTransferBudget);
+		failures++;
+	}
+	if (goldenDirectory != NULL)
+	{
+		compareGolden(scenarioName);
+	}
+}
+
+int
+main(int argc, char *  argv[])
+{
+	int	timeBins[kSSD1331BarBins]	= {0, 0, 0, 0, 0, 1, 2, 4, 3, 2, 1, 1, 0, 0, 0, 1};
+	int	timeIndicator[kSSD1331BarBins]	= {1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1};
+	int	currentBins[kSSD1331BarBins]	= {0, 0, 5, 40, 31, 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+	int	currentIndicator[kSSD1331BarBins];
+
+	if (argc > 1)
+	{
+		outputDirectory = argv[1];
+	}
+	if (argc > 2)
+	{
+		goldenDirectory = argv[2];
+	}
+
+	for (int i = 0; i < kSSD1331BarBins; i++)
+	{
+		currentIndicator[i] = 1;
+	}
+
+	printf("%-16s %8s %8s %8s %8s %10s %10s %10s\n", "scenario", "bytes", "data", "/CS", "xfers", "spi-us", "queued-us", "delay-us");
+
+	beginScenario("countdown", 130, 15);
+	devSSD1331_countdown();
+	endScenario();
+
+	beginScenario("flash", 21, 3);
+	devSSD1331_flash(10);
+	endScenario();
+
+	beginScenario("axes", 365, 52);
+	devSSD1331_clearscreen();
+	devSSD1331_axes();
+	endScenario();
+
+	beginScenario("bars", 176, 19);
+	devSSD1331_bars(timeBins, timeIndicator, kSSD1331BarBins);
+	endScenario();
+
+	/*
+	 *	One more result in the bin that was already green.
+	 */
+	beginScenario("bars-update", 11, 1);
+	timeBins[7]++;
+	devSSD1331_bars(timeBins, timeIndicator, kSSD1331BarBins);
+	endScenario();
+
+	beginScenario("reaction-text", 412, 8);
+	devSSD1331_number(0x04, 0x00, 234, 0, "ms", kSSD1331ColorGreen);
+	endScenario();
+
+	beginScenario("current-graph", 789, 64);
+	devSSD1331_clearscreen();
+	devSSD1331_current_axes();
+	devSSD1331_bars(currentBins, currentIndicator, kSSD1331BarBins);
+	devSSD1331_number(0x33, 0x01, 451, 2, "", kSSD1331ColorWhite);
+	endScenario();
+
+	if (failures > 0)
+	{
+		fprintf(stderr, "ssd1331sim: %d checks failed\n", failures);
+
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,576 @@
+/*
+ *	Host-side decoder for the binary telemetry frames that
+ *	src/boot/ksdk1.1.0/warp-kl03-ksdk1.1-telemetry.c writes to RTT
+ *	up-channel 1, as captured by JLinkRTTLogger.
+ *
+ *	Reads the frames from standard input and writes one CSV line per
+ *	record to standard output. Frames are found by their sync byte and
+ *	checked by their CRC (computed with the firmware's own
+ *	warpTelemetryCrc16()); bytes that do not start a valid frame are
+ *	skipped. Sequence number gaps count frames the firmware dropped. The
+ *	totals go to standard error at the end.
+ *
+ *	Log records (from warpLog()) carry only a token, the address of their
+ *	format string in the firmware's .warplog section, and the raw
+ *	arguments. Given the firmware's ELF, the decoder reads the strings from
+ *	that section and formats the text; otherwise it prints the token and
+ *	the arguments as they are.
+ *
+ *	See README.md in this directory.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "SEGGER_RTT.h"
+#include "warp.h"
+
+
+typedef struct
+{
+	uint64_t	records;
+	uint64_t	timeFrames;
+	uint64_t	droppedFrames;
+	uint64_t	crcErrors;
+	uint64_t	skippedBytes;
+	uint64_t	untimedRecords;
+	uint64_t	unknownTokens;
+	uint64_t	wrongLengthRecords;
+} TelemetrydecodeCounters;
+
+enum
+{
+	kTelemetrydecodeMaxLogTextBytes		= 512,
+	kTelemetrydecodeMaxConversionBytes	= 16,
+};
+
+
+static uint8_t			frame[kWarpTelemetryMaxFrameBytes];
+static size_t			frameBytes;
+static bool			haveSequence;
+static uint8_t			lastSequence;
+static bool			haveTime;
+static uint64_t			timeMicroseconds;
+static TelemetrydecodeCounters	counters;
+static uint8_t *		logStrings;
+static uint32_t			logStringsAddress;
+static uint32_t			logStringsBytes;
+
+
+/*
+ *	The firmware's telemetry source is linked in for its CRC; it never
+ *	writes to RTT here.
+ */
+unsigned
+SEGGER_RTT_Write(unsigned BufferIndex, const void *  pBuffer, unsigned NumBytes)
+{
+	return 0;
+}
+
+int
+SEGGER_RTT_ConfigUpBuffer(unsigned BufferIndex, const char *  sName, void *  pBuffer, unsigned BufferSize, unsigned Flags)
+{
+	return 0;
+}
+
+static const char *
+recordName(uint8_t type)
+{
+	switch (type)
+	{
+		case kWarpTelemetryRecordINA219Current:
+		{
+			return "INA219";
+		}
+		case kWarpTelemetryRecordLog:
+		{
+			return "log";
+		}
+		case kWarpTelemetryRecordBMX055NineAxis:
+		{
+			return "BMX055";
+		}
+		case kWarpTelemetryRecordDataReadyFirst + kWarpDataReadyMMA8451Q:
+		{
+			return "MMA8451Q";
+		}
+		case kWarpTelemetryRecordDataReadyFirst + kWarpDataReadyL3GD20H:
+		{
+			return "L3GD20H";
+		}
+		case kWarpTelemetryRecordDataReadyFirst + kWarpDataReadyBMX055accel:
+		{
+			return "BMX055accel";
+		}
+		case kWarpTelemetryRecordDataReadyFirst + kWarpDataReadyBMX055gyro:
+		{
+			return "BMX055gyro";
+		}
+		default:
+		{
+			return NULL;
+		}
+	}
+}
+
+/*
+ *	The number of int16_t fields a record of the type carries, or 0 if
+ *	it is not fixed (log records, and types we do not know).
+ */
+static size_t
+recordFieldCount(uint8_t type)
+{
+	switch (type)
+	{
+		case kWarpTelemetryRecordINA219Current:
+		{
+			return 1;
+		}
+		case kWarpTelemetryRecordBMX055NineAxis:
+		{
+			return 9;
+		}
+		case kWarpTelemetryRecordDataReadyFirst + kWarpDataReadyMMA8451Q:
+		case kWarpTelemetryRecordDataReadyFirst + kWarpDataReadyL3GD20H:
+		case kWarpTelemetryRecordDataReadyFirst + kWarpDataReadyBMX055accel:
+		case kWarpTelemetryRecordDataReadyFirst + kWarpDataReadyBMX055gyro:
+		{
+			return 3;
+		}
+		default:
+		{
+			return 0;
+		}
+	}
+}
+
+static uint32_t
+elfWord(const uint8_t *  bytes)
+{
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static uint16_t
+elfHalf(const uint8_t *  bytes)
+{
+	return bytes[0] | (bytes[1] << 8);
+}
+
+/*
+ *	Load the .warplog section of a little-endian ELF32 file (the firmware's
+ *	Warp.elf). Returns false if there is no such section.
+ */
+static bool
+loadLogStrings(const char *  path)
+{
+	FILE *		file;
+	uint8_t *	elf;
+	long		elfBytes;
+	uint32_t	sectionHeaders, sectionHeaderBytes, sectionCount, namesIndex;
+	const uint8_t *	names;
+	bool		found = false;
+
+	file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	elfBytes = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	elf = malloc(elfBytes);
+	if ((elf == NULL) || (fread(elf, 1, elfBytes, file) != (size_t)elfBytes))
+	{
+		fclose(file);
+		free(elf);
+
+		return false;
+	}
+	fclose(file);
+
+	/*
+	 *	ELFCLASS32, ELFDATA2LSB.
+	 */
+	if ((elfBytes < 52) || (memcmp(elf, "\177ELF\001\001", 6) != 0))
+	{
+		free(elf);
+
+		return false;
+	}
+
+	sectionHeaders		= elfWord(&elf[0x20]);
+	sectionHeaderBytes	= elfHalf(&elf[0x2E]);
+	sectionCount		= elfHalf(&elf[0x30]);
+	namesIndex		= elfHalf(&elf[0x32]);
+	if ((sectionHeaderBytes < 40) || (namesIndex >= sectionCount) || (sectionHeaders + (uint64_t)sectionCount * sectionHeaderBytes > (uint64_t)elfBytes))
+	{
+		free(elf);
+
+		return false;
+	}
+
+	names = &elf[elfWord(&elf[sectionHeaders + namesIndex * sectionHeaderBytes + 16])];
+	for (uint32_t i = 0; i < sectionCount; i++)
+	{
+		const uint8_t *	header = &elf[sectionHeaders + i * sectionHeaderBytes];
+		uint32_t	offset = elfWord(&header[16]);
+		uint32_t	size = elfWord(&header[20]);
+
+		if ((strcmp((const char *)&names[elfWord(&header[0])], ".warplog") != 0) || ((uint64_t)offset + size > (uint64_t)elfBytes))
+		{
+			continue;
+		}
+
+		logStrings		= malloc(size + 1);
+		memcpy(logStrings, &elf[offset], size);
+		logStrings[size]	= '\0';
+		logStringsAddress	= elfWord(&header[12]);
+		logStringsBytes		= size;
+		found			= true;
+		break;
+	}
+
+	free(elf);
+
+	return found;
+}
+
+/*
+ *	Format a log record's text as the firmware's SEGGER_RTT_printf() would
+ *	have: integer conversions (%d %i %u %x %X %o %c %p, with flags and
+ *	width) take the 32-bit arguments in order. The firmware cannot send
+ *	strings, so %s shows as <string>. Carriage returns, newlines, and tabs
+ *	are left out, so that each record stays on its CSV line.
+ */
+static void
+formatLog(char *  text, size_t textBytes, const char *  format, const uint8_t *  arguments, size_t argumentCount)
+{
+	size_t		textUsed = 0;
+	size_t		argument = 0;
+
+	text[0] = '\0';
+	while ((*format != '\0') && (textUsed + 1 < textBytes))
+	{
+		char		conversion[kTelemetrydecodeMaxConversionBytes];
+		size_t		conversionBytes = 0;
+		uint32_t	value = 0;
+
+		if (*format != '%')
+		{
+			if ((*format != '\r') && (*format != '\n') && (*format != '\t'))
+			{
+				text[textUsed++] = *format;
+				text[textUsed] = '\0';
+			}
+			format++;
+			continue;
+		}
+
+		conversion[conversionBytes++] = *format++;
+		while ((*format != '\0') && (strchr("-+ 0#0123456789", *format) != NULL) && (conversionBytes < kTelemetrydecodeMaxConversionBytes - 2))
+		{
+			conversion[conversionBytes++] = *format++;
+		}
+		while ((*format == 'l') || (*format == 'h'))
+		{
+			format++;
+		}
+		if (*format == '\0')
+		{
+			break;
+		}
+
+		if ((*format != '%') && (*format != 's'))
+		{
+			if (argument < argumentCount)
+			{
+				value = elfWord(&arguments[4 * argument]);
+			}
+			argument++;
+		}
+
+		conversion[conversionBytes++] = (*format == 'i') ? 'd' : *format;
+		conversion[conversionBytes] = '\0';
+		switch (*format)
+		{
+			case 'd':
+			case 'i':
+			case 'c':
+			{
+				snprintf(&text[textUsed], textBytes - textUsed, conversion, (int32_t)value);
+				break;
+			}
+			case 'u':
+			case 'x':
+			case 'X':
+			case 'o':
+			{
+				snprintf(&text[textUsed], textBytes - textUsed, conversion, value);
+				break;
+			}
+			case 'p':
+			{
+				snprintf(&text[textUsed], textBytes - textUsed, "0x%08X", value);
+				break;
+			}
+			case 's':
+			{
+				snprintf(&text[textUsed], textBytes - textUsed, "<string>");
+				argument++;
+				break;
+			}
+			default:
+			{
+				snprintf(&text[textUsed], textBytes - textUsed, "%c", *format);
+				break;
+			}
+		}
+		textUsed += strlen(&text[textUsed]);
+		format++;
+	}
+}
+
+static void
+emitLog(const uint8_t *  payload, uint8_t payloadBytes)
+{
+	char		text[kTelemetrydecodeMaxLogTextBytes];
+	uint16_t	token;
+	size_t		argumentCount;
+	const char *	start;
+	size_t		length;
+
+	if (payloadBytes < 2)
+	{
+		printf(",\"\"\n");
+		return;
+	}
+
+	token		= payload[0] | (payload[1] << 8);
+	argumentCount	= (payloadBytes - 2) / 4;
+
+	/*
+	 *	The token is the low 16 bits of the string's address.
+	 */
+	if ((logStrings == NULL) || ((uint16_t)(token - logStringsAddress) >= logStringsBytes))
+	{
+		if (logStrings != NULL)
+		{
+			counters.unknownTokens++;
+		}
+
+		printf(",0x%04x", token);
+		for (size_t i = 0; i < argumentCount; i++)
+		{
+			printf(",%d", (int32_t)elfWord(&payload[2 + 4*i]));
+		}
+		printf("\n");
+
+		return;
+	}
+
+	formatLog(text, sizeof(text), (const char *)&logStrings[(uint16_t)(token - logStringsAddress)], &payload[2], argumentCount);
+
+	/*
+	 *	Without the leading and trailing blanks the firmware's messages
+	 *	use to line up on the terminal.
+	 */
+	start = text;
+	while (*start == ' ')
+	{
+		start++;
+	}
+	length = strlen(start);
+	while ((length > 0) && (start[length - 1] == ' '))
+	{
+		length--;
+	}
+
+	printf(",\"");
+	for (size_t i = 0; i < length; i++)
+	{
+		if (start[i] == '"')
+		{
+			putchar('"');
+		}
+		putchar(start[i]);
+	}
+	printf("\"\n");
+}
+
+/*
+ *	Drop the first count bytes of the frame buffer.
+ */
+static void
+discard(size_t count)
+{
+	for (size_t i = count; i < frameBytes; i++)
+	{
+		frame[i - count] = frame[i];
+	}
+	frameBytes -= count;
+}
+
+static void
+emitRecord(void)
+{
+	uint8_t		type = frame[1];
+	uint8_t		sequence = frame[2];
+	uint8_t		payloadBytes = frame[3];
+	uint16_t	deltaMicroseconds = frame[4] | (frame[5] << 8);
+	const uint8_t *	payload = &frame[kWarpTelemetryHeaderBytes];
+	const char *	name = recordName(type);
+	size_t		fieldCount = recordFieldCount(type);
+
+	if (haveSequence && (sequence != (uint8_t)(lastSequence + 1)))
+	{
+		counters.droppedFrames += (uint8_t)(sequence - lastSequence - 1);
+	}
+	haveSequence = true;
+	lastSequence = sequence;
+
+	if (type == kWarpTelemetryRecordTime)
+	{
+		uint32_t	absoluteMicroseconds = payload[0] | (payload[1] << 8) | (payload[2] << 16) | ((uint32_t)payload[3] << 24);
+
+		/*
+		 *	The firmware's time is 32 bits; keep ours going across its wraps.
+		 */
+		if (haveTime)
+		{
+			timeMicroseconds += (uint32_t)(absoluteMicroseconds - (uint32_t)timeMicroseconds);
+		}
+		else
+		{
+			timeMicroseconds = absoluteMicroseconds;
+		}
+		haveTime = true;
+		counters.timeFrames++;
+
+		return;
+	}
+
+	if (!haveTime)
+	{
+		counters.untimedRecords++;
+
+		return;
+	}
+
+	timeMicroseconds += deltaMicroseconds;
+
+	/*
+	 *	A record that does not match its type's layout would put values
+	 *	in the wrong columns.
+	 */
+	if ((fieldCount != 0) && (payloadBytes != 2 * fieldCount))
+	{
+		counters.wrongLengthRecords++;
+
+		return;
+	}
+	counters.records++;
+
+	if (name != NULL)
+	{
+		printf("%s,%u,%llu", name, sequence, (unsigned long long)timeMicroseconds);
+	}
+	else
+	{
+		printf("0x%02x,%u,%llu", type, sequence, (unsigned long long)timeMicroseconds);
+	}
+
+	if (type == kWarpTelemetryRecordLog)
+	{
+		emitLog(payload, payloadBytes);
+
+		return;
+	}
+
+	for (size_t i = 0; i + 1 < payloadBytes; i += 2)
+	{
+		printf(",%d", (int16_t)(payload[i] | (payload[i + 1] << 8)));
+	}
+	printf("\n");
+}
+
+/*
+ *	Consume as many frames from the buffer as are complete.
+ */
+static void
+parse(void)
+{
+	while (frameBytes > 0)
+	{
+		size_t		payloadBytes, totalBytes;
+		uint16_t	crc;
+
+		if (frame[0] != kWarpTelemetrySyncByte)
+		{
+			discard(1);
+			counters.skippedBytes++;
+			continue;
+		}
+
+		if (frameBytes < kWarpTelemetryHeaderBytes)
+		{
+			return;
+		}
+
+		payloadBytes = frame[3];
+		if (payloadBytes > kWarpTelemetryMaxPayloadBytes)
+		{
+			discard(1);
+			counters.skippedBytes++;
+			continue;
+		}
+
+		totalBytes = kWarpTelemetryHeaderBytes + payloadBytes + kWarpTelemetryCrcBytes;
+		if (frameBytes < totalBytes)
+		{
+			return;
+		}
+
+		crc = warpTelemetryCrc16(0xFFFF, &frame[1], kWarpTelemetryHeaderBytes + payloadBytes - 1);
+		if ((frame[totalBytes - 2] != (crc & 0xFF)) || (frame[totalBytes - 1] != (crc >> 8)))
+		{
+			counters.crcErrors++;
+			discard(1);
+			counters.skippedBytes++;
+			continue;
+		}
+
+		emitRecord();
+		discard(totalBytes);
+	}
+}
+
+int
+main(int argc, char *  argv[])
+{
+	int	c;
+
+	if ((argc > 1) && !loadLogStrings(argv[1]))
+	{
+		fprintf(stderr, "%s: no .warplog section in %s\n", argv[0], argv[1]);
+
+		return 1;
+	}
+
+	printf("sensor,sequence,time_us,values...\n");
+
+	while ((c = getchar()) != EOF)
+	{
+		frame[frameBytes++] = c;
+		parse();
+	}
+
+	fprintf(stderr, "%llu records, %llu time frames, %llu dropped frames, %llu CRC errors, %llu bytes skipped, %llu records before the first time frame, %llu unknown log tokens, %llu records of the wrong length for their type\n",
+		(unsigned long long)counters.records, (unsigned long long)counters.timeFrames,
+		(unsigned long long)counters.droppedFrames, (unsigned long long)counters.crcErrors,
+		(unsigned long long)counters.skippedBytes, (unsigned long long)counters.untimedRecords, (unsigned long long)counters.unknownTokens,
+		(unsigned long long)counters.wrongLengthRecords);
+
+	return (counters.droppedFrames != 0) || (counters.crcErrors != 0);
+}